@@ -3,7 +3,14 @@
 
 int main()
 {
-    ptr<RenderGraph> rg = RenderGraph::LoadFromJson("graph.json").value();
+    // DeferredPass and DeferredShading prototypes should be registered to RenderPassPrototypeRegistry::Global() before loading
+    std::string msg;
+    auto rg = RenderGraph::LoadFromJson("graph.json", &msg);
+    if (!rg.has_value())
+    {
+        printf("%s\n", msg.c_str());
+        return -1;
+    }
 
 
 }
\ No newline at end of file
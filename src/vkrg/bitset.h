@@ -0,0 +1,77 @@
+#pragma once
+#include "vkrg/common.h"
+#include <vector>
+
+namespace vkrg
+{
+	/// <summary>
+	/// A bitset whose size is decided at runtime.
+	/// Only Resize allocates memory, other operations could be used in per frame code.
+	/// </summary>
+	class DynamicBitset
+	{
+	public:
+		void Resize(uint32_t size)
+		{
+			m_Size = size;
+			m_Words.resize((size + 63) / 64, 0);
+			ClearTail();
+		}
+
+		uint32_t Size() const
+		{
+			return m_Size;
+		}
+
+		void Set(uint32_t idx)
+		{
+			vkrg_assert(idx < m_Size);
+			m_Words[idx / 64] |= (uint64_t)1 << (idx % 64);
+		}
+
+		void Reset(uint32_t idx)
+		{
+			vkrg_assert(idx < m_Size);
+			m_Words[idx / 64] &= ~((uint64_t)1 << (idx % 64));
+		}
+
+		bool Test(uint32_t idx) const
+		{
+			vkrg_assert(idx < m_Size);
+			return (m_Words[idx / 64] >> (idx % 64)) & 1;
+		}
+
+		void SetAll()
+		{
+			std::fill(m_Words.begin(), m_Words.end(), ~(uint64_t)0);
+			ClearTail();
+		}
+
+		void Clear()
+		{
+			std::fill(m_Words.begin(), m_Words.end(), 0);
+		}
+
+		bool Any() const
+		{
+			for (auto word : m_Words)
+			{
+				if (word != 0) return true;
+			}
+			return false;
+		}
+
+	private:
+		// bits out of range should always be 0, otherwise Any() will give wrong result
+		void ClearTail()
+		{
+			if (m_Size % 64 != 0)
+			{
+				m_Words.back() &= ((uint64_t)1 << (m_Size % 64)) - 1;
+			}
+		}
+
+		std::vector<uint64_t> m_Words;
+		uint32_t			  m_Size = 0;
+	};
+}
@@ -0,0 +1,681 @@
+#include "cache.h"
+
+namespace vkrg
+{
+	static void HashCombine(size_t& hash, size_t value)
+	{
+		hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	bool ImageViewCache::Key::operator==(const Key& other) const
+	{
+		return image == other.image && viewType == other.viewType &&
+			slice.aspectMask == other.slice.aspectMask &&
+			slice.baseMipLevel == other.slice.baseMipLevel &&
+			slice.levelCount == other.slice.levelCount &&
+			slice.baseArrayLayer == other.slice.baseArrayLayer &&
+			slice.layerCount == other.slice.layerCount;
+	}
+
+	size_t ImageViewCache::KeyHash::operator()(const Key& key) const
+	{
+		size_t hash = std::hash<VkImage>()(key.image);
+		HashCombine(hash, key.viewType);
+		HashCombine(hash, key.slice.aspectMask);
+		HashCombine(hash, key.slice.baseMipLevel);
+		HashCombine(hash, key.slice.levelCount);
+		HashCombine(hash, key.slice.baseArrayLayer);
+		HashCombine(hash, key.slice.layerCount);
+		return hash;
+	}
+
+	ImageViewCache::~ImageViewCache()
+	{
+		for (auto& [view, _] : m_Entries)
+		{
+			DestroyView(view);
+		}
+		for (auto& retiring : m_RetiringViews)
+		{
+			DestroyView(retiring.view);
+		}
+	}
+
+	void ImageViewCache::Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity)
+	{
+		m_Context = ctx;
+		m_FlightFrameCount = flightFrameCount;
+		m_Capacity = capacity;
+		m_Statistics.capacity = capacity;
+	}
+
+	VkImageView ImageViewCache::Acquire(ptr<gvk::Image> image, const ImageSlice& slice, VkImageViewType viewType)
+	{
+		Key key{ image->GetImage(), slice, viewType };
+
+		if (auto iter = m_Views.find(key); iter != m_Views.end())
+		{
+			Reference(m_Entries[iter->second]);
+			m_Statistics.hitCount++;
+			return iter->second;
+		}
+
+		VkImageViewCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		info.image = key.image;
+		info.viewType = viewType;
+		info.format = image->Info().format;
+		info.components = { VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+		info.subresourceRange = slice;
+
+		VkImageView view = NULL;
+		// this operation shouldn't fail unless we are out of memory
+		vkrg_assert(vkCreateImageView(m_Context->GetDevice(), &info, NULL, &view) == VK_SUCCESS);
+
+		m_Views[key] = view;
+		m_Entries[view] = Entry{ key, image, 1, false, m_UnusedViews.end() };
+
+		m_Statistics.missCount++;
+		m_Statistics.liveViewCount++;
+
+		return view;
+	}
+
+	void ImageViewCache::AddReference(VkImageView view)
+	{
+		auto iter = m_Entries.find(view);
+		vkrg_assert(iter != m_Entries.end());
+
+		Reference(iter->second);
+	}
+
+	void ImageViewCache::Release(VkImageView view)
+	{
+		if (view == NULL) return;
+
+		auto iter = m_Entries.find(view);
+		vkrg_assert(iter != m_Entries.end());
+
+		Entry& entry = iter->second;
+		vkrg_assert(entry.refCount != 0);
+		if (--entry.refCount != 0) return;
+
+		m_Statistics.liveViewCount--;
+		if (entry.evicted)
+		{
+			Retire(view);
+			return;
+		}
+
+		// the entry keeps the image alive, so its handle can't be reused by another image while the view is cached
+		entry.unusedIter = m_UnusedViews.insert(m_UnusedViews.end(), view);
+		m_Statistics.unusedViewCount++;
+
+		while (m_UnusedViews.size() > m_Capacity)
+		{
+			VkImageView oldestView = m_UnusedViews.front();
+			m_UnusedViews.pop_front();
+			m_Statistics.unusedViewCount--;
+
+			Retire(oldestView);
+		}
+	}
+
+	void ImageViewCache::EvictImage(VkImage image)
+	{
+		std::vector<VkImageView> unusedViews;
+		for (auto& [view, entry] : m_Entries)
+		{
+			if (entry.evicted || entry.key.image != image) continue;
+
+			m_Views.erase(entry.key);
+			entry.evicted = true;
+			if (entry.refCount == 0)
+			{
+				unusedViews.push_back(view);
+			}
+		}
+
+		for (auto view : unusedViews)
+		{
+			m_UnusedViews.erase(m_Entries[view].unusedIter);
+			m_Statistics.unusedViewCount--;
+
+			Retire(view);
+		}
+	}
+
+	VkImage ImageViewCache::GetImage(VkImageView view)
+	{
+		auto iter = m_Entries.find(view);
+		vkrg_assert(iter != m_Entries.end());
+
+		return iter->second.key.image;
+	}
+
+	void ImageViewCache::OnNewFrame()
+	{
+		m_FrameCounter++;
+
+		for (uint32_t i = 0; i < m_RetiringViews.size();)
+		{
+			if (m_RetiringViews[i].retireFrame <= m_FrameCounter)
+			{
+				DestroyView(m_RetiringViews[i].view);
+
+				m_RetiringViews[i] = m_RetiringViews.back();
+				m_RetiringViews.pop_back();
+				m_Statistics.retiringViewCount--;
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	const ImageViewCacheStatistics& ImageViewCache::GetStatistics()
+	{
+		return m_Statistics;
+	}
+
+	void ImageViewCache::Reference(Entry& entry)
+	{
+		if (entry.refCount++ != 0) return;
+
+		m_UnusedViews.erase(entry.unusedIter);
+		m_Statistics.unusedViewCount--;
+		m_Statistics.liveViewCount++;
+	}
+
+	void ImageViewCache::Retire(VkImageView view)
+	{
+		auto iter = m_Entries.find(view);
+		// the view is removed from the table immediately but it could still be used by frames on flight
+		// evicted views are not in the table, the key might belong to a view created after eviction
+		if (!iter->second.evicted)
+		{
+			m_Views.erase(iter->second.key);
+		}
+		m_RetiringViews.push_back(RetiringView{ view, iter->second.image, m_FrameCounter + m_FlightFrameCount });
+		m_Entries.erase(iter);
+
+		m_Statistics.retiringViewCount++;
+	}
+
+	void ImageViewCache::DestroyView(VkImageView view)
+	{
+		vkDestroyImageView(m_Context->GetDevice(), view, NULL);
+	}
+
+	bool FrameBufferAttachmentImage::operator==(const FrameBufferAttachmentImage& other) const
+	{
+		return flags == other.flags && usage == other.usage &&
+			width == other.width && height == other.height &&
+			layerCount == other.layerCount && format == other.format;
+	}
+
+	bool FrameBufferCache::Key::operator==(const Key& other) const
+	{
+		return renderPass == other.renderPass && imageless == other.imageless &&
+			width == other.width && height == other.height && layers == other.layers &&
+			views == other.views && images == other.images;
+	}
+
+	size_t FrameBufferCache::KeyHash::operator()(const Key& key) const
+	{
+		size_t hash = std::hash<VkRenderPass>()(key.renderPass);
+		HashCombine(hash, key.width);
+		HashCombine(hash, key.height);
+		HashCombine(hash, key.layers);
+		HashCombine(hash, key.imageless);
+		for (auto view : key.views)
+		{
+			HashCombine(hash, std::hash<VkImageView>()(view));
+		}
+		for (auto& image : key.images)
+		{
+			HashCombine(hash, image.usage);
+			HashCombine(hash, image.width);
+			HashCombine(hash, image.height);
+			HashCombine(hash, image.format);
+		}
+		return hash;
+	}
+
+	FrameBufferCache::~FrameBufferCache()
+	{
+		for (auto& [frameBuffer, _] : m_Entries)
+		{
+			vkDestroyFramebuffer(m_Context->GetDevice(), frameBuffer, NULL);
+		}
+		for (auto& retiring : m_RetiringFrameBuffers)
+		{
+			vkDestroyFramebuffer(m_Context->GetDevice(), retiring.frameBuffer, NULL);
+		}
+	}
+
+	void FrameBufferCache::Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity, ImageViewCache* viewCache)
+	{
+		m_Context = ctx;
+		m_FlightFrameCount = flightFrameCount;
+		m_Capacity = capacity;
+		m_ViewCache = viewCache;
+		m_Statistics.capacity = capacity;
+	}
+
+	VkFramebuffer FrameBufferCache::Acquire(ptr<gvk::RenderPass> renderPass, const std::vector<VkImageView>& views, uint32_t width, uint32_t height, uint32_t layers)
+	{
+		Key key{ renderPass->GetRenderPass(), width, height, layers, false, views, {} };
+		return Acquire(key, renderPass);
+	}
+
+	VkFramebuffer FrameBufferCache::AcquireImageless(ptr<gvk::RenderPass> renderPass, const std::vector<FrameBufferAttachmentImage>& images, uint32_t width, uint32_t height, uint32_t layers)
+	{
+		Key key{ renderPass->GetRenderPass(), width, height, layers, true, {}, images };
+		return Acquire(key, renderPass);
+	}
+
+	VkFramebuffer FrameBufferCache::Acquire(Key& key, ptr<gvk::RenderPass> renderPass)
+	{
+		if (auto iter = m_FrameBuffers.find(key); iter != m_FrameBuffers.end())
+		{
+			Entry& entry = m_Entries[iter->second];
+			if (entry.refCount++ == 0)
+			{
+				m_UnusedFrameBuffers.erase(entry.unusedIter);
+				m_Statistics.unusedFrameBufferCount--;
+				m_Statistics.liveFrameBufferCount++;
+			}
+			m_Statistics.hitCount++;
+			return iter->second;
+		}
+
+		VkFramebuffer frameBuffer = CreateFrameBuffer(key);
+		// views are released when the frame buffer is destroyed
+		for (auto view : key.views)
+		{
+			m_ViewCache->AddReference(view);
+		}
+
+		m_FrameBuffers[key] = frameBuffer;
+		m_Entries[frameBuffer] = Entry{ std::move(key), renderPass, 1, false, m_UnusedFrameBuffers.end() };
+
+		m_Statistics.missCount++;
+		m_Statistics.liveFrameBufferCount++;
+
+		return frameBuffer;
+	}
+
+	VkFramebuffer FrameBufferCache::CreateFrameBuffer(const Key& key)
+	{
+		std::vector<VkFramebufferAttachmentImageInfo> imageInfos(key.images.size());
+		for (uint32_t i = 0; i < key.images.size(); i++)
+		{
+			imageInfos[i].sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENT_IMAGE_INFO;
+			imageInfos[i].pNext = NULL;
+			imageInfos[i].flags = key.images[i].flags;
+			imageInfos[i].usage = key.images[i].usage;
+			imageInfos[i].width = key.images[i].width;
+			imageInfos[i].height = key.images[i].height;
+			imageInfos[i].layerCount = key.images[i].layerCount;
+			imageInfos[i].viewFormatCount = 1;
+			imageInfos[i].pViewFormats = &key.images[i].format;
+		}
+
+		VkFramebufferAttachmentsCreateInfo attachmentsInfo{};
+		attachmentsInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_ATTACHMENTS_CREATE_INFO;
+		attachmentsInfo.attachmentImageInfoCount = imageInfos.size();
+		attachmentsInfo.pAttachmentImageInfos = imageInfos.data();
+
+		VkFramebufferCreateInfo info{};
+		info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		info.renderPass = key.renderPass;
+		info.width = key.width;
+		info.height = key.height;
+		info.layers = key.layers;
+		if (key.imageless)
+		{
+			info.pNext = &attachmentsInfo;
+			info.flags = VK_FRAMEBUFFER_CREATE_IMAGELESS_BIT;
+			info.attachmentCount = imageInfos.size();
+		}
+		else
+		{
+			info.attachmentCount = key.views.size();
+			info.pAttachments = key.views.data();
+		}
+
+		VkFramebuffer frameBuffer = NULL;
+		vkrg_assert(vkCreateFramebuffer(m_Context->GetDevice(), &info, NULL, &frameBuffer) == VK_SUCCESS);
+
+		return frameBuffer;
+	}
+
+	void FrameBufferCache::Release(VkFramebuffer frameBuffer)
+	{
+		if (frameBuffer == NULL) return;
+
+		auto iter = m_Entries.find(frameBuffer);
+		vkrg_assert(iter != m_Entries.end());
+
+		Entry& entry = iter->second;
+		vkrg_assert(entry.refCount != 0);
+		if (--entry.refCount != 0) return;
+
+		m_Statistics.liveFrameBufferCount--;
+		if (entry.evicted)
+		{
+			Retire(frameBuffer);
+			return;
+		}
+
+		entry.unusedIter = m_UnusedFrameBuffers.insert(m_UnusedFrameBuffers.end(), frameBuffer);
+		m_Statistics.unusedFrameBufferCount++;
+
+		while (m_UnusedFrameBuffers.size() > m_Capacity)
+		{
+			VkFramebuffer oldestFrameBuffer = m_UnusedFrameBuffers.front();
+			m_UnusedFrameBuffers.pop_front();
+			m_Statistics.unusedFrameBufferCount--;
+
+			Retire(oldestFrameBuffer);
+		}
+	}
+
+	void FrameBufferCache::EvictImage(VkImage image)
+	{
+		std::vector<VkFramebuffer> unusedFrameBuffers;
+		for (auto& [frameBuffer, entry] : m_Entries)
+		{
+			if (entry.evicted) continue;
+
+			// imageless frame buffers don't refer to the image
+			bool attached = std::any_of(entry.key.views.begin(), entry.key.views.end(), [&](VkImageView view)
+				{
+					return m_ViewCache->GetImage(view) == image;
+				});
+			if (!attached) continue;
+
+			m_FrameBuffers.erase(entry.key);
+			entry.evicted = true;
+			if (entry.refCount == 0)
+			{
+				unusedFrameBuffers.push_back(frameBuffer);
+			}
+		}
+
+		for (auto frameBuffer : unusedFrameBuffers)
+		{
+			m_UnusedFrameBuffers.erase(m_Entries[frameBuffer].unusedIter);
+			m_Statistics.unusedFrameBufferCount--;
+
+			Retire(frameBuffer);
+		}
+	}
+
+	void FrameBufferCache::OnNewFrame()
+	{
+		m_FrameCounter++;
+
+		for (uint32_t i = 0; i < m_RetiringFrameBuffers.size();)
+		{
+			if (m_RetiringFrameBuffers[i].retireFrame <= m_FrameCounter)
+			{
+				vkDestroyFramebuffer(m_Context->GetDevice(), m_RetiringFrameBuffers[i].frameBuffer, NULL);
+				for (auto view : m_RetiringFrameBuffers[i].views)
+				{
+					m_ViewCache->Release(view);
+				}
+
+				m_RetiringFrameBuffers[i] = m_RetiringFrameBuffers.back();
+				m_RetiringFrameBuffers.pop_back();
+				m_Statistics.retiringFrameBufferCount--;
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	const FrameBufferCacheStatistics& FrameBufferCache::GetStatistics()
+	{
+		return m_Statistics;
+	}
+
+	void FrameBufferCache::Retire(VkFramebuffer frameBuffer)
+	{
+		auto iter = m_Entries.find(frameBuffer);
+		if (!iter->second.evicted)
+		{
+			m_FrameBuffers.erase(iter->second.key);
+		}
+		// views are released after the frame buffer is destroyed
+		m_RetiringFrameBuffers.push_back(RetiringFrameBuffer{ frameBuffer, iter->second.renderPass,
+			std::move(iter->second.key.views), m_FrameCounter + m_FlightFrameCount });
+		m_Entries.erase(iter);
+
+		m_Statistics.retiringFrameBufferCount++;
+	}
+
+	ImagePool::Key::Key(const GvkImageCreateInfo& info)
+	{
+		extent = GetSizeClass(info.extent);
+		arrayLayers = info.arrayLayers;
+		mipLevels = info.mipLevels;
+		flags = info.flags;
+		format = info.format;
+		imageType = info.imageType;
+		tiling = info.tiling;
+		usage = info.usage;
+		samples = info.samples;
+	}
+
+	bool ImagePool::Key::operator==(const Key& other) const
+	{
+		return extent.width == other.extent.width && extent.height == other.extent.height && extent.depth == other.extent.depth &&
+			arrayLayers == other.arrayLayers && mipLevels == other.mipLevels && flags == other.flags &&
+			format == other.format && imageType == other.imageType && tiling == other.tiling &&
+			usage == other.usage && samples == other.samples;
+	}
+
+	size_t ImagePool::KeyHash::operator()(const Key& key) const
+	{
+		size_t hash = key.extent.width;
+		HashCombine(hash, key.extent.height);
+		HashCombine(hash, key.extent.depth);
+		HashCombine(hash, key.arrayLayers);
+		HashCombine(hash, key.mipLevels);
+		HashCombine(hash, key.format);
+		HashCombine(hash, key.usage);
+		return hash;
+	}
+
+	void ImagePool::Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity)
+	{
+		m_Context = ctx;
+		m_FlightFrameCount = flightFrameCount;
+		m_Capacity = capacity;
+	}
+
+	VkExtent3D ImagePool::GetSizeClass(VkExtent3D extent)
+	{
+		extent.width = (extent.width + sizeClassGranularity - 1) / sizeClassGranularity * sizeClassGranularity;
+		extent.height = (extent.height + sizeClassGranularity - 1) / sizeClassGranularity * sizeClassGranularity;
+		return extent;
+	}
+
+	bool ImagePool::InSizeClass(VkExtent3D imageExtent, VkExtent3D extent)
+	{
+		VkExtent3D sizeClass = GetSizeClass(extent);
+		return imageExtent.width >= extent.width && imageExtent.width <= sizeClass.width &&
+			imageExtent.height >= extent.height && imageExtent.height <= sizeClass.height &&
+			imageExtent.depth == extent.depth;
+	}
+
+	ptr<gvk::Image> ImagePool::Acquire(const GvkImageCreateInfo& info, bool sizeClassed)
+	{
+		if (auto iter = m_Buckets.find(Key(info)); iter != m_Buckets.end())
+		{
+			auto& bucket = iter->second;
+			for (uint32_t i = 0; i < bucket.size(); i++)
+			{
+				if (!IsRetired(bucket[i])) continue;
+
+				// images of a size class are created at the size class, but adopted images might have any extent in it
+				const VkExtent3D& extent = bucket[i].extent;
+				bool fit = sizeClassed ? InSizeClass(extent, info.extent) :
+					extent.width == info.extent.width && extent.height == info.extent.height && extent.depth == info.extent.depth;
+				if (!fit) continue;
+
+				ptr<gvk::Image> image = bucket[i].image;
+				bucket.erase(bucket.begin() + i);
+
+				m_Statistics.reuseCount++;
+				m_Statistics.pooledImageCount--;
+				return image;
+			}
+		}
+
+		// create info is not const in gvk
+		GvkImageCreateInfo imageCI = info;
+		if (sizeClassed)
+		{
+			imageCI.extent = GetSizeClass(info.extent);
+		}
+		auto res = m_Context->CreateImage(imageCI);
+		// this operation shouldn't fail unless we are out of memory
+		vkrg_assert(res.has_value());
+
+		m_Statistics.createCount++;
+		return res.value();
+	}
+
+	void ImagePool::Release(ptr<gvk::Image> image, const GvkImageCreateInfo& info)
+	{
+		m_Buckets[Key(info)].push_back(PooledImage{ image, info.extent, m_FrameCounter, false });
+		m_Statistics.pooledImageCount++;
+	}
+
+	void ImagePool::Adopt(ptr<gvk::Image> image, const GvkImageCreateInfo& info)
+	{
+		// adopted images are the oldest ones, unused adopted images are destroyed first when the pool is full
+		m_Buckets[Key(info)].push_back(PooledImage{ image, info.extent, 0, true });
+		m_Statistics.pooledImageCount++;
+	}
+
+	void ImagePool::OnNewFrame()
+	{
+		m_FrameCounter++;
+
+		// destroy the least recently released images which are not used by frames on flight
+		while (m_Statistics.pooledImageCount > m_Capacity)
+		{
+			std::vector<PooledImage>* oldestBucket = NULL;
+			uint32_t oldestIdx = 0;
+			for (auto& [_, bucket] : m_Buckets)
+			{
+				for (uint32_t i = 0; i < bucket.size(); i++)
+				{
+					if (oldestBucket == NULL || bucket[i].releaseFrame < (*oldestBucket)[oldestIdx].releaseFrame)
+					{
+						oldestBucket = &bucket;
+						oldestIdx = i;
+					}
+				}
+			}
+
+			if (oldestBucket == NULL || !IsRetired((*oldestBucket)[oldestIdx])) break;
+
+			oldestBucket->erase(oldestBucket->begin() + oldestIdx);
+			m_Statistics.pooledImageCount--;
+		}
+	}
+
+	const ImagePoolStatistics& ImagePool::GetStatistics()
+	{
+		return m_Statistics;
+	}
+
+	bool ImagePool::IsRetired(const PooledImage& image)
+	{
+		return image.adopted || image.releaseFrame + m_FlightFrameCount <= m_FrameCounter;
+	}
+
+	void RenderPassKey::Add(Call call, std::initializer_list<uint32_t> args)
+	{
+		words.push_back(call);
+		words.insert(words.end(), args);
+	}
+
+	bool RenderPassKey::operator==(const RenderPassKey& other) const
+	{
+		return words == other.words;
+	}
+
+	size_t RenderPassCache::KeyHash::operator()(const RenderPassKey& key) const
+	{
+		size_t hash = key.words.size();
+		for (auto word : key.words)
+		{
+			HashCombine(hash, word);
+		}
+		return hash;
+	}
+
+	void RenderPassCache::Initialize(ptr<gvk::Context> ctx)
+	{
+		m_Context = ctx;
+	}
+
+	opt<ptr<gvk::RenderPass>> RenderPassCache::Acquire(const RenderPassKey& key, GvkRenderPassCreateInfo& info)
+	{
+		if (auto iter = m_RenderPasses.find(key); iter != m_RenderPasses.end())
+		{
+			m_Statistics.hitCount++;
+			iter->second.used = true;
+			return iter->second.renderPass;
+		}
+
+		auto rp = m_Context->CreateRenderPass(info);
+		if (!rp.has_value()) return std::nullopt;
+
+		m_Statistics.missCount++;
+		m_Statistics.renderPassCount++;
+		m_RenderPasses[key] = Entry{ rp.value(), true };
+		return rp.value();
+	}
+
+	void RenderPassCache::Adopt(RenderPassCache& other)
+	{
+		for (auto& [key, entry] : other.m_RenderPasses)
+		{
+			if (m_RenderPasses.count(key)) continue;
+			m_RenderPasses[key] = Entry{ entry.renderPass, false };
+			m_Statistics.renderPassCount++;
+		}
+	}
+
+	void RenderPassCache::EvictUnused()
+	{
+		for (auto iter = m_RenderPasses.begin(); iter != m_RenderPasses.end();)
+		{
+			if (iter->second.used)
+			{
+				iter->second.used = false;
+				iter++;
+				continue;
+			}
+
+			iter = m_RenderPasses.erase(iter);
+			m_Statistics.evictCount++;
+			m_Statistics.renderPassCount--;
+		}
+	}
+
+	const RenderPassCacheStatistics& RenderPassCache::GetStatistics()
+	{
+		return m_Statistics;
+	}
+}
@@ -0,0 +1,384 @@
+#pragma once
+#include "vkrg/common.h"
+#include "vkrg/resource.h"
+#include <unordered_map>
+#include <vector>
+#include <list>
+
+namespace vkrg
+{
+	struct ImageViewCacheStatistics
+	{
+		uint64_t hitCount = 0;
+		uint64_t missCount = 0;
+		// views referenced by the graph
+		uint32_t liveViewCount = 0;
+		// views released by the graph, kept for reusing until the cache is full
+		uint32_t unusedViewCount = 0;
+		uint32_t capacity = 0;
+		// views released but still might be used by frames on flight
+		uint32_t retiringViewCount = 0;
+
+		float	 HitRate() const
+		{
+			uint64_t total = hitCount + missCount;
+			return total == 0 ? 0.f : (float)hitCount / total;
+		}
+	};
+
+	/// <summary>
+	/// Image views shared by the whole graph, keyed by (image, subresource, view type).
+	/// Views are reference counted, a view released by all users is kept in a least recently used list,
+	/// so that views of swapchain images rotating through a binding are not recreated every frame.
+	/// Views dropped from the list are destroyed after the frames on flight which might still use them have retired.
+	/// </summary>
+	class ImageViewCache
+	{
+	public:
+		ImageViewCache() = default;
+		~ImageViewCache();
+
+		ImageViewCache(const ImageViewCache&) = delete;
+		ImageViewCache& operator=(const ImageViewCache&) = delete;
+
+		// at most capacity unused views are kept, the least recently released views are destroyed first
+		void		Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity);
+
+		// the cache keeps the image alive until all of its views are destroyed
+		VkImageView Acquire(ptr<gvk::Image> image, const ImageSlice& slice, VkImageViewType viewType);
+		// adds a reference to a view returned by Acquire
+		void		AddReference(VkImageView view);
+		void		Release(VkImageView view);
+		// views of the image are not handed out again, unused ones are destroyed after frames on flight retire
+		// and referenced ones are destroyed once they are released, so that the cache doesn't keep the image alive
+		void		EvictImage(VkImage image);
+		VkImage		GetImage(VkImageView view);
+
+		// should be called once at the beginning of every frame
+		void		OnNewFrame();
+
+		const ImageViewCacheStatistics& GetStatistics();
+
+	private:
+		struct Key
+		{
+			VkImage			image;
+			ImageSlice		slice;
+			VkImageViewType viewType;
+
+			bool operator==(const Key& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			Key				key;
+			ptr<gvk::Image> image;
+			uint32_t		refCount;
+			// evicted views are destroyed instead of being kept in the unused list
+			bool			evicted;
+			// position in the unused list, valid when refCount is 0
+			std::list<VkImageView>::iterator unusedIter;
+		};
+
+		struct RetiringView
+		{
+			VkImageView		view;
+			ptr<gvk::Image> image;
+			uint64_t		retireFrame;
+		};
+
+		void		Reference(Entry& entry);
+		// removes an unreferenced view from the cache, it is destroyed after frames on flight retire
+		void		Retire(VkImageView view);
+		void		DestroyView(VkImageView view);
+
+		ptr<gvk::Context>						 m_Context;
+		uint32_t								 m_FlightFrameCount = 1;
+		uint32_t								 m_Capacity = 0;
+		uint64_t								 m_FrameCounter = 0;
+
+		std::unordered_map<Key, VkImageView, KeyHash> m_Views;
+		std::unordered_map<VkImageView, Entry>	 m_Entries;
+		// unreferenced views, the least recently released one comes first
+		std::list<VkImageView>					 m_UnusedViews;
+		std::vector<RetiringView>				 m_RetiringViews;
+
+		ImageViewCacheStatistics				 m_Statistics;
+	};
+
+	struct FrameBufferCacheStatistics
+	{
+		uint64_t hitCount = 0;
+		uint64_t missCount = 0;
+		uint32_t liveFrameBufferCount = 0;
+		uint32_t unusedFrameBufferCount = 0;
+		uint32_t capacity = 0;
+		uint32_t retiringFrameBufferCount = 0;
+
+		float	 HitRate() const
+		{
+			uint64_t total = hitCount + missCount;
+			return total == 0 ? 0.f : (float)hitCount / total;
+		}
+	};
+
+	// description of an image which could be attached to an imageless frame buffer
+	struct FrameBufferAttachmentImage
+	{
+		VkImageCreateFlags flags;
+		VkImageUsageFlags  usage;
+		uint32_t		   width;
+		uint32_t		   height;
+		uint32_t		   layerCount;
+		VkFormat		   format;
+
+		bool operator==(const FrameBufferAttachmentImage& other) const;
+	};
+
+	/// <summary>
+	/// Frame buffers shared by the whole graph, keyed by render pass, extension and attachments.
+	/// Frame buffers with views are keyed by the views, imageless frame buffers are keyed by
+	/// the description of attached images so that rebinding images of the same kind is free.
+	/// Released frame buffers are kept in a least recently used list like image views, frame buffers dropped
+	/// from the list are destroyed after the frames on flight which might use them have retired.
+	/// </summary>
+	class FrameBufferCache
+	{
+	public:
+		FrameBufferCache() = default;
+		~FrameBufferCache();
+
+		FrameBufferCache(const FrameBufferCache&) = delete;
+		FrameBufferCache& operator=(const FrameBufferCache&) = delete;
+
+		// frame buffers hold references to their views in viewCache, so that cached frame buffers never refer to destroyed views
+		void		  Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity, ImageViewCache* viewCache);
+
+		VkFramebuffer Acquire(ptr<gvk::RenderPass> renderPass, const std::vector<VkImageView>& views, uint32_t width, uint32_t height, uint32_t layers);
+		// requires VK_KHR_imageless_framebuffer, views are provided when the render pass begins
+		VkFramebuffer AcquireImageless(ptr<gvk::RenderPass> renderPass, const std::vector<FrameBufferAttachmentImage>& images, uint32_t width, uint32_t height, uint32_t layers);
+		void		  Release(VkFramebuffer frameBuffer);
+		// frame buffers attached with views of the image are not handed out again, see ImageViewCache::EvictImage
+		void		  EvictImage(VkImage image);
+
+		// should be called once at the beginning of every frame
+		void		  OnNewFrame();
+
+		const FrameBufferCacheStatistics& GetStatistics();
+
+	private:
+		struct Key
+		{
+			VkRenderPass							renderPass;
+			uint32_t								width, height, layers;
+			bool									imageless;
+			std::vector<VkImageView>				views;
+			std::vector<FrameBufferAttachmentImage> images;
+
+			bool operator==(const Key& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry
+		{
+			Key				   key;
+			// keep the render pass alive while frame buffers created from it are alive
+			ptr<gvk::RenderPass> renderPass;
+			uint32_t		   refCount;
+			bool			   evicted;
+			std::list<VkFramebuffer>::iterator unusedIter;
+		};
+
+		struct RetiringFrameBuffer
+		{
+			VkFramebuffer		 frameBuffer;
+			ptr<gvk::RenderPass> renderPass;
+			std::vector<VkImageView> views;
+			uint64_t			 retireFrame;
+		};
+
+		VkFramebuffer Acquire(Key& key, ptr<gvk::RenderPass> renderPass);
+		VkFramebuffer CreateFrameBuffer(const Key& key);
+		void		  Retire(VkFramebuffer frameBuffer);
+
+		ptr<gvk::Context>								 m_Context;
+		ImageViewCache*									 m_ViewCache = NULL;
+		uint32_t										 m_FlightFrameCount = 1;
+		uint32_t										 m_Capacity = 0;
+		uint64_t										 m_FrameCounter = 0;
+
+		std::unordered_map<Key, VkFramebuffer, KeyHash> m_FrameBuffers;
+		std::unordered_map<VkFramebuffer, Entry>		 m_Entries;
+		std::list<VkFramebuffer>						 m_UnusedFrameBuffers;
+		std::vector<RetiringFrameBuffer>				 m_RetiringFrameBuffers;
+
+		FrameBufferCacheStatistics						 m_Statistics;
+	};
+
+	struct ImagePoolStatistics
+	{
+		// images handed out from the pool instead of being created
+		uint64_t reuseCount = 0;
+		uint64_t createCount = 0;
+		uint32_t pooledImageCount = 0;
+	};
+
+	/// <summary>
+	/// Images released by resizing, bucketed by their create info with the extent rounded up to a size class.
+	/// Screen relative images are created at their size class, so that a released image could be reused by any
+	/// resource of the same kind and size class after the frames on flight which might use it have retired.
+	/// </summary>
+	class ImagePool
+	{
+	public:
+		ImagePool() = default;
+
+		ImagePool(const ImagePool&) = delete;
+		ImagePool& operator=(const ImagePool&) = delete;
+
+		// at most capacity released images are kept, the least recently released images are destroyed first
+		void			Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount, uint32_t capacity);
+
+		// width and height are rounded up to multiples of this
+		static constexpr uint32_t sizeClassGranularity = 64;
+		static VkExtent3D GetSizeClass(VkExtent3D extent);
+		// whether an image of imageExtent could hold extent without wasting more than a size class
+		static bool		InSizeClass(VkExtent3D imageExtent, VkExtent3D extent);
+
+		// with sizeClassed, the returned image might be larger than info.extent but lies in its size class,
+		// otherwise the extent of the image is exactly info.extent
+		ptr<gvk::Image> Acquire(const GvkImageCreateInfo& info, bool sizeClassed);
+		// info is the create info of the image
+		void			Release(ptr<gvk::Image> image, const GvkImageCreateInfo& info);
+		// images from another graph, the device should be idle so that they could be reused immediately
+		void			Adopt(ptr<gvk::Image> image, const GvkImageCreateInfo& info);
+
+		// should be called once at the beginning of every frame
+		void			OnNewFrame();
+
+		const ImagePoolStatistics& GetStatistics();
+
+	private:
+		struct Key
+		{
+			VkExtent3D		   extent;
+			uint32_t		   arrayLayers;
+			uint32_t		   mipLevels;
+			VkImageCreateFlags flags;
+			VkFormat		   format;
+			VkImageType		   imageType;
+			VkImageTiling	   tiling;
+			VkImageUsageFlags  usage;
+			VkSampleCountFlagBits samples;
+
+			// extent is rounded up to its size class
+			Key(const GvkImageCreateInfo& info);
+			bool operator==(const Key& other) const;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const Key& key) const;
+		};
+
+		struct PooledImage
+		{
+			ptr<gvk::Image> image;
+			VkExtent3D		extent;
+			uint64_t		releaseFrame;
+			// adopted images are not used by any frame on flight of this pool
+			bool			adopted;
+		};
+
+		bool			IsRetired(const PooledImage& image);
+
+		ptr<gvk::Context> m_Context;
+		uint32_t		  m_FlightFrameCount = 1;
+		uint32_t		  m_Capacity = 0;
+		uint64_t		  m_FrameCounter = 0;
+
+		std::unordered_map<Key, std::vector<PooledImage>, KeyHash> m_Buckets;
+
+		ImagePoolStatistics m_Statistics;
+	};
+
+	struct RenderPassCacheStatistics
+	{
+		uint64_t hitCount = 0;
+		uint64_t missCount = 0;
+		uint64_t evictCount = 0;
+		uint32_t renderPassCount = 0;
+	};
+
+	/// <summary>
+	/// Description of a render pass as the sequence of calls building its GvkRenderPassCreateInfo,
+	/// equal keys create equivalent render passes.
+	/// </summary>
+	struct RenderPassKey
+	{
+		enum Call : uint32_t
+		{
+			Attachment,
+			Subpass,
+			SubpassDependency,
+			SubpassInputAttachment,
+			SubpassColorAttachment,
+			SubpassDepthStencilAttachment
+		};
+
+		std::vector<uint32_t> words;
+
+		void Add(Call call, std::initializer_list<uint32_t> args);
+		bool operator==(const RenderPassKey& other) const;
+	};
+
+	/// <summary>
+	/// Render passes shared by the whole graph, keyed by their description.
+	/// Render passes live as long as the cache, a reloaded graph adopts the cache of the graph it replaces
+	/// so that only render passes with changed descriptions are created.
+	/// </summary>
+	class RenderPassCache
+	{
+	public:
+		RenderPassCache() = default;
+
+		RenderPassCache(const RenderPassCache&) = delete;
+		RenderPassCache& operator=(const RenderPassCache&) = delete;
+
+		void							  Initialize(ptr<gvk::Context> ctx);
+
+		opt<ptr<gvk::RenderPass>>		  Acquire(const RenderPassKey& key, GvkRenderPassCreateInfo& info);
+		// render passes of the other cache are kept until the next EvictUnused
+		void							  Adopt(RenderPassCache& other);
+		// called after compiling, render passes not acquired since the last call are released
+		void							  EvictUnused();
+
+		const RenderPassCacheStatistics& GetStatistics();
+
+	private:
+		struct KeyHash
+		{
+			size_t operator()(const RenderPassKey& key) const;
+		};
+
+		struct Entry
+		{
+			ptr<gvk::RenderPass> renderPass;
+			bool				 used;
+		};
+
+		ptr<gvk::Context>									 m_Context;
+		std::unordered_map<RenderPassKey, Entry, KeyHash> m_RenderPasses;
+
+		RenderPassCacheStatistics											 m_Statistics;
+	};
+}
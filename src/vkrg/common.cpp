@@ -0,0 +1,78 @@
+#include "common.h"
+
+namespace vkrg
+{
+	std::string EscapeString(std::string_view str)
+	{
+		std::string rv;
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+			{
+				rv += '\\';
+				rv += c;
+			}
+			else if (c == '\n')
+			{
+				rv += "\\n";
+			}
+			else if ((unsigned char)c >= 0x20)
+			{
+				rv += c;
+			}
+		}
+		return rv;
+	}
+
+	NameInterner& NameInterner::Global()
+	{
+		static NameInterner names;
+		return names;
+	}
+
+	uint32_t NameInterner::Intern(HashedName name)
+	{
+		std::unique_lock<std::shared_mutex> lock(m_Lock);
+		if (uint32_t id = FindLocked(name); id != invalidId) return id;
+
+		uint32_t id = m_Names.size();
+		m_Names.emplace_back(name.name);
+
+		// the new name is pushed to the front of the chain
+		auto [iter, inserted] = m_Table.try_emplace(name.hash, id);
+		m_Collisions.push_back(inserted ? invalidId : iter->second);
+		iter->second = id;
+		return id;
+	}
+
+	uint32_t NameInterner::Find(HashedName name)
+	{
+		std::shared_lock<std::shared_mutex> lock(m_Lock);
+		return FindLocked(name);
+	}
+
+	uint32_t NameInterner::FindLocked(HashedName name)
+	{
+		auto iter = m_Table.find(name.hash);
+		if (iter == m_Table.end()) return invalidId;
+
+		uint32_t id = iter->second;
+		while (id != invalidId && m_Names[id] != name.name)
+		{
+			id = m_Collisions[id];
+		}
+		return id;
+	}
+
+	const std::string& NameInterner::Get(uint32_t id)
+	{
+		std::shared_lock<std::shared_mutex> lock(m_Lock);
+		return m_Names[id];
+	}
+
+	uint32_t NameInterner::Count()
+	{
+		std::shared_lock<std::shared_mutex> lock(m_Lock);
+		return m_Names.size();
+	}
+}
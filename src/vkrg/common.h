@@ -2,11 +2,18 @@
 #include <gvk.h>
 #include <memory.h>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <stdint.h>
 #include <tuple>
 #include <fstream>
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
 
 namespace vkrg 
 {
@@ -18,6 +25,62 @@ namespace vkrg
 
 	template<typename ...Args>
 	using tpl = std::tuple<Args...>;
+
+	// escapes strings written to json and graphviz documents
+	std::string EscapeString(std::string_view str);
+
+	// 64 bit FNV-1a, names written as literals could be hashed at compile time
+	constexpr uint64_t HashName(std::string_view name)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : name)
+		{
+			hash = (hash ^ (uint8_t)c) * 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	/// <summary>
+	/// A view of a name with its hash, lookups taking hashed names never copy the name.
+	/// The viewed string should outlive the hashed name.
+	/// </summary>
+	struct HashedName
+	{
+		std::string_view name;
+		uint64_t		 hash;
+
+		constexpr HashedName(std::string_view name) :name(name), hash(HashName(name)) {}
+		constexpr HashedName(const char* name) :HashedName(std::string_view(name)) {}
+		HashedName(const std::string& name) :HashedName(std::string_view(name)) {}
+	};
+
+	/// <summary>
+	/// Stores every distinct name once, ids are indices of names in the interning order.
+	/// Interned names never move, their c_str() could be kept. Names are looked up by their precomputed hashes.
+	/// </summary>
+	class NameInterner
+	{
+	public:
+		static constexpr uint32_t invalidId = 0xffffffff;
+
+		// names of resources and passes of all render graphs, ids of it are stable for the whole program
+		static NameInterner& Global();
+
+		uint32_t		   Intern(HashedName name);
+		// names are only interned while building graphs, lookups of different threads don't block each other
+		uint32_t		   Find(HashedName name);
+		const std::string& Get(uint32_t id);
+		uint32_t		   Count();
+
+	private:
+		uint32_t		   FindLocked(HashedName name);
+
+		// hash to the first id with the hash, names with the same hash are chained by m_Collisions
+		std::unordered_map<uint64_t, uint32_t> m_Table;
+		std::vector<uint32_t>				   m_Collisions;
+		std::deque<std::string>				   m_Names;
+		std::shared_mutex					   m_Lock;
+	};
 }
 
 
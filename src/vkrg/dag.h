@@ -1,6 +1,7 @@
 #pragma once
 #include <vkrg/common.h>
 #include <queue>
+#include <functional>
 #include <unordered_set>
 
 namespace vkrg
@@ -47,63 +48,13 @@ namespace vkrg
 		/// <returns> whether the sorting operation success or not</returns>
 		bool		 Sort()
 		{
-			std::queue<uint32_t> next_nodes;
-			std::vector<uint32_t> degrees(m_nodeCount);
-
-			for (uint32_t i = 0;i < m_nodeCount; i++)
-			{
-				auto& adj = m_adjInList[i];
-				if (adj.empty())
-				{
-					next_nodes.push(i);
-				}
-				degrees[i] = adj.size();
-			}
-
-			// cycle in graph
-			if (next_nodes.empty())
-			{
-				return false;
-			}
-
-			uint32_t idx = 0;
-			std::vector<uint32_t> new_id_to_idx(m_nodeCount);
-			
-			while (!next_nodes.empty())
-			{
-				uint32_t id = next_nodes.front();
-				next_nodes.pop();
-				new_id_to_idx[id] = idx++;
-				
-				auto& adj = m_adjOutList[id];
-				for (auto adj_id : adj)
-				{
-					degrees[adj_id]--;
-					if (degrees[adj_id] == 0)
-					{
-						next_nodes.push(adj_id);
-					}
-				}
-			}
-
-			// cycle in graph
-			if (idx != m_nodeCount)
+			std::vector<uint32_t> new_id_to_idx;
+			if (!KahnOrder(new_id_to_idx))
 			{
 				return false;
 			}
 
-			std::vector<Node>	new_node_list(m_nodeCount + 1);
-			for (uint32_t id = 0;id < m_nodeCount;id++)
-			{
-				uint32_t old_idx = m_idToIdx[id];
-				uint32_t new_idx = new_id_to_idx[id];
-				new_node_list[new_idx] = m_nodes[old_idx];
-			}
-			new_node_list[m_nodeCount] = Node{ T(), invalid_id };
-
-			m_nodes = new_node_list;
-			m_idToIdx = new_id_to_idx;
-
+			ApplyOrder(new_id_to_idx);
 			return true;
 		}
 
@@ -163,18 +114,115 @@ namespace vkrg
 				return false;
 			}
 
-			std::vector<Node>	new_node_list(m_nodeCount + 1);
+			ApplyOrder(new_id_to_idx);
+			return true;
+		}
+
+		/// <summary>
+		/// Sort the graph by topological order, separating producers from their consumers by independent nodes.
+		/// Among the ready nodes, the ones whose inputs were produced long enough ago are visited first,
+		/// ties are broken by the longest path to sink nodes so producers tend to go earlier.
+		/// Every node stays within maxLifetimeExtension / 2 of its position generated by Sort(),
+		/// so the distance between a node and its last consumer won't grow more than maxLifetimeExtension.
+		/// </summary>
+		/// <param name="maxLifetimeExtension"> max extra distance between a node and its last consumer</param>
+		/// <returns> whether the sorting operation success or not</returns>
+		bool		 SortOverlapAware(uint32_t maxLifetimeExtension)
+		{
+			std::vector<uint32_t> kahn_id_to_idx;
+			if (!KahnOrder(kahn_id_to_idx))
+			{
+				return false;
+			}
+
+			std::vector<uint32_t> kahn_order(m_nodeCount);
 			for (uint32_t id = 0; id < m_nodeCount; id++)
 			{
-				uint32_t old_idx = m_idToIdx[id];
-				uint32_t new_idx = new_id_to_idx[id];
-				new_node_list[new_idx] = m_nodes[old_idx];
+				kahn_order[kahn_id_to_idx[id]] = id;
 			}
-			new_node_list[m_nodeCount] = Node{ T(), invalid_id };
 
-			m_nodes = new_node_list;
-			m_idToIdx = new_id_to_idx;
+			// depth : longest path from source nodes, height : longest path to sink nodes
+			std::vector<uint32_t> depths(m_nodeCount, 0), heights(m_nodeCount, 0);
+			for (uint32_t i = 0; i < m_nodeCount; i++)
+			{
+				uint32_t id = kahn_order[i];
+				for (auto adj_id : m_adjInList[id])
+				{
+					depths[id] = std::max(depths[id], depths[adj_id] + 1);
+				}
+
+				id = kahn_order[m_nodeCount - 1 - i];
+				for (auto adj_id : m_adjOutList[id])
+				{
+					heights[id] = std::max(heights[id], heights[adj_id] + 1);
+				}
+			}
+
+			const uint32_t displacement = maxLifetimeExtension / 2;
+			// distance between a producer and its consumer that is considered as enough to hide the dependency
+			const uint32_t window = displacement + 1;
+
+			std::vector<uint32_t> ready;
+			std::vector<uint32_t> degrees(m_nodeCount);
+			std::vector<uint32_t> last_input(m_nodeCount, 0);
+			std::vector<uint32_t> new_id_to_idx(m_nodeCount, invalid_id);
+
+			for (uint32_t i = 0; i < m_nodeCount; i++)
+			{
+				degrees[i] = m_adjInList[i].size();
+				if (degrees[i] == 0)
+				{
+					ready.push_back(i);
+				}
+			}
+
+			// the unvisited node comes first in kahn's order, it is always ready
+			uint32_t first = 0;
+			for (uint32_t idx = 0; idx < m_nodeCount; idx++)
+			{
+				while (new_id_to_idx[kahn_order[first]] != invalid_id) first++;
+
+				auto slack = [&](uint32_t id)
+				{
+					return m_adjInList[id].empty() ? window : std::min(idx - last_input[id], window);
+				};
+
+				// returns true if lhs should be visited before rhs
+				auto before = [&](uint32_t lhs, uint32_t rhs)
+				{
+					if (slack(lhs) != slack(rhs)) return slack(lhs) > slack(rhs);
+					if (heights[lhs] != heights[rhs]) return heights[lhs] > heights[rhs];
+					if (depths[lhs] != depths[rhs]) return depths[lhs] < depths[rhs];
+					return lhs < rhs;
+				};
+
+				uint32_t best = std::find(ready.begin(), ready.end(), kahn_order[first]) - ready.begin();
+				// the first node can't be delayed any more
+				if (first + displacement > idx)
+				{
+					for (uint32_t i = 0; i < ready.size(); i++)
+					{
+						// nodes can't be visited too early either
+						if (kahn_id_to_idx[ready[i]] <= idx + displacement && before(ready[i], ready[best])) best = i;
+					}
+				}
+
+				uint32_t id = ready[best];
+				ready[best] = ready.back();
+				ready.pop_back();
+				new_id_to_idx[id] = idx;
+
+				for (auto adj_id : m_adjOutList[id])
+				{
+					last_input[adj_id] = idx;
+					if (--degrees[adj_id] == 0)
+					{
+						ready.push_back(adj_id);
+					}
+				}
+			}
 
+			ApplyOrder(new_id_to_idx);
 			return true;
 		}
 
@@ -594,6 +642,66 @@ namespace vkrg
 		}
 
 	private:
+		bool		 KahnOrder(std::vector<uint32_t>& new_id_to_idx)
+		{
+			std::queue<uint32_t> next_nodes;
+			std::vector<uint32_t> degrees(m_nodeCount);
+
+			for (uint32_t i = 0;i < m_nodeCount; i++)
+			{
+				auto& adj = m_adjInList[i];
+				if (adj.empty())
+				{
+					next_nodes.push(i);
+				}
+				degrees[i] = adj.size();
+			}
+
+			// cycle in graph
+			if (next_nodes.empty())
+			{
+				return false;
+			}
+
+			uint32_t idx = 0;
+			new_id_to_idx.resize(m_nodeCount);
+			
+			while (!next_nodes.empty())
+			{
+				uint32_t id = next_nodes.front();
+				next_nodes.pop();
+				new_id_to_idx[id] = idx++;
+				
+				auto& adj = m_adjOutList[id];
+				for (auto adj_id : adj)
+				{
+					degrees[adj_id]--;
+					if (degrees[adj_id] == 0)
+					{
+						next_nodes.push(adj_id);
+					}
+				}
+			}
+
+			// cycle in graph
+			return idx == m_nodeCount;
+		}
+
+		void		 ApplyOrder(const std::vector<uint32_t>& new_id_to_idx)
+		{
+			std::vector<Node>	new_node_list(m_nodeCount + 1);
+			for (uint32_t id = 0; id < m_nodeCount; id++)
+			{
+				uint32_t old_idx = m_idToIdx[id];
+				uint32_t new_idx = new_id_to_idx[id];
+				new_node_list[new_idx] = m_nodes[old_idx];
+			}
+			new_node_list[m_nodeCount] = Node{ T(), invalid_id };
+
+			m_nodes = new_node_list;
+			m_idToIdx = new_id_to_idx;
+		}
+
 		struct Node
 		{
 			T val;
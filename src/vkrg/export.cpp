@@ -0,0 +1,317 @@
+#include "graph.h"
+
+namespace vkrg
+{
+	void RenderGraph::ExportGraphviz(std::ostream& os, uint32_t frameIdx)
+	{
+		vkrg_assert(m_HaveCompiled);
+
+		auto lifetimes = CollectLogicalResourceLifetimes();
+
+		os << "digraph RenderGraph {\n";
+		os << "\trankdir=LR;\n";
+		os << "\tnode [fontname=\"Consolas\"];\n";
+
+		// every merged pass is a cluster of its render passes
+		for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+		{
+			auto& passInfo = m_renderGraphPassInfo[passIdx];
+
+			uint32_t barrierCount = 0;
+			if (passInfo.IsGraphicsPass())
+			{
+				barrierCount = passInfo.render.bufferBarriers.size() + passInfo.render.dynamic.beginBarriers.size() + passInfo.render.dynamic.endBarriers.size();
+			}
+			else
+			{
+				barrierCount = passInfo.compute.barriers.size();
+			}
+
+			os << "\tsubgraph cluster_" << passIdx << " {\n";
+			os << "\t\tlabel=\"#" << passIdx << (passInfo.IsGraphicsPass() ? " graphics" : " compute");
+			if (passInfo.IsGraphicsPass() && passInfo.render.dynamicRendering)
+			{
+				os << " dynamic rendering";
+			}
+			os << "\\nbarriers: " << barrierCount;
+			if (auto ms = GetPassInfoGpuMilliseconds(passIdx, frameIdx); ms.has_value())
+			{
+				os << "\\n" << ms.value() << " ms";
+			}
+			os << "\";\n";
+
+			for (auto rpIdx : GetPassInfoRenderPasses(passIdx))
+			{
+				os << "\t\tpass" << rpIdx << " [shape=box, label=\"" << EscapeString(m_RenderPassList[rpIdx].pass->GetName()) << "\"];\n";
+			}
+			os << "\t}\n";
+		}
+
+		// culled passes are drawn but not clustered
+		for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+		{
+			if (!m_CulledRenderPasses[rpIdx]) continue;
+			os << "\tpass" << rpIdx << " [shape=box, style=dashed, label=\"" << EscapeString(m_RenderPassList[rpIdx].pass->GetName()) << " (culled)\"];\n";
+		}
+
+		for (uint32_t resIdx = 0; resIdx < m_LogicalResourceList.size(); resIdx++)
+		{
+			auto& assign = m_LogicalResourceAssignmentTable[resIdx];
+			auto [first, last] = lifetimes[resIdx];
+
+			os << "\tresource" << resIdx << " [shape=ellipse, label=\"" << EscapeString(m_LogicalResourceList[resIdx].name);
+			if (!assign.Invalid())
+			{
+				os << "\\n" << (assign.external ? "external " : "physical ") << assign.idx;
+			}
+			if (first != invalidIdx)
+			{
+				os << "\\nlifetime [" << first << ", " << last << "]";
+			}
+			os << "\"" << (assign.external ? ", style=bold" : "") << "];\n";
+		}
+
+		// edges of culled passes are kept, they explain why a pass is culled
+		for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+		{
+			auto& attachments = m_RenderPassList[rpIdx].pass->GetAttachments();
+			auto& resources = m_RenderPassList[rpIdx].pass->GetAttachedResourceHandles();
+			for (uint32_t i = 0; i < attachments.size(); i++)
+			{
+				if (attachments[i].WriteToResource())
+				{
+					os << "\tpass" << rpIdx << " -> resource" << resources[i].idx << ";\n";
+				}
+				else
+				{
+					os << "\tresource" << resources[i].idx << " -> pass" << rpIdx << ";\n";
+				}
+			}
+		}
+
+		os << "}\n";
+	}
+
+	void RenderGraph::ExportJson(std::ostream& os, uint32_t frameIdx)
+	{
+		vkrg_assert(m_HaveCompiled);
+
+		auto lifetimes = CollectLogicalResourceLifetimes();
+
+		os << "{\n\"passes\": [";
+		for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+		{
+			auto& passInfo = m_renderGraphPassInfo[passIdx];
+
+			os << (passIdx == 0 ? "\n" : ",\n");
+			os << "{\"index\": " << passIdx << ", \"name\": \"" << EscapeString(GetPassInfoName(passIdx)) << "\"";
+			os << ", \"type\": \"" << (passInfo.IsGraphicsPass() ? "graphics" : "compute") << "\"";
+			// passes of a dispatch group share the merged pass
+			os << ", \"mergedPass\": " << passInfo.targetMergedPassIdx;
+			os << ", \"dynamicRendering\": " << (passInfo.IsGraphicsPass() && passInfo.render.dynamicRendering ? "true" : "false");
+			if (auto ms = GetPassInfoGpuMilliseconds(passIdx, frameIdx); ms.has_value())
+			{
+				os << ", \"gpuMilliseconds\": " << ms.value();
+			}
+
+			os << ", \"renderPasses\": [";
+			bool firstRenderPass = true;
+			for (auto rpIdx : GetPassInfoRenderPasses(passIdx))
+			{
+				auto& attachments = m_RenderPassList[rpIdx].pass->GetAttachments();
+				auto& resources = m_RenderPassList[rpIdx].pass->GetAttachedResourceHandles();
+
+				os << (firstRenderPass ? "" : ", ");
+				os << "{\"index\": " << rpIdx << ", \"name\": \"" << EscapeString(m_RenderPassList[rpIdx].pass->GetName()) << "\"";
+				for (bool write : { false, true })
+				{
+					os << (write ? ", \"writes\": [" : ", \"reads\": [");
+					bool firstResource = true;
+					for (uint32_t i = 0; i < attachments.size(); i++)
+					{
+						if (attachments[i].WriteToResource() != write) continue;
+						os << (firstResource ? "" : ", ") << resources[i].idx;
+						firstResource = false;
+					}
+					os << "]";
+				}
+				os << "}";
+				firstRenderPass = false;
+			}
+			os << "]";
+
+			os << ", \"barriers\": [";
+			bool firstBarrier = true;
+			if (passInfo.IsGraphicsPass())
+			{
+				ExportBarriersJson(os, "before", passInfo.render.bufferBarriers, firstBarrier);
+				ExportBarriersJson(os, "skip", passInfo.render.skipBarriers, firstBarrier);
+				ExportBarriersJson(os, "renderingBegin", passInfo.render.dynamic.beginBarriers, firstBarrier);
+				ExportBarriersJson(os, "renderingEnd", passInfo.render.dynamic.endBarriers, firstBarrier);
+			}
+			else
+			{
+				ExportBarriersJson(os, "before", passInfo.compute.barriers, firstBarrier);
+			}
+			os << "]}";
+		}
+		os << "\n],\n";
+
+		os << "\"culledRenderPasses\": [";
+		bool firstCulled = true;
+		for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+		{
+			if (!m_CulledRenderPasses[rpIdx]) continue;
+			os << (firstCulled ? "" : ", ") << "\"" << EscapeString(m_RenderPassList[rpIdx].pass->GetName()) << "\"";
+			firstCulled = false;
+		}
+		os << "],\n";
+
+		// lifetimes are inclusive ranges of pass indices
+		os << "\"resources\": [";
+		for (uint32_t resIdx = 0; resIdx < m_LogicalResourceList.size(); resIdx++)
+		{
+			auto& resource = m_LogicalResourceList[resIdx];
+			auto& assign = m_LogicalResourceAssignmentTable[resIdx];
+			auto [first, last] = lifetimes[resIdx];
+
+			os << (resIdx == 0 ? "\n" : ",\n");
+			os << "{\"index\": " << resIdx << ", \"name\": \"" << EscapeString(resource.name) << "\"";
+			os << ", \"external\": " << (resource.handle.external ? "true" : "false");
+			os << ", \"buffer\": " << (resource.info.IsBuffer() ? "true" : "false");
+			os << ", \"format\": " << (uint32_t)resource.info.format;
+			if (!assign.Invalid() && !assign.external)
+			{
+				os << ", \"physicalResource\": " << assign.idx;
+			}
+			if (first != invalidIdx)
+			{
+				os << ", \"lifetime\": [" << first << ", " << last << "]";
+			}
+			os << "}";
+		}
+		os << "\n],\n";
+
+		os << "\"physicalResources\": [";
+		for (uint32_t phyIdx = 0; phyIdx < m_PhysicalResources.size(); phyIdx++)
+		{
+			uint32_t first = invalidIdx, last = 0;
+
+			os << (phyIdx == 0 ? "\n" : ",\n");
+			os << "{\"index\": " << phyIdx << ", \"logicalResources\": [";
+			bool firstLogical = true;
+			for (uint32_t resIdx = 0; resIdx < m_LogicalResourceList.size(); resIdx++)
+			{
+				auto& assign = m_LogicalResourceAssignmentTable[resIdx];
+				if (assign.Invalid() || assign.external || assign.idx != phyIdx) continue;
+
+				os << (firstLogical ? "" : ", ") << resIdx;
+				firstLogical = false;
+
+				auto [resFirst, resLast] = lifetimes[resIdx];
+				if (resFirst == invalidIdx) continue;
+				first = vkrg_min(first, resFirst);
+				last = vkrg_max(last, resLast);
+			}
+			os << "]";
+			if (first != invalidIdx)
+			{
+				os << ", \"lifetime\": [" << first << ", " << last << "]";
+			}
+			os << "}";
+		}
+		os << "\n],\n";
+
+		os << "\"finalBarriers\": [";
+		bool firstFinalBarrier = true;
+		ExportBarriersJson(os, "final", m_finalGlobalBarriers, firstFinalBarrier);
+		os << "]\n}\n";
+	}
+
+	std::vector<uint32_t> RenderGraph::GetPassInfoRenderPasses(uint32_t passIdx)
+	{
+		auto& passInfo = m_renderGraphPassInfo[passIdx];
+		if (passInfo.IsGraphicsPass())
+		{
+			return passInfo.render.mergedSubpassIndices;
+		}
+		return { passInfo.compute.targetRenderPass };
+	}
+
+	uint32_t RenderGraph::GetPassInfoMergedPass(uint32_t passIdx)
+	{
+		return m_renderGraphPassInfo[passIdx].targetMergedPassIdx;
+	}
+
+	opt<double> RenderGraph::GetPassInfoGpuMilliseconds(uint32_t passIdx, uint32_t frameIdx)
+	{
+		if (!m_Options.gpuProfiling || m_PassGpuScopes[passIdx] == invalidGpuScope) return std::nullopt;
+
+		auto& timing = m_GpuProfiler.GetTimings(frameIdx)[m_PassGpuScopes[passIdx]];
+		if (!timing.valid) return std::nullopt;
+		return timing.milliseconds;
+	}
+
+	std::vector<tpl<uint32_t, uint32_t>> RenderGraph::CollectLogicalResourceLifetimes()
+	{
+		std::vector<tpl<uint32_t, uint32_t>> lifetimes(m_LogicalResourceList.size(), std::make_tuple(invalidIdx, invalidIdx));
+
+		// pass infos are in schedule order
+		for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+		{
+			for (auto rpIdx : GetPassInfoRenderPasses(passIdx))
+			{
+				for (auto& resource : m_RenderPassList[rpIdx].pass->GetAttachedResourceHandles())
+				{
+					auto& [first, last] = lifetimes[resource.idx];
+					first = first == invalidIdx ? passIdx : first;
+					last = passIdx;
+				}
+			}
+		}
+
+		return lifetimes;
+	}
+
+	std::string RenderGraph::GetBarrierResourceName(RenderGraphBarrier::Handle handle)
+	{
+		if (handle.external)
+		{
+			return m_ExternalResources[handle.idx].name;
+		}
+		return "physical" + std::to_string(handle.idx);
+	}
+
+	void RenderGraph::ExportBarriersJson(std::ostream& os, const char* kind, std::vector<RenderGraphBarrier>& barriers, bool& first)
+	{
+		// barriers of every frame on flight only differ in resources, the first frame is exported
+		for (auto& barrier : barriers)
+		{
+			os << (first ? "" : ", ");
+			os << "{\"kind\": \"" << kind << "\", \"srcStage\": " << (uint32_t)barrier.srcStage << ", \"dstStage\": " << (uint32_t)barrier.dstStage;
+
+			os << ", \"images\": [";
+			for (uint32_t i = 0; i < barrier.imageBarriers[0].size(); i++)
+			{
+				auto& imageBarrier = barrier.imageBarriers[0][i];
+				os << (i == 0 ? "" : ", ");
+				os << "{\"resource\": \"" << EscapeString(GetBarrierResourceName(barrier.imageBarrierHandles[i])) << "\"";
+				os << ", \"srcAccess\": " << imageBarrier.srcAccessMask << ", \"dstAccess\": " << imageBarrier.dstAccessMask;
+				os << ", \"oldLayout\": " << (uint32_t)imageBarrier.oldLayout << ", \"newLayout\": " << (uint32_t)imageBarrier.newLayout << "}";
+			}
+			os << "]";
+
+			os << ", \"buffers\": [";
+			for (uint32_t i = 0; i < barrier.bufferBarriers[0].size(); i++)
+			{
+				auto& bufferBarrier = barrier.bufferBarriers[0][i];
+				os << (i == 0 ? "" : ", ");
+				os << "{\"resource\": \"" << EscapeString(GetBarrierResourceName(barrier.bufferBarrierHandles[i])) << "\"";
+				os << ", \"srcAccess\": " << bufferBarrier.srcAccessMask << ", \"dstAccess\": " << bufferBarrier.dstAccessMask << "}";
+			}
+			os << "]}";
+
+			first = false;
+		}
+	}
+}
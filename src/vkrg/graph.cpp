@@ -1,4 +1,6 @@
 #include "graph.h"
+#include "trace.h"
+#include "layout.h"
 
 
 namespace vkrg
@@ -9,9 +11,12 @@ namespace vkrg
         m_FormatCompabilityCache.formatProperties.resize(ResourceFormatCompabilityCache::supportedFormatCount);
     }
 
-    opt<ResourceHandle> RenderGraph::FindGraphResource(const char* name)
+    opt<ResourceHandle> RenderGraph::FindGraphResource(HashedName name)
     {
-        if (auto iter = m_LogicalResourceTable.find(name); iter != m_LogicalResourceTable.end())
+        uint32_t nameId = NameInterner::Global().Find(name);
+        if (nameId == NameInterner::invalidId) return std::nullopt;
+
+        if (auto iter = m_LogicalResourceTable.find(nameId); iter != m_LogicalResourceTable.end())
         {
             return m_LogicalResourceList[iter->second].handle;
         }
@@ -25,9 +30,12 @@ namespace vkrg
         return std::nullopt;
     }
 
-    opt<RenderPassHandle> RenderGraph::FindGraphRenderPass(const char* name)
+    opt<RenderPassHandle> RenderGraph::FindGraphRenderPass(HashedName name)
     {
-        if (auto iter = m_RenderPassTable.find(name); iter != m_RenderPassTable.end())
+        uint32_t nameId = NameInterner::Global().Find(name);
+        if (nameId == NameInterner::invalidId) return std::nullopt;
+
+        if (auto iter = m_RenderPassTable.find(nameId); iter != m_RenderPassTable.end())
         {
             return m_RenderPassList[iter->second];
         }
@@ -48,7 +56,8 @@ namespace vkrg
         // resource뱣һ֡ʱ״̬
         vkrg_assert(!keepContent || layout != VK_IMAGE_LAYOUT_UNDEFINED);
 
-        if (FindGraphResource(name).has_value()) return std::nullopt;
+        uint32_t nameId = NameInterner::Global().Intern(name);
+        if (m_LogicalResourceTable.count(nameId)) return std::nullopt;
 
         ResourceHandle handle;
         handle.idx = m_LogicalResourceList.size();
@@ -61,14 +70,15 @@ namespace vkrg
         resource.finalLayout = layout;
 
         m_LogicalResourceList.push_back(resource);
-        m_LogicalResourceTable[name] = handle.idx;
+        m_LogicalResourceTable[nameId] = handle.idx;
 
         return handle;
     }
 
     opt<RenderPassHandle> RenderGraph::AddGraphRenderPass(const char* name, RenderPassType type, RenderPassExtension ext)
     {
-        if (FindGraphRenderPass(name).has_value()) return std::nullopt;
+        uint32_t nameId = NameInterner::Global().Intern(name);
+        if (m_RenderPassTable.count(nameId)) return std::nullopt;
 
         ptr<RenderPass> pass = std::make_shared<RenderPass>(this, name, type, ext);
 
@@ -77,7 +87,7 @@ namespace vkrg
         handle.idx = m_RenderPassList.size();
 
         m_RenderPassList.push_back(handle);
-        m_RenderPassTable[name] = handle.idx;
+        m_RenderPassTable[nameId] = handle.idx;
 
         return handle;
     }
@@ -89,6 +99,7 @@ namespace vkrg
 
     tpl<RenderGraphCompileState, std::string> RenderGraph::Compile(RenderGraphCompileOptions options, RenderGraphDeviceContext ctx)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::Compile");
         m_vulkanContext = ctx;
 
         m_Options = options;
@@ -124,6 +135,12 @@ namespace vkrg
             return std::make_tuple(cres, msg);
         }
 
+        if (auto cres = CullUnreachablePasses(msg); cres != RenderGraphCompileState::Success)
+        {
+            msg = prefix + msg;
+            return std::make_tuple(cres, msg);
+        }
+
         {
             RenderGraphCompileState cres = RenderGraphCompileState::Success;
             if (m_Options.style == RenderGraphRenderPassStyle::OneByOne)
@@ -140,8 +157,11 @@ namespace vkrg
                 msg = prefix + msg;
                 return std::make_tuple(cres, msg);
             }
+
+            CollectScheduleStatistics();
         }
 
+
         if (auto cres = AssignPhysicalResources(msg); cres != RenderGraphCompileState::Success)
         {
             msg = prefix + msg;
@@ -172,6 +192,11 @@ namespace vkrg
         return m_LogicalResourceList[handle.idx].info;
     }
 
+    uint32_t RenderGraph::GetResourceVersion(ResourceHandle handle)
+    {
+        return m_LogicalResourceList[handle.idx].version;
+    }
+
     void RenderGraph::OnResize(uint32_t width, uint32_t height)
     {
         m_Options.screenWidth = width;
@@ -180,21 +205,43 @@ namespace vkrg
         ResizePhysicalResources();
     }
 
+    void RenderGraph::SetRenderScale(float scale)
+    {
+        m_RenderScale = vkrg_min(vkrg_max(scale, 1e-3f), 1.f);
+    }
+
+    float RenderGraph::GetRenderScale()
+    {
+        return m_RenderScale;
+    }
+
+
     tpl<RenderGraphRuntimeState, std::string> RenderGraph::Execute(uint32_t targetFrameIdx, VkCommandBuffer mainCmdBuffer)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::Execute");
         vkrg_assert(m_HaveCompiled);
 
-        std::string prefix = "Render Graph Runtime Error:";
-        std::string msg;
+        // frame buffers are retired before the views they reference
+        m_FrameBufferCache.OnNewFrame();
+        m_ImageViewCache.OnNewFrame();
+        m_ImagePool.OnNewFrame();
 
-        if (auto rv = ValidateResourceBinding(msg); rv != RenderGraphRuntimeState::Success)
+        m_FrameRenderScale = m_RenderScale;
+
+        // bindings only change through data frames and resizing, both of them mark resources dirty
+        // if nothing is dirty, bindings, views and frame buffers are the same as last frame
+        if (AnyResourceBindingDirty())
         {
-            msg = prefix + msg;
-            return std::make_tuple(rv, msg);
-        }
+            std::string msg;
+            if (auto rv = ValidateResourceBinding(msg); rv != RenderGraphRuntimeState::Success)
+            {
+                msg = "Render Graph Runtime Error:" + msg;
+                return std::make_tuple(rv, msg);
+            }
 
-        UpdateDirtyViews();
-        UpdateDirtyFrameBuffersAndBarriers();
+            UpdateDirtyViews();
+            UpdateDirtyFrameBuffersAndBarriers();
+        }
 
         GenerateCommands(mainCmdBuffer, targetFrameIdx);
 
@@ -209,6 +256,12 @@ namespace vkrg
         vkrg_assert(m_HaveCompiled);
         vkrg_assert(handle.pass->GetType() == RenderPassType::Graphics);
 
+        if (IsRenderPassCulled(handle))
+        {
+            return std::make_tuple(gvk::ptr<gvk::RenderPass>(), 0);
+        }
+
+
         auto [mergedPass, subpassIdx] = FindInvolvedMergedPass(m_RenderPassNodeList[handle.idx]).value();
 
         uint32_t renderGraphPassIndex = GetRenderGraphPassInfoIndex(mergedPass);
@@ -219,14 +272,123 @@ namespace vkrg
         return std::make_tuple(vkrp, subpassIdx);
     }
 
+    opt<RenderGraphRenderingFormats> RenderGraph::GetCompiledRenderingFormats(RenderPassHandle handle)
+    {
+        vkrg_assert(m_HaveCompiled);
+        vkrg_assert(handle.pass->GetType() == RenderPassType::Graphics);
+
+        if (IsRenderPassCulled(handle))
+        {
+            return std::nullopt;
+        }
+
+        auto [mergedPass, subpassIdx] = FindInvolvedMergedPass(m_RenderPassNodeList[handle.idx]).value();
+        auto& renderData = m_renderGraphPassInfo[GetRenderGraphPassInfoIndex(mergedPass)].render;
+        if (!renderData.dynamicRendering)
+        {
+            return std::nullopt;
+        }
+
+        return renderData.dynamic.formats;
+    }
+
     RenderGraphDataFrame RenderGraph::GetExternalDataFrame()
     {
         vkrg_assert(m_HaveCompiled);
         return RenderGraphDataFrame(this, RenderGraphDataFrame::External);
     }
 
+    const RenderGraphScheduleStatistics& RenderGraph::GetScheduleStatistics()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_ScheduleStatistics;
+    }
+
+    const ImageViewCacheStatistics& RenderGraph::GetImageViewCacheStatistics()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_ImageViewCache.GetStatistics();
+    }
+
+    const FrameBufferCacheStatistics& RenderGraph::GetFrameBufferCacheStatistics()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_FrameBufferCache.GetStatistics();
+    }
+
+    const ImagePoolStatistics& RenderGraph::GetImagePoolStatistics()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_ImagePool.GetStatistics();
+    }
+
+    const RenderPassCacheStatistics& RenderGraph::GetRenderPassCacheStatistics()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_RenderPassCache.GetStatistics();
+    }
+
+    const std::vector<GpuTiming>& RenderGraph::GetGpuTimings(uint32_t frameIdx)
+    {
+        vkrg_assert(m_HaveCompiled && m_Options.gpuProfiling);
+        vkrg_assert(frameIdx < m_Options.flightFrameCount);
+        return m_GpuProfiler.GetTimings(frameIdx);
+    }
+
+    const std::vector<GpuPipelineStatistics>& RenderGraph::GetPipelineStatistics(uint32_t frameIdx)
+    {
+        vkrg_assert(m_HaveCompiled && m_Options.pipelineStatistics);
+        vkrg_assert(frameIdx < m_Options.flightFrameCount);
+        return m_StatisticsProfiler.GetStatistics(frameIdx);
+    }
+
+    std::vector<RenderGraphPassBandwidth> RenderGraph::EstimatePassBandwidth()
+    {
+        vkrg_assert(m_HaveCompiled);
+
+        std::vector<RenderGraphPassBandwidth> estimates(m_renderGraphPassInfo.size());
+        for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+        {
+            auto& passInfo = m_renderGraphPassInfo[passIdx];
+            estimates[passIdx].name = GetPassInfoName(passIdx);
+            if (!passInfo.IsGraphicsPass()) continue;
+
+            // load and store operations only touch the render area
+            auto [w, h, _] = GetRenderExtension(passInfo.render.expectedExtension.extension, passInfo.render.expectedExtension.extensionType,
+                passInfo.render.expectedExtension.nativeResolution);
+            for (auto& attachment : passInfo.render.fbAttachmentIdx)
+            {
+                uint64_t layers = attachment.subresource.layerCount;
+                uint64_t texels = (uint64_t)w * h * layers;
+
+                estimates[passIdx].loadBytes += texels * attachment.loadBytesPerTexel;
+                estimates[passIdx].storeBytes += texels * attachment.storeBytesPerTexel;
+            }
+        }
+
+        return estimates;
+    }
+
+    bool RenderGraph::IsRenderPassCulled(RenderPassHandle handle)
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_CulledRenderPasses[handle.idx];
+    }
+
+    std::vector<RenderPassHandle> RenderGraph::GetCulledRenderPasses()
+    {
+        vkrg_assert(m_HaveCompiled);
+        std::vector<RenderPassHandle> culledPasses;
+        for (auto& renderPass : m_RenderPassList)
+        {
+            if (m_CulledRenderPasses[renderPass.idx]) culledPasses.push_back(renderPass);
+        }
+        return culledPasses;
+    }
+
     RenderGraphRuntimeState RenderGraph::ValidateResourceBinding(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ValidateResourceBinding");
 
         for (uint32_t externalBindingIdx = 0; externalBindingIdx < m_ExternalResources.size(); externalBindingIdx++)
         {
@@ -260,17 +422,40 @@ namespace vkrg
 
     RenderGraphCompileState RenderGraph::ValidateCompileOptions(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ValidateCompileOptions");
         if (m_Options.flightFrameCount < 1 || m_Options.flightFrameCount > maxFrameOnFlightCount)
         {
             msg = "invalid flight frame count, should be less than " + std::to_string(maxFrameOnFlightCount) + " and greater than 1";
             return RenderGraphCompileState::Error_InvalidCompileOption;
         }
 
+        if (m_Options.parallelRecording && m_vulkanContext.queue == nullptr)
+        {
+            msg = "parallel recording requires a command queue in device context to create command pools";
+            return RenderGraphCompileState::Error_InvalidCompileOption;
+        }
+
+        // graphs compiled without a device are only inspected, commands are never recorded for them
+        if (m_Options.dynamicRendering && m_vulkanContext.ctx != nullptr)
+        {
+            VkDevice device = m_vulkanContext.ctx->GetDevice();
+            m_CmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR");
+            m_CmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR");
+
+            if (m_CmdBeginRendering == NULL || m_CmdEndRendering == NULL)
+            {
+                msg = "dynamic rendering requires VK_KHR_dynamic_rendering enabled on device";
+                return RenderGraphCompileState::Error_InvalidCompileOption;
+            }
+        }
+
+
         return RenderGraphCompileState::Success;
     }
 
     RenderGraphCompileState RenderGraph::ValidateRenderPasses(std::string& out_msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ValidateRenderPasses");
         std::string msg = "";
 
 
@@ -308,7 +493,7 @@ namespace vkrg
                     }
                 }
 
-                if (attachment.type == RenderPassAttachment::ImageColorOutput)
+                if (attachment.type == RenderPassAttachment::ImageColorOutput || attachment.type == RenderPassAttachment::ImageColorInputOutput)
                 {
                     m_LogicalResourceList[resource.idx].info.usages |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
                 }
@@ -325,11 +510,13 @@ namespace vkrg
                     m_LogicalResourceList[resource.idx].info.usages |= VK_IMAGE_USAGE_SAMPLED_BIT;
                 }
                 if (attachment.type == RenderPassAttachment::ImageStorageInput || attachment.type == RenderPassAttachment::ImageStorageOutput
+                    || attachment.type == RenderPassAttachment::ImageStorageInputOutput
                     || attachment.type == RenderPassAttachment::ImageRTInput || attachment.type == RenderPassAttachment::ImageRTOutput)
                 {
                     m_LogicalResourceList[resource.idx].info.usages |= VK_IMAGE_USAGE_STORAGE_BIT;
                 }
                 if (attachment.type == RenderPassAttachment::BufferStorageInput || attachment.type == RenderPassAttachment::BufferStorageOutput
+                    || attachment.type == RenderPassAttachment::BufferStorageInputOutput
                     || attachment.type == RenderPassAttachment::BufferRTInput || attachment.type == RenderPassAttachment::BufferRTOutput)
                 {
                     m_LogicalResourceList[resource.idx].info.usages |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
@@ -369,39 +556,76 @@ namespace vkrg
 
     RenderGraphCompileState RenderGraph::CollectedResourceDependencies(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::CollectedResourceDependencies");
         m_LogicalResourceIODenpendencies.resize(m_LogicalResourceList.size());
 
+        // a resource written by another pass gets a new version, like a variable in SSA form
+        // passes are bound to the latest version declared before them, all versions share one physical resource
+        // readers declared before the first writer still depend on it
+        std::vector<uint32_t> latestVersions(m_LogicalResourceList.size());
+        for (uint32_t resourceIdx = 0; resourceIdx < latestVersions.size(); resourceIdx++)
+        {
+            latestVersions[resourceIdx] = resourceIdx;
+        }
+
         for (auto renderPassHandle : m_RenderPassList)
         {
             uint32_t renderPassIdx = renderPassHandle.idx;
             auto renderPass = renderPassHandle.pass;
-            auto handles = renderPass->GetAttachedResourceHandles();
-            auto attachments = renderPass->GetAttachments();
+            auto& handles = renderPass->m_AttachmentResourceHandle;
+            auto& attachments = renderPass->GetAttachments();
+
+            // reads are bound first, a pass reading and writing a resource reads the version before its write
+            for (uint32_t i = 0; i < handles.size(); i++)
+            {
+                if (!attachments[i].ReadFromResource()) continue;
+
+                handles[i].idx = latestVersions[handles[i].idx];
+                m_LogicalResourceIODenpendencies[handles[i].idx].resourceReadList.push_back(renderPassIdx);
+            }
 
             for (uint32_t i = 0; i < handles.size(); i++)
             {
-                uint32_t resourceIdx = handles[i].idx;
-                if (attachments[i].WriteToResource())
+                if (!attachments[i].WriteToResource()) continue;
+
+                // read-write attachments are already bound to the version they read
+                uint32_t declaredResourceIdx = handles[i].idx;
+                while (m_LogicalResourceIODenpendencies[declaredResourceIdx].previousVersion != invalidIdx)
                 {
-                    // Currently we don't support write after write to a resource
-                    // Rather than write to the same resource, add a new resource and write to it is recommended
-                    // Render Graph will merge redundant resource allocation automaticaly
-                    if (!m_LogicalResourceIODenpendencies[resourceIdx].resourceWriteList.empty())
-                    {
-                        msg = " resource write after write occured during collecting dependencies for " + m_LogicalResourceList[resourceIdx].name +
-                            " pass name : " + m_RenderPassList[renderPassIdx].pass->GetName()
-                            + "\nRather than write to the same resource, add a new resource and write to it is recommended"
-                            " Render Graph will merge redundant resource allocation automaticaly";
-                        return RenderGraphCompileState::Error_WriteAfterWrite;
-                    }
+                    declaredResourceIdx = m_LogicalResourceIODenpendencies[declaredResourceIdx].previousVersion;
+                }
+                uint32_t resourceIdx = latestVersions[declaredResourceIdx];
+                auto& writeList = m_LogicalResourceIODenpendencies[resourceIdx].resourceWriteList;
 
-                    m_LogicalResourceIODenpendencies[resourceIdx].resourceWriteList.push_back(renderPassIdx);
+                // a pass writing to different subresources of a resource writes the same version
+                if (!writeList.empty() && writeList[0] == renderPassIdx)
+                {
+                    handles[i].idx = resourceIdx;
+                    continue;
                 }
 
-                if (attachments[i].ReadFromResource())
+                if (!writeList.empty())
                 {
-                    m_LogicalResourceIODenpendencies[resourceIdx].resourceReadList.push_back(renderPassIdx);
+                    LogicalResource version = m_LogicalResourceList[resourceIdx];
+                    version.version++;
+                    version.name = m_LogicalResourceList[declaredResourceIdx].name + "#" + std::to_string(version.version);
+                    version.handle.idx = m_LogicalResourceList.size();
+
+                    // only the last version is transitioned to the final layout
+                    m_LogicalResourceList[resourceIdx].finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    m_LogicalResourceList.push_back(version);
+
+                    ResourceIO versionIO;
+                    versionIO.previousVersion = resourceIdx;
+                    m_LogicalResourceIODenpendencies[resourceIdx].nextVersion = version.handle.idx;
+                    m_LogicalResourceIODenpendencies.push_back(versionIO);
+
+                    resourceIdx = version.handle.idx;
+                    latestVersions[declaredResourceIdx] = resourceIdx;
                 }
+
+                handles[i].idx = resourceIdx;
+                m_LogicalResourceIODenpendencies[resourceIdx].resourceWriteList.push_back(renderPassIdx);
             }
         }
 
@@ -410,6 +634,7 @@ namespace vkrg
 
     RenderGraphCompileState RenderGraph::BuildGraph(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::BuildGraph");
         for (auto renderPassHandle : m_RenderPassList)
         {
             DAGNode node = m_Graph.AddNode(renderPassHandle);
@@ -423,12 +648,32 @@ namespace vkrg
                 DAGNode writeDenpendencyNode = m_RenderPassNodeList[writeDenpendencyIdx];
                 for (auto readDenpendencyIdx : denpendency.resourceReadList)
                 {
+                    // passes with read-write attachments read what they write
+                    if (readDenpendencyIdx == writeDenpendencyIdx) continue;
+
                     DAGNode readDenpendencyNode = m_RenderPassNodeList[readDenpendencyIdx];
                     m_Graph.AddEdge(writeDenpendencyNode, readDenpendencyNode);
                 }
             }
         }
 
+        // versions share the physical resource, a version is written after the previous version is written and read
+        for (auto& denpendency : m_LogicalResourceIODenpendencies)
+        {
+            if (denpendency.previousVersion == invalidIdx) continue;
+
+            auto& previousDenpendency = m_LogicalResourceIODenpendencies[denpendency.previousVersion];
+            uint32_t writeDenpendencyIdx = denpendency.resourceWriteList[0];
+            DAGNode writeDenpendencyNode = m_RenderPassNodeList[writeDenpendencyIdx];
+
+            m_Graph.AddEdge(m_RenderPassNodeList[previousDenpendency.resourceWriteList[0]], writeDenpendencyNode);
+            for (auto readDenpendencyIdx : previousDenpendency.resourceReadList)
+            {
+                if (readDenpendencyIdx == writeDenpendencyIdx) continue;
+                m_Graph.AddEdge(m_RenderPassNodeList[readDenpendencyIdx], writeDenpendencyNode);
+            }
+        }
+
         for (auto extraEdge : m_ExtraPassEdges)
         {
             DAGNode outPassNode = m_RenderPassNodeList[extraEdge.outPassIdx];
@@ -441,6 +686,86 @@ namespace vkrg
         return RenderGraphCompileState::Success;
     }
 
+    RenderGraphCompileState RenderGraph::CullUnreachablePasses(std::string& msg)
+    {
+        VKRG_TRACE_SCOPE("RenderGraph::CullUnreachablePasses");
+        m_CulledRenderPasses.assign(m_RenderPassList.size(), false);
+        if (!m_Options.cullUnreachablePasses)
+        {
+            return RenderGraphCompileState::Success;
+        }
+
+        // passes writing to external resources or resources kept to next frame are alive
+        // passes writing nothing might have side effects invisible to render graph, keep them too
+        std::vector<bool>    alive(m_RenderPassList.size(), false);
+        std::vector<DAGNode> visitList;
+        for (auto renderPassHandle : m_RenderPassList)
+        {
+            auto& attachments = renderPassHandle.pass->GetAttachments();
+            auto& resources = renderPassHandle.pass->GetAttachedResourceHandles();
+
+            bool writeAnyResource = false, writeOutputResource = false;
+            for (uint32_t attachmentIdx = 0; attachmentIdx < attachments.size(); attachmentIdx++)
+            {
+                if (!attachments[attachmentIdx].WriteToResource()) continue;
+
+                auto& info = m_LogicalResourceList[resources[attachmentIdx].idx].info;
+                bool keepContent = (info.extraFlags & (uint32_t)ResourceExtraFlag::KeepContentFromLastFrame) != 0;
+
+                writeAnyResource = true;
+                writeOutputResource |= resources[attachmentIdx].external || keepContent;
+            }
+
+            if (writeOutputResource || !writeAnyResource)
+            {
+                alive[renderPassHandle.idx] = true;
+                visitList.push_back(m_RenderPassNodeList[renderPassHandle.idx]);
+            }
+        }
+
+        // every pass the alive passes depending on is alive
+        while (!visitList.empty())
+        {
+            DAGNode node = visitList.back();
+            visitList.pop_back();
+
+            for (DAGAdjNode inputNode = m_Graph.IterateAdjucentIn(node); !inputNode.IsEnd(); inputNode++)
+            {
+                uint32_t inputPassIdx = inputNode.CaseToNode()->idx;
+                if (!alive[inputPassIdx])
+                {
+                    alive[inputPassIdx] = true;
+                    visitList.push_back(inputNode.CaseToNode());
+                }
+            }
+        }
+
+        bool anyCulled = false;
+        for (uint32_t passIdx = 0; passIdx < m_RenderPassList.size(); passIdx++)
+        {
+            m_CulledRenderPasses[passIdx] = !alive[passIdx];
+            anyCulled |= !alive[passIdx];
+        }
+
+        if (!anyCulled)
+        {
+            return RenderGraphCompileState::Success;
+        }
+
+        // remove culled passes from dependencies, resources only accessed by culled passes won't be allocated
+        auto isCulled = [&](uint32_t passIdx) { return m_CulledRenderPasses[passIdx]; };
+        for (uint32_t resourceIdx = 0; resourceIdx < m_LogicalResourceIODenpendencies.size(); resourceIdx++)
+        {
+            auto& dependency = m_LogicalResourceIODenpendencies[resourceIdx];
+            dependency.resourceWriteList.erase(std::remove_if(dependency.resourceWriteList.begin(), dependency.resourceWriteList.end(), isCulled),
+                dependency.resourceWriteList.end());
+            dependency.resourceReadList.erase(std::remove_if(dependency.resourceReadList.begin(), dependency.resourceReadList.end(), isCulled),
+                dependency.resourceReadList.end());
+        }
+
+        return RenderGraphCompileState::Success;
+    }
+
     template<typename T>
     void PushBackNotRepeatedElement(std::vector<T>& vec, const T& elem)
     {
@@ -452,14 +777,22 @@ namespace vkrg
 
     RenderGraphCompileState RenderGraph::ScheduleMergedGraph(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ScheduleMergedGraph");
         if (!m_Graph.Sort())
         {
             msg = "graph contains cycle!";
             return RenderGraphCompileState::Error_CycleInGraph;
         }
 
+        // dispatch groups of every dependency level
+        std::vector<uint32_t> passLevels(m_RenderPassList.size(), 0);
+        std::vector<std::vector<DAGMergedNode>> dispatchGroups(m_RenderPassList.size());
+
         for (DAGNode currentNode = m_Graph.Begin(); currentNode != m_Graph.End(); currentNode++)
         {
+            // culled passes won't be scheduled
+            if (m_CulledRenderPasses[currentNode->idx]) continue;
+
             DAGMergedNode currentMergedNode;
 
             // found all merged depending render pass nodes
@@ -476,6 +809,8 @@ namespace vkrg
 
                 PushBackNotRepeatedElement(dependingMergedNodes, node);
                 PushBackNotRepeatedElement(inputNodes, currentInputNode.CaseToNode());
+
+                passLevels[currentNode->idx] = vkrg_max(passLevels[currentNode->idx], passLevels[currentInputNode.CaseToNode()->idx] + 1);
             }
 
             auto checkPassClearValueRequirement =
@@ -491,16 +826,64 @@ namespace vkrg
                 return false;
             };
 
-            // if this node is compute node, it can't be merged to any other nodes
-            // create a single merged node for it
-            if (currentNode->pass->GetType() != RenderPassType::Graphics)
+            // compute and ray tracing passes of the same dependency level are batched to a dispatch group if they are independent
+            // and no resource written by one of them is touched by another, barriers of the whole group are recorded once before it
+            if (currentNode->pass->IsGeneralPass())
+            {
+                auto& attachedResources = currentNode->pass->GetAttachedResourceHandles();
+                auto& attachments = currentNode->pass->GetAttachments();
+                auto shareResources = [&](DAGMergedNode group)
+                {
+                    for (auto& member : group->renderPasses)
+                    {
+                        auto& memberResources = member->pass->GetAttachedResourceHandles();
+                        for (auto& memberAttachment : member->pass->GetAttachments())
+                        {
+                            for (auto& attachment : attachments)
+                            {
+                                // passes only reading a resource need no barrier between them, unless they read an image in different layouts
+                                if (!memberAttachment.WriteToResource() && !attachment.WriteToResource() &&
+                                    (!attachment.IsImage() || member->pass->GetAttachmentExpectedState(memberAttachment) == currentNode->pass->GetAttachmentExpectedState(attachment))) continue;
+                                if (GetRootResourceVersion(memberResources[memberAttachment.idx].idx) == GetRootResourceVersion(attachedResources[attachment.idx].idx)) return true;
+                            }
+                        }
+                    }
+                    return false;
+                };
+
+                auto& levelGroups = dispatchGroups[passLevels[currentNode->idx]];
+                for (auto group : levelGroups)
+                {
+                    // the group is scheduled after every pass this pass depends on
+                    bool independent = true;
+                    for (auto dependingMergedNode : dependingMergedNodes)
+                    {
+                        independent = independent && dependingMergedNode != group && !m_MergedRenderPassGraph.CanReach(group, dependingMergedNode);
+                    }
+
+                    if (independent && !shareResources(group))
+                    {
+                        currentMergedNode = group;
+                        currentMergedNode->renderPasses.push_back(currentNode);
+                        break;
+                    }
+                }
+
+                if (currentMergedNode.Invalid())
+                {
+                    currentMergedNode = CreateNewMergedNode(currentNode, false);
+                    levelGroups.push_back(currentMergedNode);
+                }
+            }
+            // conditional passes could be skipped at runtime, they should own their render pass
+            else if (currentNode->pass->IsConditional())
             {
                 currentMergedNode = CreateNewMergedNode(currentNode, false);
                 currentMergedNode->expectedExtension = currentNode->pass->GetRenderPassExtension();
             }
             else
             {
-                uint32_t currentMergedNodeScore = 0;
+                int64_t currentMergedNodeScore = 0;
 
                 // scan every dependencies, find the best merged render pass node to merge
                 for (uint32_t i = 0; i < dependingMergedNodes.size(); i++)
@@ -513,7 +896,7 @@ namespace vkrg
                     if (!mergedRenderPass.canBeMerged) continue;
 
                     // if this node doesn't match the expected extension skip this node
-                    if (!(mergedRenderPass.expectedExtension == currentInputNode->pass->GetRenderPassExtension())) continue;
+                    if (!(mergedRenderPass.expectedExtension == currentNode->pass->GetRenderPassExtension())) continue;
 
                     // if adding this node to incoming merged node will create cycle in merged pass dependency graph
                     // skip this node
@@ -542,8 +925,8 @@ namespace vkrg
                     if (skipToAviodCycle) continue;
 
 
-                    // find the node with highest score
-                    uint32_t newMergedNodeScore = ScoreMergedNode(incomingMergedNode);
+                    // find the node with highest score, merging without saving any bandwidth is not worthy
+                    int64_t newMergedNodeScore = ScoreMergedNode(incomingMergedNode, currentNode);
                     if (newMergedNodeScore > currentMergedNodeScore)
                     {
                         currentMergedNodeScore = newMergedNodeScore;
@@ -577,13 +960,14 @@ namespace vkrg
         }
 
         // some thing goes wrong in our algorithm, otherwise sorting must be valid.
-        vkrg_assert(m_MergedRenderPassGraph.Sort());
+        vkrg_assert(SortMergedRenderPassGraph());
 
         return RenderGraphCompileState::Success;
     }
 
     RenderGraphCompileState RenderGraph::ScheduleOneByOneGraph(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ScheduleOneByOneGraph");
         if (!m_Graph.Sort())
         {
             msg = "graph contains cycle!";
@@ -592,6 +976,9 @@ namespace vkrg
 
         for (DAGNode currentNode = m_Graph.Begin(); currentNode != m_Graph.End(); currentNode++)
         {
+            // culled passes won't be scheduled
+            if (m_CulledRenderPasses[currentNode->idx]) continue;
+
             DAGMergedNode currentMergedNode = CreateNewMergedNode(currentNode, false);
 
             DAGAdjNode currentInputNode = m_Graph.IterateAdjucentIn(currentNode);
@@ -607,13 +994,54 @@ namespace vkrg
         }
 
         // some thing goes wrong in our algorithm, otherwise sorting must be valid.
-        vkrg_assert(m_MergedRenderPassGraph.Sort());
+        vkrg_assert(SortMergedRenderPassGraph());
 
         return RenderGraphCompileState::Success;
     }
 
+    bool RenderGraph::SortMergedRenderPassGraph()
+    {
+        if (m_Options.schedulePolicy == RenderGraphSchedulePolicy::OverlapAware)
+        {
+            return m_MergedRenderPassGraph.SortOverlapAware(m_Options.maxLifetimeExtension);
+        }
+        return m_MergedRenderPassGraph.Sort();
+    }
+
+    void RenderGraph::CollectScheduleStatistics()
+    {
+        RenderGraphScheduleStatistics stats;
+        stats.minBarrierDistance = invalidIdx;
+
+        uint32_t totalDistance = 0;
+        for (DAGMergedNode node = m_MergedRenderPassGraph.Begin(); node != m_MergedRenderPassGraph.End(); node++)
+        {
+            for (DAGMergedAdjNode outNode = m_MergedRenderPassGraph.IterateAdjucentOut(node); !outNode.IsEnd(); outNode++)
+            {
+                uint32_t distance = outNode.CaseToNode() - node;
+                stats.edgeCount++;
+                stats.adjacentEdgeCount += distance == 1;
+                stats.minBarrierDistance = vkrg_min(stats.minBarrierDistance, distance);
+                stats.maxBarrierDistance = vkrg_max(stats.maxBarrierDistance, distance);
+                totalDistance += distance;
+            }
+        }
+
+        if (stats.edgeCount == 0)
+        {
+            stats.minBarrierDistance = 0;
+        }
+        else
+        {
+            stats.averageBarrierDistance = (float)totalDistance / (float)stats.edgeCount;
+        }
+
+        m_ScheduleStatistics = stats;
+    }
+
     RenderGraphCompileState RenderGraph::AssignPhysicalResources(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::AssignPhysicalResources");
         m_LogicalResourceAssignmentTable.resize(m_LogicalResourceList.size());
         std::unordered_set<uint32_t> visitedRenderPasses;
 
@@ -641,13 +1069,41 @@ namespace vkrg
         // 3. neither this resource nor currently required resource is an external resource
         // 4. currently required resource doesn't need clear
 
+        // versions of a resource are assigned together with the first version, so the physical resource
+        // can't be reused by other resources before the last version is read
+        auto assignResourceVersions = [&](uint32_t logicalResourceIdx, ResourceAssignment assignment)
+        {
+            for (uint32_t versionIdx = logicalResourceIdx; versionIdx != invalidIdx; versionIdx = m_LogicalResourceIODenpendencies[versionIdx].nextVersion)
+            {
+                // writers of later versions are culled
+                if (m_LogicalResourceIODenpendencies[versionIdx].resourceWriteList.empty()) break;
+
+                if (!assignment.external)
+                {
+                    auto& physicalResource = m_PhysicalResources[assignment.idx];
+                    physicalResource.info.usages |= m_LogicalResourceList[versionIdx].info.usages;
+                    physicalResource.logicalResources.push_back(versionIdx);
+                    // the final layout is moved to the last version
+                    if (m_LogicalResourceList[versionIdx].finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+                    {
+                        physicalResource.finalLayout = m_LogicalResourceList[versionIdx].finalLayout;
+                    }
+                }
+                m_LogicalResourceAssignmentTable[versionIdx] = assignment;
+            }
+        };
+
         // tranverse the merged render graph follow the topological order
         for (auto mergedRenderPassIter = m_MergedRenderPassGraph.Begin(); mergedRenderPassIter != m_MergedRenderPassGraph.End(); mergedRenderPassIter++)
         {
+            // passes of a dispatch group run without barriers between them, they are visited after the whole group
+            // so that resources read by the group can't be reused by outputs of the group
+            bool dispatchGroup = mergedRenderPassIter->renderPasses[0]->pass->IsGeneralPass();
+
             // visit every render pass in this merged pass
             for (auto renderPass : mergedRenderPassIter->renderPasses)
             {
-                visitedRenderPasses.insert(renderPass->idx);
+                if (!dispatchGroup) visitedRenderPasses.insert(renderPass->idx);
 
                 auto& attachments = renderPass->pass->GetAttachments();
                 auto& resources = renderPass->pass->GetAttachedResourceHandles();
@@ -665,7 +1121,13 @@ namespace vkrg
 
                     // skip input attachments
                     // we only allocate resources when render pass need to output
-                    if (attachment.ReadFromResource()) continue;
+                    if (attachment.ReadFromResource() && !attachment.WriteToResource()) continue;
+
+                    // the first version is always written before other versions
+                    while (m_LogicalResourceIODenpendencies[resource.idx].previousVersion != invalidIdx)
+                    {
+                        resource.idx = m_LogicalResourceIODenpendencies[resource.idx].previousVersion;
+                    }
 
                     // for image resources
                     if (m_LogicalResourceList[resource.idx].info.IsImage())
@@ -707,13 +1169,15 @@ namespace vkrg
                                     }
 
                                     // the resource can't be reused if the resource is written in the same pass
-                                    canBeAssigned = m_LogicalResourceIODenpendencies[assignedLogicalResourceIdx].resourceWriteList[0] != renderPass->idx;
+                                    canBeAssigned &= m_LogicalResourceIODenpendencies[assignedLogicalResourceIdx].resourceWriteList[0] != renderPass->idx;
+
+                                    // later versions are assigned before they are written
+                                    canBeAssigned &= visitedRenderPasses.count(m_LogicalResourceIODenpendencies[assignedLogicalResourceIdx].resourceWriteList[0]) != 0;
 
                                     // the resource can't be reused if the resource's final layout is decided
                                     canBeAssigned &= m_LogicalResourceList[assignedLogicalResourceIdx].finalLayout == VK_IMAGE_LAYOUT_UNDEFINED;
 
                                     if (!canBeAssigned) break;
-                                    // we don't have to check resource's write list, because the logical resource could only be assigned when its writer has been visited
                                 }
 
                                 // find the physical resource with highest score
@@ -742,16 +1206,12 @@ namespace vkrg
                             m_PhysicalResources.push_back(phyResource);
                         }
 
-                        // merge newly assigned node's usage to physical node's usage
-                        m_PhysicalResources[physicalResourceIdx].info.usages |= m_LogicalResourceList[resource.idx].info.usages;
-                        // add logical node's index to physical node
-                        m_PhysicalResources[physicalResourceIdx].logicalResources.push_back(resource.idx);
-
                         ResourceAssignment assignment;
                         assignment.external = resource.external;
                         assignment.idx = physicalResourceIdx;
 
-                        m_LogicalResourceAssignmentTable[resource.idx] = assignment;
+                        // merge newly assigned nodes' usage to physical node's usage and add their indices to physical node
+                        assignResourceVersions(resource.idx, assignment);
                     }
                     // for every buffer resources, we just allocate a new buffer and never reuse it
                     // TODO: better allocation strategy
@@ -759,7 +1219,6 @@ namespace vkrg
                     {
                         PhysicalResource bufResource;
                         bufResource.info = m_LogicalResourceList[resource.idx].info;
-                        bufResource.logicalResources.push_back(resource.idx);
                         uint32_t bufferResourceIdx = m_PhysicalResources.size();
 
                         ResourceAssignment assignment;
@@ -767,7 +1226,7 @@ namespace vkrg
                         assignment.external = resource.external;
 
                         m_PhysicalResources.push_back(bufResource);
-                        m_LogicalResourceAssignmentTable[resource.idx] = assignment;
+                        assignResourceVersions(resource.idx, assignment);
                     }
                     else
                     {
@@ -779,25 +1238,38 @@ namespace vkrg
 
 
             }
+
+            if (dispatchGroup)
+            {
+                for (auto renderPass : mergedRenderPassIter->renderPasses)
+                {
+                    visitedRenderPasses.insert(renderPass->idx);
+                }
+            }
         }
 
         // tranverse every external resources
+        // versions of external resources are bound to the external resource of the first version
         for (auto& logicalResource : m_LogicalResourceList)
         {
-            if (logicalResource.handle.external)
+            if (logicalResource.handle.external && logicalResource.version == 0)
             {
                 ExternalResource resource;
                 resource.handle = logicalResource.handle;
                 resource.name = logicalResource.name;
                 resource.finalLayout = logicalResource.finalLayout;
 
-                m_ExternalResources.push_back(resource);
-
                 ResourceAssignment assignment;
                 assignment.external = logicalResource.handle.external;
-                assignment.idx = m_ExternalResources.size() - 1;
+                assignment.idx = m_ExternalResources.size();
+
+                for (uint32_t versionIdx = logicalResource.handle.idx; versionIdx != invalidIdx; versionIdx = m_LogicalResourceIODenpendencies[versionIdx].nextVersion)
+                {
+                    resource.finalLayout = m_LogicalResourceList[versionIdx].finalLayout;
+                    m_LogicalResourceAssignmentTable[versionIdx] = assignment;
+                }
 
-                m_LogicalResourceAssignmentTable[logicalResource.handle.idx] = assignment;
+                m_ExternalResources.push_back(resource);
             }
         }
 
@@ -805,173 +1277,51 @@ namespace vkrg
     }
 
 
-    // a helper structure record states during transitions
-    struct ImageLayoutStatus
+    // a helper structure dealing with frame buffer attachments of the merged pass being compiled
+    // one table is shared by every resource and every merged pass, entries are keyed by the resource and the subresource range
+    // and clearing the table only visits entries added by the last merged pass
+    struct ImageFBAttachmentStatus
     {
-        ImageLayoutStatus(ResourceInfo info) : info(info)
+    public:
+        static constexpr uint32_t invalidIdx = 0xffffffff;
+
+        ImageFBAttachmentStatus(uint32_t physicalResourceCount, uint32_t externalResourceCount)
         {
-            subresourceLayouts.resize(info.channelCount * info.mipCount * GetAspectCount(info.format), VK_IMAGE_LAYOUT_UNDEFINED);
+            externalResourceOffset = physicalResourceCount;
+            sliceCounts.resize(physicalResourceCount + externalResourceCount, 0);
         }
 
-        ImageLayoutStatus(ResourceInfo info, VkImageLayout initLayout) : info(info)
+        uint32_t Query(bool external, uint32_t resourceIdx, ImageSlice subresource)
         {
-            subresourceLayouts.resize(info.channelCount * info.mipCount * GetAspectCount(info.format), initLayout);
+            auto iter = entries.find(Key{ ResourceKey(external, resourceIdx), subresource });
+            if (iter != entries.end())
+            {
+                return iter->second;
+            }
+            return invalidIdx;
         }
 
 
-        VkImageLayout Query(ImageSlice subresource)
+        void     Update(bool external, uint32_t resourceIdx, ImageSlice subresource, uint32_t idx)
         {
-            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
-            bool flag = false;
-
-            // VkImage of format VK_FORMAT_D24_UNORM_S8_UINT that must have the depth and stencil aspects set, 
-            // but its aspectMask is 0x2. The Vulkan spec states: If image has a depth/stencil format with both 
-            // depth and stencil and the separateDepthStencilLayouts feature is not enabled, then the aspectMask 
-            // member of subresourceRange must include both VK_IMAGE_ASPECT_DEPTH_BIT and VK_IMAGE_ASPECT_STENCIL_BIT
-            if (subresource.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT || subresource.aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT)
+            uint32_t resourceKey = ResourceKey(external, resourceIdx);
+            Key key{ resourceKey, subresource };
+            if (entries.emplace(key, idx).second)
             {
-                subresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+                sliceCounts[resourceKey]++;
+                insertedKeys.push_back(key);
             }
-
-            auto op = [&](uint32_t idx)
-            {
-                VkImageLayout subresourceLayout = subresourceLayouts[idx];
-                if (!flag)
-                {
-                    layout = subresourceLayout;
-                    flag = true;
-                }
-                else
-                {
-                    if (layout != subresourceLayout) layout = VK_IMAGE_LAYOUT_UNDEFINED;
-                }
-            };
-            SubresourceRange(subresource, op);
-
-            return layout;
         }
 
-
-        void          Update(ImageSlice subresource, VkImageLayout layout)
+        // only entries of the last merged pass are erased, the buckets are kept for the next one
+        void     Clear()
         {
-            auto op = [&](uint32_t idx)
+            for (auto& key : insertedKeys)
             {
-                subresourceLayouts[idx] = layout;
-            };
-
-            // VkImage of format VK_FORMAT_D24_UNORM_S8_UINT that must have the depth and stencil aspects set, 
-            // but its aspectMask is 0x2. The Vulkan spec states: If image has a depth/stencil format with both 
-            // depth and stencil and the separateDepthStencilLayouts feature is not enabled, then the aspectMask 
-            // member of subresourceRange must include both VK_IMAGE_ASPECT_DEPTH_BIT and VK_IMAGE_ASPECT_STENCIL_BIT
-            if (subresource.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT || subresource.aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT)
-            {
-                subresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-            }
-
-            SubresourceRange(subresource, op);
-        }
-
-        static ImageSlice Merge(ImageSlice lhs, ImageSlice rhs)
-        {
-            ImageSlice slice;
-            slice.aspectMask = lhs.aspectMask | rhs.aspectMask;
-            slice.baseArrayLayer = vkrg_min(lhs.baseArrayLayer, rhs.baseArrayLayer);
-            slice.baseMipLevel = vkrg_min(lhs.baseMipLevel, rhs.baseMipLevel);
-
-            uint32_t maxMipLevel = vkrg_max(lhs.baseMipLevel + lhs.levelCount, rhs.baseMipLevel + rhs.levelCount);
-            uint32_t maxArrayLayer = vkrg_max(lhs.baseArrayLayer + lhs.layerCount, rhs.baseArrayLayer + rhs.layerCount);
-
-            slice.layerCount = maxArrayLayer - slice.baseArrayLayer;
-            slice.baseMipLevel = maxMipLevel - slice.baseMipLevel;
-
-            return slice;
-        }
-
-    private:
-        void SubresourceRange(ImageSlice slice, std::function<void(uint32_t)> op)
-        {
-            auto aspectRange = [&](VkImageAspectFlagBits flag)
-            {
-                if (slice.aspectMask & flag)
-                {
-                    uint32_t offset0 = GetAspectIndex(flag) * info.channelCount * info.mipCount;
-                    for (uint32_t arrIdx = 0; arrIdx < slice.layerCount; arrIdx++)
-                    {
-                        for (uint32_t mipIdx = 0; mipIdx < slice.levelCount; mipIdx++)
-                        {
-                            uint32_t idx = mipIdx + arrIdx * info.mipCount + offset0;
-                            op(idx);
-                        }
-                    }
-                }
-            };
-            aspectRange(VK_IMAGE_ASPECT_COLOR_BIT);
-            aspectRange(VK_IMAGE_ASPECT_DEPTH_BIT);
-            aspectRange(VK_IMAGE_ASPECT_STENCIL_BIT);
-        }
-        uint32_t GetAspectCount(VkFormat format)
-        {
-            VkImageAspectFlags flags = gvk::GetAllAspects(info.format);
-            if (flags == VK_IMAGE_ASPECT_COLOR_BIT)
-            {
-                return 1;
-            }
-            if (flags == (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_DEPTH_BIT))
-            {
-                return 2;
-            }
-        }
-
-        uint32_t GetAspectIndex(VkImageAspectFlagBits flag)
-        {
-            if (flag == VK_IMAGE_ASPECT_COLOR_BIT)
-            {
-                return 0;
-            }
-            if (flag == VK_IMAGE_ASPECT_DEPTH_BIT)
-            {
-                return 0;
-            }
-            if (flag == VK_IMAGE_ASPECT_STENCIL_BIT)
-            {
-                return 1;
-            }
-            return 0;
-        }
-        ResourceInfo info;
-        std::vector<VkImageLayout> subresourceLayouts;
-    };
-
-    // a helper structure dealing with frame buffer attachment
-    struct ImageFBAttachmentStatus
-    {
-    public:
-        static constexpr uint32_t invalidIdx = 0xffffffff;
-
-        ImageFBAttachmentStatus(ResourceInfo info) : info(info)
-        {
-            if (info.IsBuffer())  return;
-        }
-
-        uint32_t Query(ImageSlice subresource)
-        {
-            uint32_t internalIdx = QueryInternal(subresource);
-            if (internalIdx != invalidIdx)
-            {
-                return targetFBAttachmentIdx[internalIdx];
-            }
-            return invalidIdx;
-        }
-
-
-        void     Update(ImageSlice subresource, uint32_t idx)
-        {
-            uint32_t internalIdx = QueryInternal(subresource);
-            if (internalIdx == invalidIdx)
-            {
-                slices.push_back(subresource);
-                targetFBAttachmentIdx.push_back(idx);
+                sliceCounts[key.resource] = 0;
+                entries.erase(key);
             }
+            insertedKeys.clear();
         }
 
         //http://geekfaner.com/shineengine/blog18_Vulkanv1.2_4.html
@@ -980,35 +1330,48 @@ namespace vkrg
         //  attachmentڴframebufferʱ򣬶Ӧͬһimage view
         //  attachmentӦͬһimageͬһimage subresourceĲͬimage view
         //  attachmentӦviews of distinct image subresources bound to ǵڴ淶Χ
-        bool MayAlias()
+        bool MayAlias(bool external, uint32_t resourceIdx)
         {
-            return slices.size() > 1;
+            return sliceCounts[ResourceKey(external, resourceIdx)] > 1;
         }
 
 
     private:
-
-        uint32_t QueryInternal(ImageSlice subresource)
+        struct Key
         {
-            for (uint32_t i = 0; i < slices.size(); i++)
+            uint32_t   resource;
+            ImageSlice slice;
+
+            bool operator==(const Key& other) const
             {
-                if (slices[i].aspectMask == subresource.aspectMask &&
-                    slices[i].baseArrayLayer == subresource.baseArrayLayer &&
-                    slices[i].baseMipLevel == subresource.baseMipLevel &&
-                    slices[i].layerCount == subresource.layerCount &&
-                    slices[i].levelCount == subresource.levelCount)
-                {
-                    return i;
-                }
+                return resource == other.resource && slice.aspectMask == other.slice.aspectMask &&
+                    slice.baseArrayLayer == other.slice.baseArrayLayer && slice.baseMipLevel == other.slice.baseMipLevel &&
+                    slice.layerCount == other.slice.layerCount && slice.levelCount == other.slice.levelCount;
             }
-            return invalidIdx;
-        }
+        };
 
+        struct KeyHash
+        {
+            // fields are masked to disjoint bit ranges of 64 bits, values beyond the widths only collide
+            size_t operator()(const Key& key) const
+            {
+                uint64_t packed = (uint64_t)(key.resource & 0xffffff) << 40 | (uint64_t)(key.slice.aspectMask & 0xf) << 36
+                    | (uint64_t)(key.slice.baseMipLevel & 0x3f) << 30 | (uint64_t)(key.slice.levelCount & 0x3f) << 24
+                    | (uint64_t)(key.slice.baseArrayLayer & 0xfff) << 12 | (uint64_t)(key.slice.layerCount & 0xfff);
+                return std::hash<uint64_t>()(packed);
+            }
+        };
 
-        std::vector<ImageSlice> slices;
-        std::vector<uint32_t>   targetFBAttachmentIdx;
+        uint32_t ResourceKey(bool external, uint32_t resourceIdx)
+        {
+            return external ? externalResourceOffset + resourceIdx : resourceIdx;
+        }
 
-        ResourceInfo info;
+        std::unordered_map<Key, uint32_t, KeyHash> entries;
+        // how many subresource ranges of every resource are attached
+        std::vector<uint32_t> sliceCounts;
+        std::vector<Key>      insertedKeys;
+        uint32_t              externalResourceOffset;
     };
 
 
@@ -1065,10 +1428,13 @@ namespace vkrg
 
     RenderGraphCompileState RenderGraph::ResolveDependenciesAndCreateRenderPasses(std::string& msg)
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ResolveDependenciesAndCreateRenderPasses");
+        m_RenderPassCache.Initialize(m_vulkanContext.ctx);
         std::vector<ImageLayoutStatus> physicalResourceLayouts;
         std::vector<ImageLayoutStatus> externalResourceLayouts;
 
         ImageBarrierHelper globalBarrierHelper(m_Options.flightFrameCount);
+        ImageFBAttachmentStatus fbAttachmentStatus(m_PhysicalResources.size(), m_ExternalResources.size());
 
         // initialize image layout lists
         for (auto physicalResource : m_PhysicalResources)
@@ -1109,180 +1475,157 @@ namespace vkrg
 
             if (currentMergedPass->renderPasses[0]->pass->IsGeneralPass())
             {
-                vkrg_assert(currentMergedPass->renderPasses.size() == 1);
-
-                auto currentPass = currentMergedPass->renderPasses[0];
-
-                info.type = currentMergedPass->renderPasses[0]->pass->GetType();
-
-                auto& attachments = currentPass->pass->GetAttachments();
-                auto& resources = currentPass->pass->GetAttachedResourceHandles();
-
-                for (uint32_t i = 0; i < attachments.size(); i++)
+                // passes of a dispatch group are independent, barriers of the whole group are collected to one barrier helper
+                for (auto currentPass : currentMergedPass->renderPasses)
                 {
-                    auto& attachment = attachments[i];
-                    auto& resource = resources[i];
+                    RenderPassType passType = currentPass->pass->GetType();
 
-                    /*
-                    if (attachment.WriteToResource() && FindLastAccessedNodeForResource(resource.idx) != currentMergedPass
-                        && FindFirstAccessedNodeForResource(resource.idx) != currentMergedPass)
-                    {
-                        continue;
-                    }
-                    */
+                    auto& attachments = currentPass->pass->GetAttachments();
+                    auto& resources = currentPass->pass->GetAttachedResourceHandles();
 
-                    if (attachment.IsImage())
+                    for (uint32_t i = 0; i < attachments.size(); i++)
                     {
-                        VkImageMemoryBarrier barrier{};
-                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                        barrier.subresourceRange = attachment.range.imageRange;
+                        auto& attachment = attachments[i];
+                        auto& resource = resources[i];
 
-                        // VkImage of format VK_FORMAT_D24_UNORM_S8_UINT that must have the depth and stencil aspects set, 
-                        // but its aspectMask is 0x2. The Vulkan spec states: If image has a depth/stencil format with both 
-                        // depth and stencil and the separateDepthStencilLayouts feature is not enabled, then the aspectMask 
-                        // member of subresourceRange must include both VK_IMAGE_ASPECT_DEPTH_BIT and VK_IMAGE_ASPECT_STENCIL_BIT
-                        if (attachment.range.imageRange.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT || attachment.range.imageRange.aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT)
+                        /*
+                        if (attachment.WriteToResource() && FindLastAccessedNodeForResource(resource.idx) != currentMergedPass
+                            && FindFirstAccessedNodeForResource(resource.idx) != currentMergedPass)
                         {
-                            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+                            continue;
                         }
-                        auto assign = m_LogicalResourceAssignmentTable[resource.idx];
-                        VkImageLayout newStateLayout = currentPass->pass->GetAttachmentExpectedState(attachment);
+                        */
 
-                        if (assign.external)
-                        {
-                            // queue family index/ image field will be filled at runtime  
-                            barrier.oldLayout = externalResourceLayouts[assign.idx].Query(attachment.range.imageRange);
-                            barrier.newLayout = newStateLayout;
-                            externalResourceLayouts[assign.idx].Update(attachment.range.imageRange, barrier.newLayout);
-                        }
-                        // assignment to physical resource
-                        else
+                        if (attachment.IsImage())
                         {
-                            barrier.oldLayout = physicalResourceLayouts[assign.idx].Query(attachment.range.imageRange);
+                            VkImageMemoryBarrier barrier{};
+                            auto assign = m_LogicalResourceAssignmentTable[resource.idx];
                             barrier.newLayout = currentPass->pass->GetAttachmentExpectedState(attachment);
-                            physicalResourceLayouts[assign.idx].Update(attachment.range.imageRange, barrier.newLayout);
-                        }
-                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-                        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-                        barrier.pNext = NULL;
 
-                        auto& dependency = m_LogicalResourceIODenpendencies[resource.idx];
-                        auto& writer = m_RenderPassList[dependency.resourceWriteList[0]];
+                            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+                            // read-write attachments also write after the previous writer
+                            if (attachment.IsReadWrite()) barrier.dstAccessMask |= VK_ACCESS_MEMORY_WRITE_BIT;
+                            barrier.pNext = NULL;
+
+                            auto& dependency = m_LogicalResourceIODenpendencies[resource.idx];
+                            uint32_t writerIdx = dependency.resourceWriteList[0];
+                            // read-write attachments wait for the writer of the version they read
+                            if (writerIdx == currentPass->idx && dependency.previousVersion != invalidIdx)
+                            {
+                                writerIdx = m_LogicalResourceIODenpendencies[dependency.previousVersion].resourceWriteList[0];
+                            }
+                            auto& writer = m_RenderPassList[writerIdx];
 
-                        VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-                        VkPipelineStageFlagBits dstStage = info.type == RenderPassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+                            VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                            VkPipelineStageFlagBits dstStage = passType == RenderPassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
 
 
 
-                        if (writer.pass->GetType() == RenderPassType::Compute)
-                        {
-                            srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-                        }
-                        else if (writer.pass->GetType() == RenderPassType::Raytracing)
-                        {
-                            srcStage = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
-                        }
-                        else
-                        {
-                            if (gvk::GetAllAspects(m_LogicalResourceList[resource.idx].info.format) & VK_IMAGE_ASPECT_DEPTH_BIT)
+                            if (writer.pass->GetType() == RenderPassType::Compute)
+                            {
+                                srcStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                            }
+                            else if (writer.pass->GetType() == RenderPassType::Raytracing)
                             {
-                                srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                                srcStage = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
                             }
                             else
                             {
-                                srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                                if (gvk::GetAllAspects(m_LogicalResourceList[resource.idx].info.format) & VK_IMAGE_ASPECT_DEPTH_BIT)
+                                {
+                                    srcStage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                                }
+                                else
+                                {
+                                    srcStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                                }
                             }
-                        }
-
-                        RenderGraphBarrier::Handle handle;
-                        handle.idx = assign.idx;
-                        handle.external = assign.external;
-
-                        barrierHelper.AddImage(srcStage, dstStage, barrier, handle);
-                    }
-                    else if (attachment.IsBuffer())
-                    {
-                        VkBufferMemoryBarrier barrier{};
-                        barrier.offset = attachment.range.bufferRange.offset;
-                        barrier.size = attachment.range.bufferRange.size;
-                        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-                        barrier.pNext = NULL;
-                        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
-                        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-
-                        ResourceAssignment assign;
-                        assign = m_LogicalResourceAssignmentTable[resource.idx];
-
-                        RenderGraphBarrier::Handle handle;
-                        handle.idx = assign.idx;
-                        handle.external = assign.external;
-
-                        // TODO better source stage flag
-                        // render pass will not write to buffer so we can assume the render pass ahead is compute render pass
-                        VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-                        VkPipelineStageFlagBits dstStage = info.type == RenderPassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
-                        barrierHelper.AddBuffer(srcStage, dstStage, barrier, handle);
-                    }
-                    else
-                    {
-                        // this branch should not be reached
-                        vkrg_assert(false);
-                    }
-
-                    if (FindLastAccessedNodeForResource(resource.idx) == currentMergedPass && m_LogicalResourceList[resource.idx].finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
-                    {
-                        VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-                        VkPipelineStageFlagBits dstStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
-                        VkImageMemoryBarrier barrier{};
-                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                        barrier.subresourceRange = attachment.range.imageRange;
+                            RenderGraphBarrier::Handle handle;
+                            handle.idx = assign.idx;
+                            handle.external = assign.external;
 
-                        auto assign = m_LogicalResourceAssignmentTable[resource.idx];
-                        if (assign.external)
+                            // subresources left in different layouts by earlier passes are transitioned range by range
+                            // queue family index/ image field of external resources will be filled at runtime
+                            ImageLayoutStatus& layouts = assign.external ? externalResourceLayouts[assign.idx] : physicalResourceLayouts[assign.idx];
+                            layouts.QueryRanges(attachment.range.imageRange,
+                                [&](ImageSlice range, VkImageLayout oldLayout)
+                                {
+                                    barrier.subresourceRange = range;
+                                    barrier.oldLayout = oldLayout;
+                                    barrierHelper.AddImage(srcStage, dstStage, barrier, handle);
+                                });
+                            layouts.Update(attachment.range.imageRange, barrier.newLayout);
+                        }
+                        else if (attachment.IsBuffer())
                         {
-                            // queue family index/ image field will be filled at runtime  
-                            barrier.oldLayout = externalResourceLayouts[assign.idx].Query(attachment.range.imageRange);
-                            barrier.newLayout = m_LogicalResourceList[resource.idx].finalLayout;
-                            externalResourceLayouts[assign.idx].Update(attachment.range.imageRange, barrier.newLayout);
+                            VkBufferMemoryBarrier barrier{};
+                            barrier.offset = attachment.range.bufferRange.offset;
+                            barrier.size = attachment.range.bufferRange.size;
+                            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                            barrier.pNext = NULL;
+                            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+                            // read-write attachments also write after the previous writer
+                            if (attachment.IsReadWrite()) barrier.dstAccessMask |= VK_ACCESS_MEMORY_WRITE_BIT;
+
+                            ResourceAssignment assign;
+                            assign = m_LogicalResourceAssignmentTable[resource.idx];
+
+                            RenderGraphBarrier::Handle handle;
+                            handle.idx = assign.idx;
+                            handle.external = assign.external;
+
+                            // TODO better source stage flag
+                            // render pass will not write to buffer so we can assume the render pass ahead is compute render pass
+                            VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                            VkPipelineStageFlagBits dstStage = passType == RenderPassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+                            barrierHelper.AddBuffer(srcStage, dstStage, barrier, handle);
                         }
-                        // assignment to physical resource
                         else
                         {
-                            barrier.oldLayout = physicalResourceLayouts[assign.idx].Query(attachment.range.imageRange);
-                            barrier.newLayout = m_LogicalResourceList[resource.idx].finalLayout;
-                            physicalResourceLayouts[assign.idx].Update(attachment.range.imageRange, barrier.newLayout);
+                            // this branch should not be reached
+                            vkrg_assert(false);
                         }
 
-                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                        barrier.srcAccessMask = VK_ACCESS_NONE;
-                        barrier.dstAccessMask = VK_ACCESS_NONE;
-                        barrier.pNext = NULL;
-
-                        RenderGraphBarrier::Handle handle;
-                        handle.idx = assign.idx;
-                        handle.external = assign.external;
+                        if (FindLastAccessedNodeForResource(resource.idx) == currentMergedPass && m_LogicalResourceList[resource.idx].finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+                        {
+                            VkPipelineStageFlagBits srcStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;//, dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+                            VkPipelineStageFlagBits dstStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
-                        globalBarrierHelper.AddImage(srcStage, dstStage, barrier, handle);
+                            VkImageMemoryBarrier barrier{};
+                            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                            barrier.newLayout = m_LogicalResourceList[resource.idx].finalLayout;
+                            barrier.srcAccessMask = VK_ACCESS_NONE;
+                            barrier.dstAccessMask = VK_ACCESS_NONE;
+                            barrier.pNext = NULL;
+
+                            auto assign = m_LogicalResourceAssignmentTable[resource.idx];
+                            RenderGraphBarrier::Handle handle;
+                            handle.idx = assign.idx;
+                            handle.external = assign.external;
+
+                            ImageLayoutStatus& layouts = assign.external ? externalResourceLayouts[assign.idx] : physicalResourceLayouts[assign.idx];
+                            layouts.QueryRanges(attachment.range.imageRange,
+                                [&](ImageSlice range, VkImageLayout oldLayout)
+                                {
+                                    barrier.subresourceRange = range;
+                                    barrier.oldLayout = oldLayout;
+                                    globalBarrierHelper.AddImage(srcStage, dstStage, barrier, handle);
+                                });
+                            layouts.Update(attachment.range.imageRange, barrier.newLayout);
+                        }
                     }
                 }
 
+                info.type = currentMergedPass->renderPasses[0]->pass->GetType();
                 info.compute.targetRenderPass = currentMergedPass->renderPasses[0]->idx;
             }
             else
             {
-                std::vector<ImageFBAttachmentStatus> physicalResourceAttachmentTable;
-                std::vector<ImageFBAttachmentStatus> externalResourceAttachmentTable;
-
-                for (uint32_t i = 0; i < m_PhysicalResources.size(); i++)
-                {
-                    physicalResourceAttachmentTable.push_back(ImageFBAttachmentStatus(m_PhysicalResources[i].info));
-                }
-                for (uint32_t i = 0; i < m_ExternalResources.size(); i++)
-                {
-                    externalResourceAttachmentTable.push_back(ImageFBAttachmentStatus(m_LogicalResourceList[m_ExternalResources[i].handle.idx].info));
-                }
+                fbAttachmentStatus.Clear();
 
                 struct FrameBufferAttachmentDescriptor
                 {
@@ -1296,6 +1639,8 @@ namespace vkrg
 
                     VkImageLayout initLayout;
                     VkImageLayout finalLayout;
+                    // layout used inside the render pass, final layout might be overwritten by the last access of the resource
+                    VkImageLayout renderingLayout;
 
                 };
                 std::vector<FrameBufferAttachmentDescriptor>    frameBufferAttachmentDescs;
@@ -1303,6 +1648,8 @@ namespace vkrg
                 std::vector<RenderGraphPassInfo::FBAttachment>  frameBufferAttachments;
 
                 GvkRenderPassCreateInfo vkRenderPassCreateInfo;
+                // render passes with the same description are shared, also with graphs reloaded from this graph
+                RenderPassKey renderPassKey;
 
                 // collecte all frame buffer resources for render pass
                 info.type = RenderPassType::Graphics;
@@ -1327,9 +1674,9 @@ namespace vkrg
                         {
                             // the mapped external resource index of the logical resource index
                             auto& externalResourceIdx = m_LogicalResourceAssignmentTable[resource.idx].idx;
-                            uint32_t externalResourceAttachmentIdx = externalResourceAttachmentTable[externalResourceIdx].Query(attachment.range.imageRange);
+                            uint32_t externalResourceAttachmentIdx = fbAttachmentStatus.Query(true, externalResourceIdx, attachment.range.imageRange);
 
-                            if (externalResourceAttachmentTable[externalResourceIdx].Query(attachment.range.imageRange) == ImageFBAttachmentStatus::invalidIdx ||
+                            if (externalResourceAttachmentIdx == ImageFBAttachmentStatus::invalidIdx ||
                                 frameBufferAttachments[externalResourceAttachmentIdx].viewType != attachment.viewType)
                             {
                                 uint32_t idx = frameBufferAttachmentDescs.size();
@@ -1357,6 +1704,7 @@ namespace vkrg
                                 renderPassNode->pass->GetAttachmentOperationState(attachment, opState);
 
                                 desc.finalLayout = renderPassNode->pass->GetAttachmentExpectedState(attachment);
+                                desc.renderingLayout = desc.finalLayout;
 
                                 desc.loadOp = opState.load;
                                 desc.storeOp = opState.store;
@@ -1381,11 +1729,12 @@ namespace vkrg
                                 }
 
                                 frameBufferAttachmentDescs.push_back(desc);
-                                externalResourceAttachmentTable[externalResourceIdx].Update(attachment.range.imageRange, idx);
+                                fbAttachmentStatus.Update(true, externalResourceIdx, attachment.range.imageRange, idx);
 
                                 RenderGraphPassInfo::FBAttachment fbAttachment;
                                 fbAttachment.assign = m_LogicalResourceAssignmentTable[resource.idx];
-                                fbAttachment.subresource = attachment.range.imageRange;
+                                // frame buffers and imageless attachment infos need the actual layer count
+                                fbAttachment.subresource = ResolveImageSlice(attachment.range.imageRange, m_LogicalResourceList[resource.idx].info);
                                 fbAttachment.viewType = attachment.viewType;
 
                                 frameBufferAttachments.push_back(fbAttachment);
@@ -1429,7 +1778,7 @@ namespace vkrg
                         else
                         {
                             auto& physicalResourceIdx = m_LogicalResourceAssignmentTable[resource.idx].idx;
-                            uint32_t physicalResourceAttachmentIdx = physicalResourceAttachmentTable[physicalResourceIdx].Query(attachment.range.imageRange);
+                            uint32_t physicalResourceAttachmentIdx = fbAttachmentStatus.Query(false, physicalResourceIdx, attachment.range.imageRange);
 
                             if (physicalResourceAttachmentIdx == ImageFBAttachmentStatus::invalidIdx || frameBufferAttachments[physicalResourceAttachmentIdx].viewType
                                 != attachment.viewType)
@@ -1459,6 +1808,7 @@ namespace vkrg
                                 renderPassNode->pass->GetAttachmentOperationState(attachment, opState);
 
                                 desc.finalLayout = renderPassNode->pass->GetAttachmentExpectedState(attachment);
+                                desc.renderingLayout = desc.finalLayout;
 
                                 desc.loadOp = opState.load;
                                 desc.storeOp = opState.store;
@@ -1472,12 +1822,13 @@ namespace vkrg
                                 physicalResourceLayouts[physicalResourceIdx].Update(attachment.range.imageRange, desc.finalLayout);
 
                                 frameBufferAttachmentDescs.push_back(desc);
-                                physicalResourceAttachmentTable[physicalResourceIdx].Update(attachment.range.imageRange, idx);
+                                fbAttachmentStatus.Update(false, physicalResourceIdx, attachment.range.imageRange, idx);
 
 
                                 RenderGraphPassInfo::FBAttachment fbAttachment;
                                 fbAttachment.assign = m_LogicalResourceAssignmentTable[resource.idx];
-                                fbAttachment.subresource = attachment.range.imageRange;
+                                // frame buffers and imageless attachment infos need the actual layer count
+                                fbAttachment.subresource = ResolveImageSlice(attachment.range.imageRange, m_LogicalResourceList[resource.idx].info);
                                 fbAttachment.viewType = attachment.viewType;
 
                                 frameBufferAttachments.push_back(fbAttachment);
@@ -1493,6 +1844,7 @@ namespace vkrg
                                 renderPassNode->pass->GetAttachmentOperationState(attachment, opState);
                                 FrameBufferAttachmentDescriptor& desc = frameBufferAttachmentDescs[physicalResourceAttachmentIdx];
                                 desc.finalLayout = renderPassNode->pass->GetAttachmentExpectedState(attachment);
+                                desc.renderingLayout = desc.finalLayout;
 
                                 // overwrite the clear color value requirment
                                 // this branch might not be reached
@@ -1570,6 +1922,15 @@ namespace vkrg
                     auto& desc = frameBufferAttachmentDescs[i];
                     auto& fbAttachmentAssign = frameBufferAttachments[i].assign;
 
+                    // only loading and storing move memory, clears and discards stay on chip
+                    uint32_t stencilSize = GetFormatStencilSize(desc.format);
+                    uint32_t aspectSize = GetFormatTexelSize(desc.format) - stencilSize;
+                    auto& fbAttachment = info.render.fbAttachmentIdx[i];
+                    fbAttachment.loadBytesPerTexel = (desc.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? aspectSize : 0) +
+                        (desc.stencilLoadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? stencilSize : 0);
+                    fbAttachment.storeBytesPerTexel = (desc.storeOp == VK_ATTACHMENT_STORE_OP_STORE ? aspectSize : 0) +
+                        (desc.stencilStoreOp == VK_ATTACHMENT_STORE_OP_STORE ? stencilSize : 0);
+
 
                     //http://geekfaner.com/shineengine/blog18_Vulkanv1.2_4.html
                     //һrender passʹöattachment aliasͬdevice memoryÿattachment VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT attachments aliasͬڴ¼ַʽ
@@ -1582,14 +1943,7 @@ namespace vkrg
 
                     // 鵱ǰrender passattachment֮Ƿص
                     // attachment VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT
-                    if (fbAttachmentAssign.external)
-                    {
-                        flags |= externalResourceAttachmentTable[fbAttachmentAssign.idx].MayAlias() ? VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT : 0;
-                    }
-                    else
-                    {
-                        flags |= physicalResourceAttachmentTable[fbAttachmentAssign.idx].MayAlias() ? VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT : 0;
-                    }
+                    flags |= fbAttachmentStatus.MayAlias(fbAttachmentAssign.external, fbAttachmentAssign.idx) ? VK_ATTACHMENT_DESCRIPTION_MAY_ALIAS_BIT : 0;
 
 
                     vkRenderPassCreateInfo.AddAttachment(
@@ -1603,14 +1957,144 @@ namespace vkrg
                         desc.initLayout,
                         desc.finalLayout
                     );
+                    renderPassKey.Add(RenderPassKey::Attachment, { flags, (uint32_t)desc.format, (uint32_t)desc.loadOp, (uint32_t)desc.storeOp,
+                        (uint32_t)desc.stencilLoadOp, (uint32_t)desc.stencilStoreOp, (uint32_t)desc.initLayout, (uint32_t)desc.finalLayout });
                     info.render.fbClearValues = frameBufferAttachmentClearColor;
                 }
 
+                // if the pass is skipped at runtime, frame buffer attachments should still be transitioned
+                // to the layouts following passes expect
+                if (currentMergedPass->renderPasses[0]->pass->IsConditional())
+                {
+                    ImageBarrierHelper skipBarrierHelper(m_Options.flightFrameCount);
+                    for (uint32_t i = 0; i < frameBufferAttachmentDescs.size(); i++)
+                    {
+                        auto& desc = frameBufferAttachmentDescs[i];
+                        if (desc.initLayout == desc.finalLayout) continue;
+
+                        VkImageMemoryBarrier barrier{};
+                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                        barrier.pNext = NULL;
+                        barrier.subresourceRange = frameBufferAttachments[i].subresource;
+                        barrier.oldLayout = desc.initLayout;
+                        barrier.newLayout = desc.finalLayout;
+                        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+                        RenderGraphBarrier::Handle handle;
+                        handle.idx = frameBufferAttachments[i].assign.idx;
+                        handle.external = frameBufferAttachments[i].assign.external;
+
+                        skipBarrierHelper.AddImage(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, barrier, handle);
+                    }
+                    info.render.skipBarriers = skipBarrierHelper.barriers;
+                }
+
+                // passes merged with others and passes reading input attachments need subpasses
+                info.render.dynamicRendering = m_Options.dynamicRendering && currentMergedPass->renderPasses.size() == 1;
+                for (auto& attachment : currentMergedPass->renderPasses[0]->pass->GetAttachments())
+                {
+                    if (attachment.type == RenderPassAttachment::ImageColorInput)
+                    {
+                        info.render.dynamicRendering = false;
+                    }
+                }
+
+                if (info.render.dynamicRendering)
+                {
+                    auto& dynamic = info.render.dynamic;
+                    dynamic.depthStencilFBAttachmentIdx = ImageFBAttachmentStatus::invalidIdx;
+                    dynamic.depthAttachment = {};
+                    dynamic.stencilAttachment = {};
+                    dynamic.layerCount = frameBufferAttachments.empty() ? 1 : UINT32_MAX;
+
+                    ImageBarrierHelper beginBarrierHelper(m_Options.flightFrameCount), endBarrierHelper(m_Options.flightFrameCount);
+                    for (uint32_t i = 0; i < frameBufferAttachmentDescs.size(); i++)
+                    {
+                        auto& desc = frameBufferAttachmentDescs[i];
+                        auto& subresource = frameBufferAttachments[i].subresource;
+                        bool isDepthStencil = (subresource.aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) != 0;
+                        // remaining layers are resolved already
+                        dynamic.layerCount = std::min(dynamic.layerCount, subresource.layerCount);
+
+                        VkRenderingAttachmentInfoKHR attachmentInfo{};
+                        attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+                        attachmentInfo.imageLayout = desc.renderingLayout;
+                        attachmentInfo.resolveMode = VK_RESOLVE_MODE_NONE;
+                        attachmentInfo.loadOp = desc.loadOp;
+                        attachmentInfo.storeOp = desc.storeOp;
+                        attachmentInfo.clearValue = frameBufferAttachmentClearColor[i];
+
+                        if (isDepthStencil)
+                        {
+                            // a render pass has at most one depth stencil attachment
+                            vkrg_assert(dynamic.depthStencilFBAttachmentIdx == ImageFBAttachmentStatus::invalidIdx);
+                            dynamic.depthStencilFBAttachmentIdx = i;
+
+                            if (subresource.aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT)
+                            {
+                                dynamic.depthAttachment = attachmentInfo;
+                                dynamic.formats.depthFormat = desc.format;
+                            }
+                            if (subresource.aspectMask & VK_IMAGE_ASPECT_STENCIL_BIT)
+                            {
+                                dynamic.stencilAttachment = attachmentInfo;
+                                dynamic.stencilAttachment.loadOp = desc.stencilLoadOp;
+                                dynamic.stencilAttachment.storeOp = desc.stencilStoreOp;
+                                dynamic.formats.stencilFormat = desc.format;
+                            }
+                        }
+                        else
+                        {
+                            dynamic.colorAttachments.push_back(attachmentInfo);
+                            dynamic.colorFBAttachmentIdx.push_back(i);
+                            dynamic.formats.colorFormats.push_back(desc.format);
+                        }
+
+                        RenderGraphBarrier::Handle handle;
+                        handle.idx = frameBufferAttachments[i].assign.idx;
+                        handle.external = frameBufferAttachments[i].assign.external;
+
+                        VkPipelineStageFlagBits attachmentStage = isDepthStencil ? VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                        VkAccessFlags attachmentAccess = isDepthStencil ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                            : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+                        VkImageMemoryBarrier barrier{};
+                        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                        barrier.pNext = NULL;
+                        barrier.subresourceRange = subresource;
+
+                        // render passes synchronize attachments with previous passes through external subpass dependencies,
+                        // the barrier is required even if the layout is not changed
+                        barrier.oldLayout = desc.initLayout;
+                        barrier.newLayout = desc.renderingLayout;
+                        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                        barrier.dstAccessMask = attachmentAccess;
+                        beginBarrierHelper.AddImage(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, attachmentStage, barrier, handle);
+
+                        if (desc.renderingLayout != desc.finalLayout)
+                        {
+                            barrier.oldLayout = desc.renderingLayout;
+                            barrier.newLayout = desc.finalLayout;
+                            barrier.srcAccessMask = attachmentAccess;
+                            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+                            endBarrierHelper.AddImage(isDepthStencil ? VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, barrier, handle);
+                        }
+                    }
+
+                    dynamic.beginBarriers = beginBarrierHelper.barriers;
+                    dynamic.endBarriers = endBarrierHelper.barriers;
+                }
+
+
+
                 // create render pass
                 for (auto renderPassNode : currentMergedPass->renderPasses)
                 {
                     info.render.mergedSubpassIndices.push_back(renderPassNode->idx);
                     uint32_t currentSubpassIndex = vkRenderPassCreateInfo.AddSubpass();
+                    renderPassKey.Add(RenderPassKey::Subpass, {});
 
                     // iterate all depending nodes
                     for (DAGAdjNode dependingPassNode = m_Graph.IterateAdjucentIn(renderPassNode); !dependingPassNode.IsEnd();
@@ -1669,6 +2153,8 @@ namespace vkrg
                             dependingMergedPassNodeStage, currentMergedPassNodeStage,
                             dependingMemoryAccessFlag, currentMemoryAccessFlag
                         );
+                        renderPassKey.Add(RenderPassKey::SubpassDependency, { dependingPassIndex, currentSubpassIndex,
+                            dependingMergedPassNodeStage, currentMergedPassNodeStage, dependingMemoryAccessFlag, currentMemoryAccessFlag });
                     }
 
                     // iterate all resource dependencies
@@ -1683,15 +2169,8 @@ namespace vkrg
 
                         if (m_LogicalResourceList[resource.idx].info.IsBuffer()) continue;
 
-                        uint32_t fbAttachmentIdx = ImageFBAttachmentStatus::invalidIdx;
-                        if (!resource.external)
-                        {
-                            fbAttachmentIdx = physicalResourceAttachmentTable[m_LogicalResourceAssignmentTable[resource.idx].idx].Query(attachment.range.imageRange);
-                        }
-                        else
-                        {
-                            fbAttachmentIdx = externalResourceAttachmentTable[m_LogicalResourceAssignmentTable[resource.idx].idx].Query(attachment.range.imageRange);
-                        }
+                        auto& assign = m_LogicalResourceAssignmentTable[resource.idx];
+                        uint32_t fbAttachmentIdx = fbAttachmentStatus.Query(assign.external, assign.idx, attachment.range.imageRange);
 
                         // something goes wrong in our code if this operation fails
                         vkrg_assert(fbAttachmentIdx != ImageFBAttachmentStatus::invalidIdx);
@@ -1699,31 +2178,42 @@ namespace vkrg
                         RenderPassAttachmentOperationState opState{};
                         renderPassNode->pass->GetAttachmentOperationState(attachment, opState);
 
-                        vkrg_assert(attachment.type != RenderPassAttachment::ImageStorageInput && attachment.type != RenderPassAttachment::ImageStorageOutput);
+                        vkrg_assert(attachment.type != RenderPassAttachment::ImageStorageInput && attachment.type != RenderPassAttachment::ImageStorageOutput
+                            && attachment.type != RenderPassAttachment::ImageStorageInputOutput);
 
                         if (attachment.type == RenderPassAttachment::ImageColorInput)
                         {
                             vkRenderPassCreateInfo.AddSubpassInputAttachment(currentSubpassIndex, fbAttachmentIdx, renderPassNode->pass->GetAttachmentExpectedState(attachment));
+                            renderPassKey.Add(RenderPassKey::SubpassInputAttachment, { currentSubpassIndex, fbAttachmentIdx,
+                                (uint32_t)renderPassNode->pass->GetAttachmentExpectedState(attachment) });
                         }
-                        else if (attachment.type == RenderPassAttachment::ImageColorOutput)
+                        else if (attachment.type == RenderPassAttachment::ImageColorOutput || attachment.type == RenderPassAttachment::ImageColorInputOutput)
                         {
                             vkRenderPassCreateInfo.AddSubpassColorAttachment(currentSubpassIndex, fbAttachmentIdx);
+                            renderPassKey.Add(RenderPassKey::SubpassColorAttachment, { currentSubpassIndex, fbAttachmentIdx });
                         }
                         else if (attachment.type == RenderPassAttachment::ImageDepthOutput || attachment.type == RenderPassAttachment::ImageDepthInput)
                         {
                             vkRenderPassCreateInfo.AddSubpassDepthStencilAttachment(currentSubpassIndex, fbAttachmentIdx);
+                            renderPassKey.Add(RenderPassKey::SubpassDepthStencilAttachment, { currentSubpassIndex, fbAttachmentIdx });
                         }
                     }
                 }
 
-                if (auto rp = m_vulkanContext.ctx->CreateRenderPass(vkRenderPassCreateInfo); rp.has_value())
-                {
-                    info.render.renderPass = rp.value();
-                }
-                else
+                // passes recorded with dynamic rendering have no render pass object,
+                // subpass dependencies are replaced by begin barriers
+                // graphs compiled without a device are only inspected, render passes can't be created for them
+                if (!info.render.dynamicRendering && m_vulkanContext.ctx != nullptr)
                 {
-                    msg = "fail to create vulkan render pass";
-                    return RenderGraphCompileState::Error_FailToCreateRenderPass;
+                    if (auto rp = m_RenderPassCache.Acquire(renderPassKey, vkRenderPassCreateInfo); rp.has_value())
+                    {
+                        info.render.renderPass = rp.value();
+                    }
+                    else
+                    {
+                        msg = "fail to create vulkan render pass";
+                        return RenderGraphCompileState::Error_FailToCreateRenderPass;
+                    }
                 }
             }
 
@@ -1732,13 +2222,22 @@ namespace vkrg
             if (info.type != RenderPassType::Graphics)
             {
                 info.compute.barriers = barrierHelper.barriers;
+                m_renderGraphPassInfo.push_back(info);
+
+                // other passes of the dispatch group are recorded right after the first one without barriers
+                for (uint32_t i = 1; i < currentMergedPass->renderPasses.size(); i++)
+                {
+                    info.type = currentMergedPass->renderPasses[i]->pass->GetType();
+                    info.compute.barriers.clear();
+                    info.compute.targetRenderPass = currentMergedPass->renderPasses[i]->idx;
+                    m_renderGraphPassInfo.push_back(info);
+                }
             }
             else
             {
                 info.render.bufferBarriers = barrierHelper.barriers;
+                m_renderGraphPassInfo.push_back(info);
             }
-
-            m_renderGraphPassInfo.push_back(info);
         }
 
         m_finalGlobalBarriers = globalBarrierHelper.barriers;
@@ -1801,87 +2300,109 @@ namespace vkrg
 
     void RenderGraph::ResizePhysicalResources()
     {
+        VKRG_TRACE_SCOPE("RenderGraph::ResizePhysicalResources");
+        // graphs compiled without a device are only inspected, nothing is allocated for them
+        if (m_vulkanContext.ctx == nullptr) return;
+
+        uint32_t resourceFrameCount = m_Options.disableFrameOnFlight ? 1 : m_Options.flightFrameCount;
         for (uint32_t physicalResourceIdx = 0; physicalResourceIdx != m_PhysicalResources.size(); physicalResourceIdx++)
         {
             auto& binding = m_PhysicalResourceBindings[physicalResourceIdx];
             const auto& info = m_PhysicalResources[physicalResourceIdx].info;
 
-            binding.dirtyFlag = true;
-            for (uint32_t i = 0; i < m_Options.flightFrameCount; i++)
+            // only resources created or reallocated are marked dirty
+            bool bindingChanged = false;
+            for (uint32_t i = 0; i < resourceFrameCount; i++)
             {
-                if (info.IsBuffer() && binding.buffers[i] == nullptr)
+                if (info.IsBuffer())
                 {
-                    binding.buffers[i] = nullptr;
-                    auto res = m_vulkanContext.ctx->CreateBuffer(info.usages, info.ext.buffer.size, GVK_HOST_WRITE_NONE);
-                    // this operation shouldn't fail
-                    // 2 cases might cause failure
-                    // 1. some thing goes wrong with our validation checker
-                    // 2. out of memory
-                    vkrg_assert(res.has_value());
-                    binding.buffers[i] = res.value();
+                    // buffer size doesn't depend on screen size
+                    if (binding.buffers[i] != nullptr) continue;
+
+                    // buffers of the graph this graph is reloaded from
+                    auto adopted = std::find_if(m_AdoptedBuffers.begin(), m_AdoptedBuffers.end(), [&](const auto& buffer)
+                        {
+                            const ResourceInfo& adoptedInfo = std::get<1>(buffer);
+                            return adoptedInfo.ext.buffer.size == info.ext.buffer.size && adoptedInfo.usages == info.usages;
+                        });
+                    if (adopted != m_AdoptedBuffers.end())
+                    {
+                        binding.buffers[i] = std::get<0>(*adopted);
+                        m_AdoptedBuffers.erase(adopted);
+                    }
+                    else
+                    {
+                        auto res = m_vulkanContext.ctx->CreateBuffer(info.usages, info.ext.buffer.size, GVK_HOST_WRITE_NONE);
+                        // this operation shouldn't fail
+                        // 2 cases might cause failure
+                        // 1. some thing goes wrong with our validation checker
+                        // 2. out of memory
+                        vkrg_assert(res.has_value());
+                        binding.buffers[i] = res.value();
+                    }
 
                     if (m_Options.setDebugName)
                     {
                         binding.buffers[i]->SetDebugName("Physical_Resource_" + std::to_string(physicalResourceIdx));
                     }
                 }
-                else if (info.IsImage())
+                else
                 {
-                    if (binding.images[i] != nullptr) continue;
-
                     auto imageCI = CreateImageCreateInfo(info);
-                    auto res = m_vulkanContext.ctx->CreateImage(imageCI);
+                    // screen relative images are allocated at a size class, views and render areas still use the screen size
+                    bool sizeClassed = info.extType == ResourceExtensionType::Screen && imageCI.imageType == VK_IMAGE_TYPE_2D;
+
+                    if (binding.images[i] != nullptr)
+                    {
+                        // only screen relative images change with screen size
+                        if (info.extType != ResourceExtensionType::Screen) continue;
+
+                        // the image is kept if it is still in the size class, frame buffers are rebuilt at the new size
+                        GvkImageCreateInfo currentCI = binding.images[i]->Info();
+                        if (ImagePool::InSizeClass(currentCI.extent, imageCI.extent))
+                        {
+                            bindingChanged = true;
+                            continue;
+                        }
+
+                        // the pool keeps the image, cached views and frame buffers of it should not
+                        m_FrameBufferCache.EvictImage(binding.images[i]->GetImage());
+                        m_ImageViewCache.EvictImage(binding.images[i]->GetImage());
+                        // the image might still be used by frames on flight, the pool won't hand it out before they retire
+                        m_ImagePool.Release(binding.images[i], currentCI);
+                    }
 
                     // this operation shouldn't fail
                     // 2 cases might cause failure
                     // 1. some thing goes wrong with our validation checker
                     // 2. out of memory
-                    vkrg_assert(res.has_value());
-                    binding.images[i] = res.value();
+                    binding.images[i] = m_ImagePool.Acquire(imageCI, sizeClassed);
 
                     if (m_Options.setDebugName)
                     {
                         binding.images[i]->SetDebugName("Physical_Resource_" + std::to_string(physicalResourceIdx));
                     }
                 }
-                else
-                {
-                    // this branch should not be reached
-                    vkrg_assert(false);
-                }
 
-                if (m_Options.disableFrameOnFlight) break;
+                bindingChanged = true;
             }
-        }
 
-    }
-
-    void RenderGraph::UpdateDirtyViews()
-    {
-        std::unordered_set<uint32_t> dirtyExternalResourceSet;
-        std::unordered_set<uint32_t> dirtyPhysicalResourceSet;
-
-
-        for (uint32_t i = 0; i < m_ExternalResourceBindings.size(); i++)
-        {
-            if (m_ExternalResourceBindings[i].dirtyFlag)
+            if (bindingChanged)
             {
-                dirtyExternalResourceSet.insert(i);
-                // we clear resource binding dirty flag in ResetResourceBindingFlag()
-                // m_ExternalResourceBindings[i].dirtyFlag = false;
-            }
-        }
-        for (uint32_t i = 0; i < m_PhysicalResourceBindings.size(); i++)
-        {
-            if (m_PhysicalResourceBindings[i].dirtyFlag)
-            {
-                dirtyPhysicalResourceSet.insert(i);
-                // m_PhysicalResourceBindings[i].dirtyFlag = false;
+                m_DirtyPhysicalResources.Set(physicalResourceIdx);
             }
         }
 
+    }
+
+    void RenderGraph::UpdateDirtyViews()
+    {
+        VKRG_TRACE_SCOPE("RenderGraph::UpdateDirtyViews");
+        // we clear resource binding dirty flag in ResetResourceBindingFlag()
         for (uint32_t passIdx = 0; passIdx < m_RenderPassList.size(); passIdx++)
         {
+            if (m_CulledRenderPasses[passIdx]) continue;
+
             auto& attachments = m_RenderPassList[passIdx].pass->GetAttachments();
             auto& resources = m_RenderPassList[passIdx].pass->GetAttachedResourceHandles();
 
@@ -1897,12 +2418,12 @@ namespace vkrg
                 bool viewRecreationRequired = false;
                 if (resource.external)
                 {
-                    viewRecreationRequired = dirtyExternalResourceSet.count(m_LogicalResourceAssignmentTable[resource.idx].idx);
+                    viewRecreationRequired = m_DirtyExternalResources.Test(m_LogicalResourceAssignmentTable[resource.idx].idx);
                     binding = &m_ExternalResourceBindings[m_LogicalResourceAssignmentTable[resource.idx].idx];
                 }
                 else
                 {
-                    viewRecreationRequired = dirtyPhysicalResourceSet.count(m_LogicalResourceAssignmentTable[resource.idx].idx);
+                    viewRecreationRequired = m_DirtyPhysicalResources.Test(m_LogicalResourceAssignmentTable[resource.idx].idx);
                     binding = &m_PhysicalResourceBindings[m_LogicalResourceAssignmentTable[resource.idx].idx];
                 }
 
@@ -1929,19 +2450,17 @@ namespace vkrg
                         {
                             uint32_t targetImageIndex = GetResourceFrameIdx(frameIdx, resource.external);
 
-                            auto imageView = binding->images[targetImageIndex]->CreateView(attachment.range.imageRange.aspectMask,
-                                attachment.range.imageRange.baseMipLevel,
-                                attachment.range.imageRange.levelCount,
-                                attachment.range.imageRange.baseArrayLayer,
-                                attachment.range.imageRange.layerCount,
-                                attachment.viewType);
-                            vkrg_assert(imageView.has_value());
-
+                            // acquire before releasing, the view is kept if the binding is not changed for this frame
                             RenderPassViewTable::View view;
-                            view.imageView = imageView.value();
+                            view.imageView = m_ImageViewCache.Acquire(binding->images[targetImageIndex], attachment.range.imageRange, attachment.viewType);
                             view.isImage = true;
 
-                            m_RPViewTable[passIdx].attachmentViews[frameIdx][attachmentIdx] = view;
+                            auto& oldView = m_RPViewTable[passIdx].attachmentViews[frameIdx][attachmentIdx];
+                            if (oldView.isImage)
+                            {
+                                m_ImageViewCache.Release(oldView.imageView);
+                            }
+                            oldView = view;
                         }
                     }
                 }
@@ -1950,54 +2469,60 @@ namespace vkrg
 
     }
 
-    void RenderGraph::UpdateDirtyFrameBuffersAndBarriers()
+    void RenderGraph::UpdateDirtyBarriers(std::vector<RenderGraphBarrier>& barriers)
     {
-        // TODO update frame buffer according to view update
-        for (auto& finalBarrier : m_finalGlobalBarriers)
+        for (auto& barrier : barriers)
         {
-            for (uint32_t i = 0; i != finalBarrier.imageBarriers[0].size(); i++)
+            for (uint32_t i = 0; i != barrier.imageBarriers[0].size(); i++)
             {
                 ResourceBindingInfo* binding = NULL;
-                if (finalBarrier.imageBarrierHandles[i].external)
+                if (barrier.imageBarrierHandles[i].external)
                 {
-                    binding = &m_ExternalResourceBindings[finalBarrier.imageBarrierHandles[i].idx];
+                    binding = &m_ExternalResourceBindings[barrier.imageBarrierHandles[i].idx];
                 }
                 else
                 {
-                    binding = &m_PhysicalResourceBindings[finalBarrier.imageBarrierHandles[i].idx];
+                    binding = &m_PhysicalResourceBindings[barrier.imageBarrierHandles[i].idx];
                 }
 
-                if (binding->dirtyFlag)
+                if (IsResourceBindingDirty(barrier.imageBarrierHandles[i].external, barrier.imageBarrierHandles[i].idx))
                 {
                     for (uint32_t frameIdx = 0; frameIdx < m_Options.flightFrameCount; frameIdx++)
                     {
-                        uint32_t targetImageIdx = GetResourceFrameIdx(frameIdx, finalBarrier.imageBarrierHandles[i].external);
-                        finalBarrier.imageBarriers[frameIdx][i].image = binding->images[targetImageIdx]->GetImage();
+                        uint32_t targetImageIdx = GetResourceFrameIdx(frameIdx, barrier.imageBarrierHandles[i].external);
+                        barrier.imageBarriers[frameIdx][i].image = binding->images[targetImageIdx]->GetImage();
                     }
                 }
             }
-            for (uint32_t i = 0; i < finalBarrier.bufferBarriers[0].size(); i++)
+            for (uint32_t i = 0; i < barrier.bufferBarriers[0].size(); i++)
             {
                 ResourceBindingInfo* binding = NULL;
-                if (finalBarrier.bufferBarrierHandles[i].external)
+                if (barrier.bufferBarrierHandles[i].external)
                 {
-                    binding = &m_ExternalResourceBindings[finalBarrier.bufferBarrierHandles[i].idx];
+                    binding = &m_ExternalResourceBindings[barrier.bufferBarrierHandles[i].idx];
                 }
                 else
                 {
-                    binding = &m_PhysicalResourceBindings[finalBarrier.bufferBarrierHandles[i].idx];
+                    binding = &m_PhysicalResourceBindings[barrier.bufferBarrierHandles[i].idx];
                 }
 
-                if (binding->dirtyFlag)
+                if (IsResourceBindingDirty(barrier.bufferBarrierHandles[i].external, barrier.bufferBarrierHandles[i].idx))
                 {
                     for (uint32_t frameIdx = 0; frameIdx < m_Options.flightFrameCount; frameIdx++)
                     {
-                        uint32_t targetBufferIdx = GetResourceFrameIdx(frameIdx, finalBarrier.bufferBarrierHandles[i].external);
-                        finalBarrier.bufferBarriers[frameIdx][i].buffer = binding->buffers[targetBufferIdx]->GetBuffer();
+                        uint32_t targetBufferIdx = GetResourceFrameIdx(frameIdx, barrier.bufferBarrierHandles[i].external);
+                        barrier.bufferBarriers[frameIdx][i].buffer = binding->buffers[targetBufferIdx]->GetBuffer();
                     }
                 }
             }
         }
+    }
+
+    void RenderGraph::UpdateDirtyFrameBuffersAndBarriers()
+    {
+        VKRG_TRACE_SCOPE("RenderGraph::UpdateDirtyFrameBuffersAndBarriers");
+        // TODO update frame buffer according to view update
+        UpdateDirtyBarriers(m_finalGlobalBarriers);
 
         for (uint32_t renderPassIdx = 0; renderPassIdx < m_renderGraphPassInfo.size(); renderPassIdx++)
         {
@@ -2005,51 +2530,7 @@ namespace vkrg
             auto& rpfBuffer = m_RPFrameBuffers[renderPassIdx];
             if (passInfo.IsGeneralPass())
             {
-                for (auto& barrier : passInfo.compute.barriers)
-                {
-                    for (uint32_t i = 0; i < barrier.bufferBarriers[0].size(); i++)
-                    {
-                        ResourceBindingInfo* binding = NULL;
-                        if (barrier.bufferBarrierHandles[i].external)
-                        {
-                            binding = &m_ExternalResourceBindings[barrier.bufferBarrierHandles[i].idx];
-                        }
-                        else
-                        {
-                            binding = &m_PhysicalResourceBindings[barrier.bufferBarrierHandles[i].idx];
-                        }
-
-                        if (binding->dirtyFlag)
-                        {
-                            for (uint32_t frameIdx = 0; frameIdx < m_Options.flightFrameCount; frameIdx++)
-                            {
-                                uint32_t targetBufferIdx = GetResourceFrameIdx(frameIdx, barrier.bufferBarrierHandles[i].external);
-                                barrier.bufferBarriers[frameIdx][i].buffer = binding->buffers[targetBufferIdx]->GetBuffer();
-                            }
-                        }
-                    }
-                    for (uint32_t i = 0; i < barrier.imageBarriers[0].size(); i++)
-                    {
-                        ResourceBindingInfo* binding = NULL;
-                        if (barrier.imageBarrierHandles[i].external)
-                        {
-                            binding = &m_ExternalResourceBindings[barrier.imageBarrierHandles[i].idx];
-                        }
-                        else
-                        {
-                            binding = &m_PhysicalResourceBindings[barrier.imageBarrierHandles[i].idx];
-                        }
-
-                        if (binding->dirtyFlag)
-                        {
-                            for (uint32_t frameIdx = 0; frameIdx < m_Options.flightFrameCount; frameIdx++)
-                            {
-                                uint32_t targetImageIdx = GetResourceFrameIdx(frameIdx, barrier.imageBarrierHandles[i].external);
-                                barrier.imageBarriers[frameIdx][i].image = binding->images[targetImageIdx]->GetImage();
-                            }
-                        }
-                    }
-                }
+                UpdateDirtyBarriers(passInfo.compute.barriers);
             }
             else
             {
@@ -2058,9 +2539,7 @@ namespace vkrg
                 {
                     auto& attachment = passInfo.render.fbAttachmentIdx[attachmentIdx];
 
-                    ResourceBindingInfo* binding = GetAssignedResourceBinding(attachment.assign);
-
-                    if (binding->dirtyFlag)
+                    if (IsResourceBindingDirty(attachment.assign.external, attachment.assign.idx))
                     {
                         frameBufferRecreate = true;
                         break;
@@ -2086,59 +2565,50 @@ namespace vkrg
 
                             auto& subresource = attachments[attachmentIdx].subresource;
 
-                            // views will be cached and used so just create a new view is enough
-                            auto view = binding->images[targetFrameIdx]->CreateView(subresource.aspectMask,
-                                subresource.baseMipLevel,
-                                subresource.levelCount,
-                                subresource.baseArrayLayer,
-                                subresource.layerCount,
-                                attachments[attachmentIdx].viewType);
-                            vkrg_assert(view.has_value());
+                            // views are shared with the attachment view table through the cache
+                            auto& view = rpfBuffer.frameBufferViews[frameIdx][attachmentIdx];
+                            VkImageView oldView = view;
+                            view = m_ImageViewCache.Acquire(binding->images[targetFrameIdx], subresource, attachments[attachmentIdx].viewType);
+                            m_ImageViewCache.Release(oldView);
 
-                            m_RPFrameBuffers[renderPassIdx].frameBufferViews[frameIdx][attachmentIdx] = view.value();
+                            if (m_Options.imagelessFrameBuffer)
+                            {
+                                GvkImageCreateInfo imageInfo = binding->images[targetFrameIdx]->Info();
+
+                                FrameBufferAttachmentImage& attachmentImage = rpfBuffer.attachmentImages[attachmentIdx];
+                                attachmentImage.flags = imageInfo.flags;
+                                attachmentImage.usage = imageInfo.usage;
+                                attachmentImage.width = vkrg_max(imageInfo.extent.width >> subresource.baseMipLevel, 1u);
+                                attachmentImage.height = vkrg_max(imageInfo.extent.height >> subresource.baseMipLevel, 1u);
+                                attachmentImage.layerCount = subresource.layerCount;
+                                attachmentImage.format = imageInfo.format;
+                            }
                         }
 
-                        if (m_RPFrameBuffers[renderPassIdx].frameBuffer[frameIdx] != NULL)
-                        {
-                            m_vulkanContext.ctx->DestroyFrameBuffer(m_RPFrameBuffers[renderPassIdx].frameBuffer[frameIdx]);
-                        }
+                        // views are provided by rendering info directly
+                        if (passInfo.render.dynamicRendering) continue;
 
                         auto [w, h, d] = GetExpectedExtension(ext.extension, ext.extensionType);
 
-
-                        auto fb = m_vulkanContext.ctx->CreateFrameBuffer(m_renderGraphPassInfo[renderPassIdx].render.renderPass,
-                            m_RPFrameBuffers[renderPassIdx].frameBufferViews[frameIdx].data(),
-                            w, h, d);
-                        vkrg_assert(fb.has_value());
-
-                        m_RPFrameBuffers[renderPassIdx].frameBuffer[frameIdx] = fb.value();
-                    }
-                }
-
-                for (auto& barrier : passInfo.render.bufferBarriers)
-                {
-                    for (uint32_t i = 0; i < barrier.bufferBarriers[0].size(); i++)
-                    {
-                        ResourceBindingInfo* binding = NULL;
-                        if (barrier.bufferBarrierHandles[i].external)
+                        // imageless frame buffers only depend on the kind of attached images,
+                        // rebinding images of the same kind will hit the cache and all frames share one frame buffer
+                        VkFramebuffer oldFrameBuffer = rpfBuffer.frameBuffer[frameIdx];
+                        if (m_Options.imagelessFrameBuffer)
                         {
-                            binding = &m_ExternalResourceBindings[barrier.bufferBarrierHandles[i].idx];
+                            rpfBuffer.frameBuffer[frameIdx] = m_FrameBufferCache.AcquireImageless(passInfo.render.renderPass, rpfBuffer.attachmentImages, w, h, d);
                         }
                         else
                         {
-                            binding = &m_PhysicalResourceBindings[barrier.bufferBarrierHandles[i].idx];
-                        }
-
-                        if (binding->dirtyFlag)
-                        {
-                            for (uint32_t frameIdx = 0; frameIdx < m_Options.flightFrameCount; frameIdx++)
-                            {
-                                uint32_t targetBufferIdx = GetResourceFrameIdx(frameIdx, barrier.bufferBarrierHandles[i].external);
-                                barrier.bufferBarriers[frameIdx][i].buffer = binding->buffers[targetBufferIdx]->GetBuffer();
-                            }
+                            rpfBuffer.frameBuffer[frameIdx] = m_FrameBufferCache.Acquire(passInfo.render.renderPass, rpfBuffer.frameBufferViews[frameIdx], w, h, d);
                         }
+                        m_FrameBufferCache.Release(oldFrameBuffer);
                     }
                 }
+
+                UpdateDirtyBarriers(passInfo.render.bufferBarriers);
+                UpdateDirtyBarriers(passInfo.render.skipBarriers);
+                UpdateDirtyBarriers(passInfo.render.dynamic.beginBarriers);
+                UpdateDirtyBarriers(passInfo.render.dynamic.endBarriers);
             }
         }
 
@@ -2146,19 +2616,31 @@ namespace vkrg
 
     void RenderGraph::ResetResourceBindingDirtyFlag()
     {
-        for (uint32_t i = 0; i < m_ExternalResourceBindings.size(); i++)
+        m_DirtyExternalResources.Clear();
+        m_DirtyPhysicalResources.Clear();
+    }
+
+    void RenderGraph::GenerateCommands(VkCommandBuffer cmd, uint32_t frameIdx)
+    {
+        VKRG_TRACE_SCOPE("RenderGraph::GenerateCommands");
+        // query pools are reset outside of render passes
+        if (m_Options.gpuProfiling)
         {
-            m_ExternalResourceBindings[i].dirtyFlag = false;
+            m_GpuProfiler.BeginFrame(cmd, frameIdx);
         }
-        for (uint32_t i = 0; i < m_PhysicalResourceBindings.size(); i++)
+        if (m_Options.pipelineStatistics)
         {
-            m_PhysicalResourceBindings[i].dirtyFlag = false;
+            m_StatisticsProfiler.BeginFrame(cmd, frameIdx);
         }
 
-    }
+        EvaluateEnablePredicates(frameIdx);
+
+        // record passes to secondary command buffers first, they are stitched together in schedule order below
+        if (m_Options.parallelRecording)
+        {
+            RecordCommandsInParallel(frameIdx);
+        }
 
-    void RenderGraph::GenerateCommands(VkCommandBuffer cmd, uint32_t frameIdx)
-    {
         // TODO main body of excution
         for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
         {
@@ -2167,8 +2649,6 @@ namespace vkrg
                 auto& renderData = m_renderGraphPassInfo[passIdx].render;
                 VkFramebuffer frameBuffer = m_RPFrameBuffers[passIdx].frameBuffer[frameIdx];
 
-                auto [w, h, _] = GetExpectedExtension(renderData.expectedExtension.extension, renderData.expectedExtension.extensionType);
-
                 auto& graphicsBarrier = m_renderGraphPassInfo[passIdx].render.bufferBarriers;
                 for (uint32_t barrierIdx = 0; barrierIdx < graphicsBarrier.size(); barrierIdx++)
                 {
@@ -2180,21 +2660,111 @@ namespace vkrg
                         0, NULL);
                 }
 
-                VkRect2D fullScreen;
-                fullScreen.extent.width = w;
-                fullScreen.extent.height = h;
-                fullScreen.offset.x = 0;
-                fullScreen.offset.y = 0;
+                // conditional passes are never merged, so the render pass only contains the skipped pass
+                // transition the attachments to the layouts the render pass would leave them in
+                if (!m_EnabledRenderPasses[renderData.mergedSubpassIndices[0]])
+                {
+                    for (auto& barrier : renderData.skipBarriers)
+                    {
+                        vkCmdPipelineBarrier(cmd, barrier.srcStage, barrier.dstStage,
+                            0, 0, NULL, 0, NULL,
+                            barrier.imageBarriers[frameIdx].size(), barrier.imageBarriers[frameIdx].data());
+                    }
+                    continue;
+                }
+
+                BeginGpuScope(cmd, frameIdx, m_PassGpuScopes[passIdx]);
+                if (m_Options.pipelineStatistics)
+                {
+                    m_StatisticsProfiler.BeginQuery(cmd, frameIdx, passIdx);
+                }
 
-                VkViewport vp;
-                vp.height = h;
-                vp.width = w;
-                vp.x = 0;
-                vp.y = 0;
-                vp.minDepth = 0;
-                vp.maxDepth = 1;
+                auto [fullScreen, vp] = GetRenderArea(renderData.expectedExtension);
 
-                if (renderData.mergedSubpassIndices.size() == 1)
+                if (renderData.dynamicRendering)
+                {
+                    for (auto& barrier : renderData.dynamic.beginBarriers)
+                    {
+                        vkCmdPipelineBarrier(cmd, barrier.srcStage, barrier.dstStage,
+                            0, 0, NULL, 0, NULL,
+                            barrier.imageBarriers[frameIdx].size(), barrier.imageBarriers[frameIdx].data());
+                    }
+
+                    BeginDynamicRendering(cmd, passIdx, frameIdx, fullScreen);
+                    if (m_Options.parallelRecording)
+                    {
+                        ExecuteRecordedCommands(cmd, m_PassRecordingTaskOffsets[passIdx]);
+                    }
+                    else
+                    {
+                        vkCmdSetViewport(cmd, 0, 1, &vp);
+                        vkCmdSetScissor(cmd, 0, 1, &fullScreen);
+
+                        uint32_t rpIdx = renderData.mergedSubpassIndices[0];
+                        RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
+                        VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
+                        m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+                    }
+                    m_CmdEndRendering(cmd);
+
+                    for (auto& barrier : renderData.dynamic.endBarriers)
+                    {
+                        vkCmdPipelineBarrier(cmd, barrier.srcStage, barrier.dstStage,
+                            0, 0, NULL, 0, NULL,
+                            barrier.imageBarriers[frameIdx].size(), barrier.imageBarriers[frameIdx].data());
+                    }
+                }
+                else if (m_Options.parallelRecording || m_Options.imagelessFrameBuffer)
+                {
+                    VkRenderPassBeginInfo beginInfo{};
+                    beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                    beginInfo.renderPass = renderData.renderPass->GetRenderPass();
+                    beginInfo.framebuffer = frameBuffer;
+                    beginInfo.renderArea = fullScreen;
+                    beginInfo.clearValueCount = renderData.fbClearValues.size();
+                    beginInfo.pClearValues = renderData.fbClearValues.data();
+
+                    // imageless frame buffers get their views here
+                    VkRenderPassAttachmentBeginInfo attachmentBeginInfo{};
+                    attachmentBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_ATTACHMENT_BEGIN_INFO;
+                    attachmentBeginInfo.attachmentCount = m_RPFrameBuffers[passIdx].frameBufferViews[frameIdx].size();
+                    attachmentBeginInfo.pAttachments = m_RPFrameBuffers[passIdx].frameBufferViews[frameIdx].data();
+                    if (m_Options.imagelessFrameBuffer)
+                    {
+                        beginInfo.pNext = &attachmentBeginInfo;
+                    }
+
+                    VkSubpassContents contents = m_Options.parallelRecording ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+
+                    vkCmdBeginRenderPass(cmd, &beginInfo, contents);
+                    for (uint32_t i = 0; i < renderData.mergedSubpassIndices.size(); i++)
+                    {
+                        if (i != 0)
+                        {
+                            vkCmdNextSubpass(cmd, contents);
+                        }
+
+                        if (m_Options.parallelRecording)
+                        {
+                            ExecuteRecordedCommands(cmd, m_PassRecordingTaskOffsets[passIdx] + i);
+                        }
+                        else
+                        {
+                            vkCmdSetViewport(cmd, 0, 1, &vp);
+                            vkCmdSetScissor(cmd, 0, 1, &fullScreen);
+
+                            uint32_t rpIdx = renderData.mergedSubpassIndices[i];
+                            RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
+
+                            BeginGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
+                            VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
+                            m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+                            EndGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
+                        }
+                    }
+                    vkCmdEndRenderPass(cmd);
+                }
+                else if (renderData.mergedSubpassIndices.size() == 1)
                 {
                     renderData.renderPass->Begin(frameBuffer, renderData.fbClearValues.data(),
                         fullScreen, vp, fullScreen, cmd).Record(
@@ -2202,6 +2772,7 @@ namespace vkrg
                             {
                                 uint32_t rpIdx = renderData.mergedSubpassIndices[0];
                     RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
+                    VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
                     m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
                             }
                     );
@@ -2218,7 +2789,10 @@ namespace vkrg
                             uint32_t rpIdx = renderData.mergedSubpassIndices[i];
                             RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
 
+                            BeginGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
+                            VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
                             m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+                            EndGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
                         };
 
                         if (i == renderData.mergedSubpassIndices.size() - 1)
@@ -2231,6 +2805,12 @@ namespace vkrg
                         }
                     }
                 }
+
+                if (m_Options.pipelineStatistics)
+                {
+                    m_StatisticsProfiler.EndQuery(cmd, frameIdx, passIdx);
+                }
+                EndGpuScope(cmd, frameIdx, m_PassGpuScopes[passIdx]);
             }
             else
             {
@@ -2243,9 +2823,30 @@ namespace vkrg
                         barrier.imageBarriers[frameIdx].size(), barrier.imageBarriers[frameIdx].data());
                 }
 
+                // layout transitions of general passes are recorded before the pass, they still hold when the pass is skipped
                 uint32_t rpIdx = computeData.targetRenderPass;
-                RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
-                m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+                if (!m_EnabledRenderPasses[rpIdx]) continue;
+
+                BeginGpuScope(cmd, frameIdx, m_PassGpuScopes[passIdx]);
+                if (m_Options.pipelineStatistics)
+                {
+                    m_StatisticsProfiler.BeginQuery(cmd, frameIdx, passIdx);
+                }
+                if (m_Options.parallelRecording)
+                {
+                    ExecuteRecordedCommands(cmd, m_PassRecordingTaskOffsets[passIdx]);
+                }
+                else
+                {
+                    RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
+                    VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
+                    m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+                }
+                if (m_Options.pipelineStatistics)
+                {
+                    m_StatisticsProfiler.EndQuery(cmd, frameIdx, passIdx);
+                }
+                EndGpuScope(cmd, frameIdx, m_PassGpuScopes[passIdx]);
             }
         }
 
@@ -2263,6 +2864,165 @@ namespace vkrg
 
     }
 
+    void RenderGraph::EvaluateEnablePredicates(uint32_t frameIdx)
+    {
+        // culled passes are never recorded, their predicates are not called
+        for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+        {
+            m_EnabledRenderPasses[rpIdx] = !m_CulledRenderPasses[rpIdx] && m_RenderPassList[rpIdx].pass->IsEnabled(frameIdx);
+        }
+    }
+
+    void RenderGraph::ExecuteRecordedCommands(VkCommandBuffer cmd, uint32_t taskIdx)
+    {
+        // tasks of disabled passes leave no command buffer
+        VkCommandBuffer recorded = m_RecordingTasks[taskIdx].cmd;
+        if (recorded != NULL)
+        {
+            vkCmdExecuteCommands(cmd, 1, &recorded);
+        }
+    }
+
+    void RenderGraph::BeginDynamicRendering(VkCommandBuffer cmd, uint32_t passIdx, uint32_t frameIdx, VkRect2D renderArea)
+    {
+        auto& dynamic = m_renderGraphPassInfo[passIdx].render.dynamic;
+        auto& views = m_RPFrameBuffers[passIdx].frameBufferViews[frameIdx];
+
+        for (uint32_t i = 0; i < dynamic.colorAttachments.size(); i++)
+        {
+            dynamic.colorAttachments[i].imageView = views[dynamic.colorFBAttachmentIdx[i]];
+        }
+
+        VkRenderingInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        renderingInfo.flags = m_Options.parallelRecording ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
+        renderingInfo.renderArea = renderArea;
+        renderingInfo.layerCount = dynamic.layerCount;
+        renderingInfo.colorAttachmentCount = dynamic.colorAttachments.size();
+        renderingInfo.pColorAttachments = dynamic.colorAttachments.data();
+
+        if (dynamic.depthStencilFBAttachmentIdx != ImageFBAttachmentStatus::invalidIdx)
+        {
+            VkImageView depthStencilView = views[dynamic.depthStencilFBAttachmentIdx];
+            if (dynamic.formats.depthFormat != VK_FORMAT_UNDEFINED)
+            {
+                dynamic.depthAttachment.imageView = depthStencilView;
+                renderingInfo.pDepthAttachment = &dynamic.depthAttachment;
+            }
+            if (dynamic.formats.stencilFormat != VK_FORMAT_UNDEFINED)
+            {
+                dynamic.stencilAttachment.imageView = depthStencilView;
+                renderingInfo.pStencilAttachment = &dynamic.stencilAttachment;
+            }
+        }
+
+        m_CmdBeginRendering(cmd, &renderingInfo);
+    }
+
+    void RenderGraph::RecordCommandsInParallel(uint32_t frameIdx)
+    {
+        for (auto& worker : m_RecordingWorkers)
+        {
+            worker.usedCommandBufferCount[frameIdx] = 0;
+        }
+
+        m_RecordingJobSystem->Dispatch(m_RecordingTasks.size(),
+            [&](uint32_t taskIdx, uint32_t workerIdx)
+            {
+                RecordRenderPassCommands(taskIdx, workerIdx, frameIdx);
+            },
+            m_HasOrderedRecording ? &m_RecordingTaskSuccessors : nullptr);
+    }
+
+    void RenderGraph::RecordRenderPassCommands(uint32_t taskIdx, uint32_t workerIdx, uint32_t frameIdx)
+    {
+        VKRG_TRACE_SCOPE("RenderGraph::RecordRenderPassCommands");
+        auto& task = m_RecordingTasks[taskIdx];
+        auto& passInfo = m_renderGraphPassInfo[task.passInfoIdx];
+
+        uint32_t rpIdx = passInfo.IsGraphicsPass() ? passInfo.render.mergedSubpassIndices[task.subpassIdx] : passInfo.compute.targetRenderPass;
+        if (!m_EnabledRenderPasses[rpIdx])
+        {
+            task.cmd = NULL;
+            return;
+        }
+
+        VkCommandBuffer cmd = AcquireSecondaryCommandBuffer(workerIdx, frameIdx);
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        // queries of passes are active in the primary command buffer while secondary ones execute
+        inheritanceInfo.pipelineStatistics = m_Options.pipelineStatistics ? PipelineStatisticsProfiler::statisticFlags : 0;
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        // secondary command buffers executed inside dynamic rendering inherit attachment formats instead of a render pass
+        VkCommandBufferInheritanceRenderingInfoKHR renderingInheritanceInfo{};
+        renderingInheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+
+        if (passInfo.IsGraphicsPass() && passInfo.render.dynamicRendering)
+        {
+            auto& formats = passInfo.render.dynamic.formats;
+            renderingInheritanceInfo.colorAttachmentCount = formats.colorFormats.size();
+            renderingInheritanceInfo.pColorAttachmentFormats = formats.colorFormats.data();
+            renderingInheritanceInfo.depthAttachmentFormat = formats.depthFormat;
+            renderingInheritanceInfo.stencilAttachmentFormat = formats.stencilFormat;
+            renderingInheritanceInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+            inheritanceInfo.pNext = &renderingInheritanceInfo;
+            beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
+        else if (passInfo.IsGraphicsPass())
+        {
+            inheritanceInfo.renderPass = passInfo.render.renderPass->GetRenderPass();
+            inheritanceInfo.subpass = task.subpassIdx;
+            inheritanceInfo.framebuffer = m_RPFrameBuffers[task.passInfoIdx].frameBuffer[frameIdx];
+            beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        }
+
+        vkResetCommandBuffer(cmd, 0);
+        vkBeginCommandBuffer(cmd, &beginInfo);
+
+        // dynamic states are not inherited from the primary command buffer
+        if (passInfo.IsGraphicsPass())
+        {
+            auto [fullScreen, vp] = GetRenderArea(passInfo.render.expectedExtension);
+
+            vkCmdSetViewport(cmd, 0, 1, &vp);
+            vkCmdSetScissor(cmd, 0, 1, &fullScreen);
+        }
+
+        RenderPassRuntimeContext ctx(this, frameIdx, rpIdx);
+        BeginGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
+        VKRG_TRACE_SCOPE(m_RenderPassList[rpIdx].pass->GetName());
+        m_RenderPassList[rpIdx].pass->OnRender(ctx, cmd);
+        EndGpuScope(cmd, frameIdx, m_SubpassGpuScopes[rpIdx]);
+
+        vkEndCommandBuffer(cmd);
+
+        task.cmd = cmd;
+    }
+
+    VkCommandBuffer RenderGraph::AcquireSecondaryCommandBuffer(uint32_t workerIdx, uint32_t frameIdx)
+    {
+        // command pools are not thread safe, a worker only allocates from its own pool
+        auto& worker = m_RecordingWorkers[workerIdx];
+        auto& commandBuffers = worker.commandBuffers[frameIdx];
+        uint32_t& usedCount = worker.usedCommandBufferCount[frameIdx];
+
+        if (usedCount == commandBuffers.size())
+        {
+            auto cmd = worker.commandPool->CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            vkrg_assert(cmd.has_value());
+            commandBuffers.push_back(cmd.value());
+        }
+
+        return commandBuffers[usedCount++];
+    }
+
     void RenderGraph::InitializeRPFrameBufferTable()
     {
         m_RPFrameBuffers.resize(m_renderGraphPassInfo.size());
@@ -2274,6 +3034,7 @@ namespace vkrg
                 {
                     m_RPFrameBuffers[i].frameBufferViews[fi].resize(m_renderGraphPassInfo[i].render.fbAttachmentIdx.size());
                 }
+                m_RPFrameBuffers[i].attachmentImages.resize(m_renderGraphPassInfo[i].render.fbAttachmentIdx.size());
             }
         }
     }
@@ -2290,6 +3051,146 @@ namespace vkrg
         }
     }
 
+    void RenderGraph::InitializeGpuProfiling()
+    {
+        m_PassGpuScopes.resize(m_renderGraphPassInfo.size(), invalidGpuScope);
+        m_SubpassGpuScopes.resize(m_RenderPassList.size(), invalidGpuScope);
+        if (!m_Options.gpuProfiling) return;
+
+        // a scope for every merged pass, and a scope for every subpass if the pass has more than one
+        for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+        {
+            auto& passInfo = m_renderGraphPassInfo[passIdx];
+            if (passInfo.IsGeneralPass())
+            {
+                m_PassGpuScopes[passIdx] = m_GpuProfiler.AddScope(GetPassInfoName(passIdx), 0);
+                continue;
+            }
+
+            m_PassGpuScopes[passIdx] = m_GpuProfiler.AddScope(GetPassInfoName(passIdx), 0);
+
+            if (passInfo.render.mergedSubpassIndices.size() == 1) continue;
+            for (auto rpIdx : passInfo.render.mergedSubpassIndices)
+            {
+                m_SubpassGpuScopes[rpIdx] = m_GpuProfiler.AddScope(m_RenderPassList[rpIdx].pass->GetName(), 1);
+            }
+        }
+
+        m_GpuProfiler.Initialize(m_vulkanContext.ctx, m_Options.flightFrameCount);
+    }
+
+    void RenderGraph::InitializePipelineStatistics()
+    {
+        if (!m_Options.pipelineStatistics) return;
+
+        for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+        {
+            m_StatisticsProfiler.AddQuery(GetPassInfoName(passIdx));
+        }
+
+        m_StatisticsProfiler.Initialize(m_vulkanContext.ctx, m_Options.flightFrameCount);
+    }
+
+    uint32_t RenderGraph::GetPassInfoCount()
+    {
+        vkrg_assert(m_HaveCompiled);
+        return m_renderGraphPassInfo.size();
+    }
+
+    std::string RenderGraph::GetPassInfoName(uint32_t passIdx)
+    {
+        auto& passInfo = m_renderGraphPassInfo[passIdx];
+        if (passInfo.IsGeneralPass())
+        {
+            return m_RenderPassList[passInfo.compute.targetRenderPass].pass->GetName();
+        }
+
+        // merged passes are named after all of their subpasses
+        std::string name;
+        for (auto rpIdx : passInfo.render.mergedSubpassIndices)
+        {
+            name += name.empty() ? "" : " + ";
+            name += m_RenderPassList[rpIdx].pass->GetName();
+        }
+        return name;
+    }
+
+    void RenderGraph::BeginGpuScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope)
+    {
+        if (scope == invalidGpuScope) return;
+        m_GpuProfiler.BeginScope(cmd, frameIdx, scope);
+    }
+
+    void RenderGraph::EndGpuScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope)
+    {
+        if (scope == invalidGpuScope) return;
+        m_GpuProfiler.EndScope(cmd, frameIdx, scope);
+    }
+
+    void RenderGraph::InitializeParallelRecording()
+    {
+        if (!m_Options.parallelRecording) return;
+
+        uint32_t workerCount = m_Options.recordingThreadCount;
+        if (workerCount == 0)
+        {
+            workerCount = vkrg_max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        m_RecordingJobSystem = std::make_shared<JobSystem>(workerCount);
+        m_RecordingWorkers.resize(m_RecordingJobSystem->WorkerCount());
+        for (auto& worker : m_RecordingWorkers)
+        {
+            auto pool = m_vulkanContext.ctx->CreateCommandPool(m_vulkanContext.queue.get());
+            vkrg_assert(pool.has_value());
+            worker.commandPool = pool.value();
+
+            for (uint32_t frameIdx = 0; frameIdx < maxFrameOnFlightCount; frameIdx++)
+            {
+                worker.usedCommandBufferCount[frameIdx] = 0;
+            }
+        }
+
+        // tasks are stored in the same order GenerateCommands consumes them
+        std::vector<uint32_t> renderPassTask(m_RenderPassList.size(), 0xffffffff);
+        for (uint32_t passIdx = 0; passIdx < m_renderGraphPassInfo.size(); passIdx++)
+        {
+            auto& passInfo = m_renderGraphPassInfo[passIdx];
+            m_PassRecordingTaskOffsets.push_back(m_RecordingTasks.size());
+
+            if (passInfo.IsGraphicsPass())
+            {
+                for (uint32_t i = 0; i < passInfo.render.mergedSubpassIndices.size(); i++)
+                {
+                    renderPassTask[passInfo.render.mergedSubpassIndices[i]] = m_RecordingTasks.size();
+                    m_RecordingTasks.push_back(RecordingTask{ passIdx, i, NULL });
+                }
+            }
+            else
+            {
+                renderPassTask[passInfo.compute.targetRenderPass] = m_RecordingTasks.size();
+                m_RecordingTasks.push_back(RecordingTask{ passIdx, 0, NULL });
+            }
+        }
+
+        // passes requiring ordered recording wait for the recording of the passes they depend on
+        m_RecordingTaskSuccessors.resize(m_RecordingTasks.size());
+        for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+        {
+            if (renderPassTask[rpIdx] == 0xffffffff || !m_RenderPassList[rpIdx].pass->RequireOrderedRecording()) continue;
+
+            for (DAGAdjNode dependingPassNode = m_Graph.IterateAdjucentIn(m_RenderPassNodeList[rpIdx]); !dependingPassNode.IsEnd();
+                dependingPassNode++)
+            {
+                uint32_t dependingTask = renderPassTask[dependingPassNode.CaseToNode()->idx];
+                if (dependingTask == 0xffffffff) continue;
+
+                m_RecordingTaskSuccessors[dependingTask].push_back(renderPassTask[rpIdx]);
+                m_HasOrderedRecording = true;
+            }
+        }
+    }
+
     void RenderGraph::ClearCompileCache()
     {
         // m_Graph.Clear();
@@ -2301,11 +3202,58 @@ namespace vkrg
 
     void RenderGraph::PostCompile()
     {
+        VKRG_TRACE_SCOPE("RenderGraph::PostCompile");
         m_PhysicalResourceBindings.resize(m_PhysicalResources.size());
         m_ExternalResourceBindings.resize(m_ExternalResources.size());
 
+        // external resources are not bound yet, validate them in the first frame
+        m_DirtyPhysicalResources.Resize(m_PhysicalResources.size());
+        m_DirtyExternalResources.Resize(m_ExternalResources.size());
+        m_DirtyExternalResources.SetAll();
+
+        // render passes adopted from a reloaded graph are dropped if this graph didn't acquire them
+        m_RenderPassCache.EvictUnused();
+
+        // every external resource could rotate through swapchain images while older ones are still used by frames on flight
+        uint32_t cacheCapacity = (m_Options.swapchainImageCount + m_Options.flightFrameCount) * std::max((uint32_t)m_ExternalResources.size(), 1u);
+        m_ImageViewCache.Initialize(m_vulkanContext.ctx, m_Options.flightFrameCount, cacheCapacity);
+        m_FrameBufferCache.Initialize(m_vulkanContext.ctx, m_Options.flightFrameCount, cacheCapacity, &m_ImageViewCache);
+        m_ImagePool.Initialize(m_vulkanContext.ctx, m_Options.flightFrameCount, m_Options.imagePoolCapacity);
+        for (auto& [image, imageCI] : m_AdoptedImages)
+        {
+            m_ImagePool.Adopt(image, imageCI);
+        }
+        m_AdoptedImages.clear();
+
+        m_EnabledRenderPasses.assign(m_RenderPassList.size(), 1);
+
+        // extents queried before the first frame use the render scale set before compiling
+        m_FrameRenderScale = m_RenderScale;
+
+        m_NativeResolutionResources.assign(m_LogicalResourceList.size(), false);
+        for (auto& resource : m_LogicalResourceList)
+        {
+            m_NativeResolutionResources[resource.handle.idx] = resource.handle.external;
+        }
+        for (uint32_t rpIdx = 0; rpIdx < m_RenderPassList.size(); rpIdx++)
+        {
+            RenderPass* pass = m_RenderPassList[rpIdx].pass.get();
+            if (m_CulledRenderPasses[rpIdx] || !pass->GetRenderPassExtension().nativeResolution) continue;
+
+            for (uint32_t i = 0; i < pass->GetAttachments().size(); i++)
+            {
+                if (pass->GetAttachments()[i].WriteToResource())
+                {
+                    m_NativeResolutionResources[pass->GetAttachedResourceHandles()[i].idx] = true;
+                }
+            }
+        }
+
         InitializeRPFrameBufferTable();
         InitializeRenderPassViewTable();
+        InitializeParallelRecording();
+        InitializeGpuProfiling();
+        InitializePipelineStatistics();
         ResizePhysicalResources();
         ClearCompileCache();
     }
@@ -2320,11 +3268,116 @@ namespace vkrg
     }
 
 
-    uint32_t RenderGraph::ScoreMergedNode(DAGMergedNode node)
+    int64_t RenderGraph::ScoreMergedNode(DAGMergedNode candidate, DAGNode node)
+    {
+        // passes in a merged node share the same render area, so bandwidth is compared in bytes per pixel
+        auto isFramebufferAttachment = [](const RenderPassAttachment& attachment)
+        {
+            return attachment.type == RenderPassAttachment::ImageColorOutput || attachment.type == RenderPassAttachment::ImageColorInput
+                || attachment.type == RenderPassAttachment::ImageDepthOutput || attachment.type == RenderPassAttachment::ImageDepthInput
+                || attachment.type == RenderPassAttachment::ImageColorInputOutput;
+        };
+
+        auto pixelBytes = [&](const RenderPassAttachment& attachment, uint32_t resourceIdx)
+        {
+            int64_t layers = attachment.range.imageRange.layerCount == VK_REMAINING_ARRAY_LAYERS ? 1 : attachment.range.imageRange.layerCount;
+            return (int64_t)GetFormatTexelSize(m_LogicalResourceList[resourceIdx].info.format) * layers;
+        };
+
+        auto inCandidate = [&](uint32_t passIdx)
+        {
+            for (auto& pass : candidate->renderPasses)
+            {
+                if (pass->idx == passIdx) return true;
+            }
+            return false;
+        };
+
+        std::vector<uint32_t> candidateResources;
+        for (auto& pass : candidate->renderPasses)
+        {
+            auto& attachments = pass->pass->GetAttachments();
+            auto& handles = pass->pass->GetAttachedResourceHandles();
+            for (uint32_t i = 0; i < attachments.size(); i++)
+            {
+                if (isFramebufferAttachment(attachments[i])) PushBackNotRepeatedElement(candidateResources, GetRootResourceVersion(handles[i].idx));
+            }
+        }
+
+        // content of the candidate's attachments read by the pass stays on chip instead of being stored and loaded again.
+        // outputs continuing a candidate's attachment only save the store, the load depends on the interface
+        auto savedBytes = [&](DAGNode pass)
+        {
+            int64_t bytes = 0;
+            auto& attachments = pass->pass->GetAttachments();
+            auto& handles = pass->pass->GetAttachedResourceHandles();
+            for (uint32_t i = 0; i < attachments.size(); i++)
+            {
+                uint32_t resourceIdx = GetRootResourceVersion(handles[i].idx);
+                if (!isFramebufferAttachment(attachments[i])
+                    || std::find(candidateResources.begin(), candidateResources.end(), resourceIdx) == candidateResources.end())
+                {
+                    continue;
+                }
+
+                bool readContent = attachments[i].type == RenderPassAttachment::ImageColorInput || attachments[i].type == RenderPassAttachment::ImageDepthInput
+                    || attachments[i].type == RenderPassAttachment::ImageColorInputOutput;
+                bytes += pixelBytes(attachments[i], resourceIdx) * (readContent ? 2 : 1);
+            }
+            return bytes;
+        };
+
+        int64_t score = savedBytes(node);
+
+        // passes after this one can only join the candidate if this pass joins it first, otherwise they would form a cycle
+        for (DAGAdjNode outNode = m_Graph.IterateAdjucentOut(node); !outNode.IsEnd(); outNode++)
+        {
+            DAGNode successor = outNode.CaseToNode();
+            if (m_CulledRenderPasses[successor->idx] || successor->pass->GetType() != RenderPassType::Graphics || successor->pass->IsConditional()
+                || !(successor->pass->GetRenderPassExtension() == node->pass->GetRenderPassExtension()))
+            {
+                continue;
+            }
+            score += savedBytes(successor);
+        }
+
+        // attachments of the candidate not used by this pass or any pass after the candidate are dead,
+        // merging keeps them alive through this subpass and they can't be aliased by other resources
+        std::vector<uint32_t> deadResources;
+        for (auto& pass : candidate->renderPasses)
+        {
+            auto& attachments = pass->pass->GetAttachments();
+            auto& handles = pass->pass->GetAttachedResourceHandles();
+            for (uint32_t i = 0; i < attachments.size(); i++)
+            {
+                uint32_t resourceIdx = GetRootResourceVersion(handles[i].idx);
+                if (!isFramebufferAttachment(attachments[i]) || !attachments[i].WriteToResource() || handles[i].external) continue;
+
+                bool dead = true;
+                for (uint32_t version = resourceIdx; dead && version != invalidIdx; version = m_LogicalResourceIODenpendencies[version].nextVersion)
+                {
+                    auto& io = m_LogicalResourceIODenpendencies[version];
+                    for (auto passIdx : io.resourceReadList) dead = dead && inCandidate(passIdx);
+                    for (auto passIdx : io.resourceWriteList) dead = dead && inCandidate(passIdx);
+                }
+                if (dead && std::find(deadResources.begin(), deadResources.end(), resourceIdx) == deadResources.end())
+                {
+                    deadResources.push_back(resourceIdx);
+                    score -= pixelBytes(attachments[i], resourceIdx);
+                }
+            }
+        }
+
+        return score;
+    }
+
+    uint32_t RenderGraph::GetRootResourceVersion(uint32_t idx)
     {
-        // try to merge all node to one big node;
-        // so the node merged with more nodes the better it is
-        return node->renderPasses.size();
+        while (m_LogicalResourceIODenpendencies[idx].previousVersion != invalidIdx)
+        {
+            idx = m_LogicalResourceIODenpendencies[idx].previousVersion;
+        }
+        return idx;
     }
 
     RenderGraph::DAGMergedNode RenderGraph::CreateNewMergedNode(DAGNode node, bool mergable)
@@ -2444,6 +3497,38 @@ namespace vkrg
         return std::make_tuple(w, h, d);
     }
 
+    tpl<uint32_t, uint32_t, uint32_t> RenderGraph::GetRenderExtension(ResourceInfo::Extension ext, ResourceExtensionType type, bool nativeResolution)
+    {
+        auto [w, h, d] = GetExpectedExtension(ext, type);
+        if (type == ResourceExtensionType::Screen && !nativeResolution)
+        {
+            w = vkrg_max((uint32_t)(w * m_FrameRenderScale), 1u);
+            h = vkrg_max((uint32_t)(h * m_FrameRenderScale), 1u);
+        }
+        return std::make_tuple(w, h, d);
+    }
+
+    tpl<VkRect2D, VkViewport> RenderGraph::GetRenderArea(const RenderPassExtension& ext)
+    {
+        auto [w, h, _] = GetRenderExtension(ext.extension, ext.extensionType, ext.nativeResolution);
+
+        VkRect2D fullScreen;
+        fullScreen.extent.width = w;
+        fullScreen.extent.height = h;
+        fullScreen.offset.x = 0;
+        fullScreen.offset.y = 0;
+
+        VkViewport vp;
+        vp.height = h;
+        vp.width = w;
+        vp.x = 0;
+        vp.y = 0;
+        vp.minDepth = 0;
+        vp.maxDepth = 1;
+
+        return std::make_tuple(fullScreen, vp);
+    }
+
     uint32_t RenderGraph::GetRenderGraphPassInfoIndex(DAGMergedNode node)
     {
         for (uint32_t i = 0; i < m_renderGraphPassInfo.size(); i++)
@@ -2518,6 +3603,12 @@ namespace vkrg
             return false;
         }
 
+        // graphs compiled without a device, like the ones only checked by tests, can't query format features
+        if (m_vulkanContext.ctx == nullptr)
+        {
+            return true;
+        }
+
         VkFormatProperties properties;
         if (m_FormatCompabilityCache.initialized[format])
         {
@@ -2582,6 +3673,17 @@ namespace vkrg
         return nullptr;
     }
 
+    bool RenderGraph::IsResourceBindingDirty(bool external, uint32_t idx)
+    {
+        return external ? m_DirtyExternalResources.Test(idx) : m_DirtyPhysicalResources.Test(idx);
+    }
+
+    bool RenderGraph::AnyResourceBindingDirty()
+    {
+        return m_DirtyExternalResources.Any() || m_DirtyPhysicalResources.Any();
+    }
+
+
     bool RenderGraph::SubresourceCompability(RenderPassAttachment& lhs, RenderPassAttachment& rhs)
     {
         if (lhs.type != rhs.type) return false;
@@ -2645,12 +3747,12 @@ namespace vkrg
     {}
 
     RenderGraphScope::RenderGraphScope(const RenderGraphScope& other)
-        :name(name), graph(graph)
+        :name(other.name), graph(other.graph)
     {}
 
     opt<ResourceHandle> RenderGraphScope::FindGraphResource(const char* name)
     {
-        return graph->FindGraphResource(GetScopeName(name).c_str());
+        return graph->FindGraphResource(GetScopeName(name));
     }
 
     opt<ResourceHandle> RenderGraphScope::GetGraphResource(uint32_t idx)
@@ -2660,7 +3762,7 @@ namespace vkrg
 
     opt<RenderPassHandle> RenderGraphScope::FindGraphRenderPass(const char* name)
     {
-        return graph->FindGraphRenderPass(GetScopeName(name).c_str());
+        return graph->FindGraphRenderPass(GetScopeName(name));
     }
 
     opt<RenderPassHandle> RenderGraphScope::GetGraphRenderPass(uint32_t idx)
@@ -2683,22 +3785,29 @@ namespace vkrg
         return graph->Scope(GetScopeName(name).c_str());
     }
 
-    std::string RenderGraphScope::GetScopeName(const char* name)
+    const std::string& RenderGraphScope::GetScopeName(const char* name)
     {
-        return this->name + "." + name;
+        scopedName.assign(this->name);
+        scopedName.push_back('.');
+        scopedName.append(name);
+        return scopedName;
     }
 
     bool RenderGraphDataFrame::BindBuffer(const char* name, uint32_t frameIdx, ptr<gvk::Buffer> buffer)
+    {
+        auto resOpt = m_Graph->FindGraphResource(name);
+        return resOpt.has_value() && BindBuffer(resOpt.value(), frameIdx, buffer);
+    }
+
+    bool RenderGraphDataFrame::BindBuffer(ResourceHandle handle, uint32_t frameIdx, ptr<gvk::Buffer> buffer)
     {
         vkrg_assert(m_Graph->m_HaveCompiled);
         if (frameIdx >= m_FlightFrameCount) return false;
 
         RenderGraph::ResourceAssignment assign;
-        auto resOpt = m_Graph->FindGraphResource(name);
-
-        if (resOpt.has_value() && m_Graph->m_LogicalResourceList[resOpt.value().idx].info.IsBuffer())
+        if (handle.idx < m_Graph->m_LogicalResourceList.size() && m_Graph->m_LogicalResourceList[handle.idx].info.IsBuffer())
         {
-            assign = m_Graph->m_LogicalResourceAssignmentTable[resOpt.value().idx];
+            assign = m_Graph->m_LogicalResourceAssignmentTable[handle.idx];
         }
         else
         {
@@ -2707,23 +3816,30 @@ namespace vkrg
 
         if (assign.Invalid() || (assign.external && m_Target != External) || (!assign.external && m_Target != Physical)) return false;
 
+        // rebinding the bound buffer keeps views and barriers of the resource
+        if (m_Graph->m_ExternalResourceBindings[assign.idx].buffers[frameIdx] == buffer) return true;
+
         m_Graph->m_ExternalResourceBindings[assign.idx].buffers[frameIdx] = buffer;
-        m_Graph->m_ExternalResourceBindings[assign.idx].dirtyFlag = true;
+        m_Graph->m_DirtyExternalResources.Set(assign.idx);
 
         return true;
     }
 
     bool RenderGraphDataFrame::BindImage(const char* name, uint32_t frameIdx, ptr<gvk::Image> image)
+    {
+        auto resOpt = m_Graph->FindGraphResource(name);
+        return resOpt.has_value() && BindImage(resOpt.value(), frameIdx, image);
+    }
+
+    bool RenderGraphDataFrame::BindImage(ResourceHandle handle, uint32_t frameIdx, ptr<gvk::Image> image)
     {
         vkrg_assert(m_Graph->m_HaveCompiled);
         if (frameIdx >= m_FlightFrameCount) return false;
 
         RenderGraph::ResourceAssignment assign;
-        auto resOpt = m_Graph->FindGraphResource(name);
-
-        if (resOpt.has_value() && m_Graph->m_LogicalResourceList[resOpt.value().idx].info.IsImage())
+        if (handle.idx < m_Graph->m_LogicalResourceList.size() && m_Graph->m_LogicalResourceList[handle.idx].info.IsImage())
         {
-            assign = m_Graph->m_LogicalResourceAssignmentTable[resOpt.value().idx];
+            assign = m_Graph->m_LogicalResourceAssignmentTable[handle.idx];
         }
         else
         {
@@ -2732,9 +3848,12 @@ namespace vkrg
 
         if (assign.Invalid() || (assign.external && m_Target != External) || (!assign.external && m_Target != Physical)) return false;
 
+        // rebinding the bound image keeps views, frame buffers and barriers of the resource
+        if (m_Graph->m_ExternalResourceBindings[assign.idx].images[frameIdx] == image) return true;
+
         GvkImageCreateInfo info = image->Info();
         // check image info's compatibilty
-        GvkImageCreateInfo expectedInfo = m_Graph->CreateImageCreateInfo(m_Graph->m_LogicalResourceList[resOpt.value().idx].info);
+        GvkImageCreateInfo expectedInfo = m_Graph->CreateImageCreateInfo(m_Graph->m_LogicalResourceList[handle.idx].info);
 
         if (info.arrayLayers != expectedInfo.arrayLayers ||
             info.extent.width != expectedInfo.extent.width ||
@@ -2751,7 +3870,7 @@ namespace vkrg
         }
 
         m_Graph->m_ExternalResourceBindings[assign.idx].images[frameIdx] = image;
-        m_Graph->m_ExternalResourceBindings[assign.idx].dirtyFlag = true;
+        m_Graph->m_DirtyExternalResources.Set(assign.idx);
         return true;
     }
 
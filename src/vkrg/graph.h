@@ -2,6 +2,11 @@
 #include "vkrg/common.h"
 #include "vkrg/pass.h"
 #include "vkrg/dag.h"
+#include "vkrg/job.h"
+#include "vkrg/bitset.h"
+#include "vkrg/cache.h"
+#include "vkrg/profiler.h"
+#include "vkrg/loader.h"
 
 namespace vkrg
 {
@@ -10,7 +15,6 @@ namespace vkrg
 		Success,
 		Error_RenderPassValidation,
 		Error_CycleInGraph,
-		Error_WriteAfterWrite,
 		Error_FailToCreateRenderPass,
 		Error_CompileTwice,
 		Error_InvalidCompileOption
@@ -28,6 +32,14 @@ namespace vkrg
 		MergeGraphicsPasses
 	};
 
+	enum class RenderGraphSchedulePolicy
+	{
+		// plain topological order
+		Kahn,
+		// move producers earlier and consumers later, so that barriers between them
+		// are separated by independent passes
+		OverlapAware
+	};
 
 	struct RenderGraphCompileOptions
 	{
@@ -40,6 +52,17 @@ namespace vkrg
 			setDebugName = false;
 			screenWidth = 0;
 			screenHeight = 0;
+			schedulePolicy = RenderGraphSchedulePolicy::Kahn;
+			maxLifetimeExtension = 4;
+			cullUnreachablePasses = false;
+			parallelRecording = false;
+			recordingThreadCount = 0;
+			imagelessFrameBuffer = false;
+			dynamicRendering = false;
+			imagePoolCapacity = 16;
+			swapchainImageCount = 3;
+			gpuProfiling = false;
+			pipelineStatistics = false;
 		}
 
 		uint32_t				   flightFrameCount = 3;
@@ -52,6 +75,96 @@ namespace vkrg
 
 		bool					   disableFrameOnFlight;
 		bool					   setDebugName;
+
+		RenderGraphSchedulePolicy  schedulePolicy;
+		// how many passes could overlap aware scheduling extend a resource's lifetime by
+		uint32_t				   maxLifetimeExtension;
+
+		// passes whose outputs never reach an external resource or a resource kept to next frame will be removed,
+		// see RenderGraph::GetCulledRenderPasses. off by default, passes might write resources read outside of the graph
+		bool					   cullUnreachablePasses;
+
+		// record every pass to a secondary command buffer on worker threads of a work stealing job system
+		// requires RenderGraphDeviceContext::queue
+		bool					   parallelRecording;
+		// 0 means using all hardware threads
+		uint32_t				   recordingThreadCount;
+
+		// create one frame buffer per render pass and provide views when render pass begins
+		// requires VK_KHR_imageless_framebuffer (core in vulkan 1.2) to be enabled by application
+		bool					   imagelessFrameBuffer;
+
+		// graphics passes which are not merged with others are recorded with vkCmdBeginRenderingKHR,
+		// no render pass or frame buffer is created for them. passes with input attachments still use render passes
+		// requires VK_KHR_dynamic_rendering (core in vulkan 1.3) to be enabled by application
+		bool					   dynamicRendering;
+
+		// how many images released by resizing are kept for reusing
+		uint32_t				   imagePoolCapacity;
+
+		// external images usually rotate through swapchain images, views and frame buffers of
+		// this many images per external resource are kept after being released
+		uint32_t				   swapchainImageCount;
+
+		// write timestamps around every merged pass and every subpass of merged passes
+		bool					   gpuProfiling;
+
+		// pipeline statistics queries around every merged pass and compute pass
+		// requires pipelineStatisticsQuery feature, and inheritedQueries feature with parallelRecording
+		bool					   pipelineStatistics;
+	};
+
+	// formats of a pass recorded with dynamic rendering, used to fill VkPipelineRenderingCreateInfoKHR
+	struct RenderGraphRenderingFormats
+	{
+		std::vector<VkFormat> colorFormats;
+		VkFormat			  depthFormat = VK_FORMAT_UNDEFINED;
+		VkFormat			  stencilFormat = VK_FORMAT_UNDEFINED;
+	};
+
+	// memory traffic of attachments estimated from formats, render area and load/store operations,
+	// clearing or discarding an attachment moves no memory. compute passes have no attachment traffic
+	struct RenderGraphPassBandwidth
+	{
+		std::string name;
+		uint64_t	loadBytes = 0;
+		uint64_t	storeBytes = 0;
+	};
+
+	// passes and resources are matched by name, render passes, images and buffers are counted after compiling the reloaded graph
+	struct RenderGraphReloadStatistics
+	{
+		uint32_t addedPassCount = 0;
+		uint32_t removedPassCount = 0;
+		uint32_t changedPassCount = 0;
+		uint32_t addedResourceCount = 0;
+		uint32_t removedResourceCount = 0;
+		// resources whose ResourceInfo, external flag or final layout changed
+		uint32_t changedResourceCount = 0;
+
+		uint32_t createdRenderPassCount = 0;
+		uint32_t reusedRenderPassCount = 0;
+		// render passes of the live graph the new graph doesn't use
+		uint32_t releasedRenderPassCount = 0;
+		uint32_t createdImageCount = 0;
+		uint32_t reusedImageCount = 0;
+		uint32_t createdBufferCount = 0;
+		uint32_t reusedBufferCount = 0;
+
+		// loading includes parsing and building the graph
+		float	 loadMilliseconds = 0;
+		float	 compileMilliseconds = 0;
+	};
+
+	// distances are counted in merged passes between a producer and its consumer
+	struct RenderGraphScheduleStatistics
+	{
+		uint32_t edgeCount = 0;
+		// edges whose consumer is executed right after its producer
+		uint32_t adjacentEdgeCount = 0;
+		uint32_t minBarrierDistance = 0;
+		uint32_t maxBarrierDistance = 0;
+		float	 averageBarrierDistance = 0.f;
 	};
 
 
@@ -67,6 +180,8 @@ namespace vkrg
 		ResourceHandle handle;
 		ResourceInfo   info;
 		VkImageLayout  finalLayout;
+		// resources written by more than one pass are split into versions while compiling, version 0 is the declared resource
+		uint32_t	   version = 0;
 	};
 
 
@@ -79,6 +194,8 @@ namespace vkrg
 	struct RenderGraphDeviceContext
 	{
 		ptr<gvk::Context> ctx;
+		// command pools for parallel recording are created from this queue
+		ptr<gvk::CommandQueue> queue;
 	};
 
 	class RenderGraphScope
@@ -99,9 +216,12 @@ namespace vkrg
 		RenderGraphScope      Scope(const char* name);
 
 	private:
-		std::string GetScopeName(const char* name);
+		// the returned name is valid until the next call
+		const std::string& GetScopeName(const char* name);
 
 		std::string name;
+		// "name." followed by the last scoped name, reused to avoid allocating for every lookup
+		std::string scopedName;
 		RenderGraph* graph;
 	};
 
@@ -115,6 +235,11 @@ namespace vkrg
 
 		bool BindImage(const char* name, uint32_t frameIdx, ptr<gvk::Image> image);
 
+		// handles could be found once after compiling, binding by handles doesn't look up names every frame
+		bool BindBuffer(ResourceHandle handle, uint32_t frameIdx, ptr<gvk::Buffer> buffer);
+
+		bool BindImage(ResourceHandle handle, uint32_t frameIdx, ptr<gvk::Image> image);
+
 	private:
 
 		enum Target
@@ -160,10 +285,26 @@ namespace vkrg
 	public:
 		RenderGraph();
 
-		opt<ResourceHandle>	  FindGraphResource(const char* name);
+		// prototypes of passes in the document should be registered to RenderPassPrototypeRegistry::Global() before loading
+		static opt<ptr<RenderGraph>> LoadFromJson(const char* path, std::string* msg = NULL);
+		static opt<ptr<RenderGraph>> LoadFromJsonString(std::string_view json, std::string* msg = NULL);
+		// binary graph files are mapped read only, see ConvertGraphJsonToBinary
+		static opt<ptr<RenderGraph>> LoadFromBinary(const char* path, std::string* msg = NULL);
+		// data should be 8 bytes aligned
+		static opt<ptr<RenderGraph>> LoadFromBinaryMemory(const void* data, size_t size, std::string* msg = NULL);
+
+		// compiles a new graph with the options and device of this compiled graph. render passes, images and buffers of this graph
+		// are reused by the new graph if their descriptions are unchanged. the device should be idle, this graph shouldn't be
+		// executed after reloading and external resources should be bound to the new graph again. see RenderGraphFileWatcher
+		opt<ptr<RenderGraph>> ReloadFromJson(const char* path, std::string* msg = NULL, RenderGraphReloadStatistics* statistics = NULL);
+		opt<ptr<RenderGraph>> ReloadFromJsonString(std::string_view json, std::string* msg = NULL, RenderGraphReloadStatistics* statistics = NULL);
+		opt<ptr<RenderGraph>> ReloadFromBinary(const char* path, std::string* msg = NULL, RenderGraphReloadStatistics* statistics = NULL);
+
+		// names are looked up by their hashes, literals could be hashed at compile time by constexpr HashedName
+		opt<ResourceHandle>	  FindGraphResource(HashedName name);
 		opt<ResourceHandle>   GetGraphResource(uint32_t idx);
 
-		opt<RenderPassHandle> FindGraphRenderPass(const char* name);
+		opt<RenderPassHandle> FindGraphRenderPass(HashedName name);
 		opt<RenderPassHandle> GetGraphRenderPass(uint32_t idx);
 
 		opt<ResourceHandle>	  AddGraphResource(const char* name, ResourceInfo info, bool external, VkImageLayout expectedFinalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
@@ -176,26 +317,81 @@ namespace vkrg
 		RenderGraphScope	  Scope(const char* name);
 
 		ResourceInfo		  GetResourceInfo(ResourceHandle handle);
+		// resources written by more than one pass are split into versions while compiling, version 0 is the declared resource
+		uint32_t			  GetResourceVersion(ResourceHandle handle);
 
+		// screen relative images are allocated with width and height rounded up to a size class,
+		// resizing within the size class keeps the images and images released by resizing are pooled for reusing
 		void				  OnResize(uint32_t width, uint32_t height);
 
+		// screen relative resources are allocated at the screen size set by compile options or OnResize,
+		// passes writing them render to a region scaled by render scale. changing it never reallocates resources.
+		// passes writing external resources or set to native resolution are not scaled
+		// scale is clamped to (0, 1] and takes effect from the next Execute
+		void				  SetRenderScale(float scale);
+		float				  GetRenderScale();
+
 		tpl<RenderGraphRuntimeState, std::string>	Execute(uint32_t targetFrameIdx, VkCommandBuffer mainCmdBuffer);
+		// render pass is null if the pass is culled or recorded with dynamic rendering
 		tpl<gvk::ptr<gvk::RenderPass>, uint32_t>    GetCompiledRenderPassAndSubpass(RenderPassHandle handle);
+		// returns nothing if the pass is culled or not recorded with dynamic rendering
+		opt<RenderGraphRenderingFormats>			GetCompiledRenderingFormats(RenderPassHandle handle);
 
 		RenderGraphDataFrame  GetExternalDataFrame();
 
+		const RenderGraphScheduleStatistics& GetScheduleStatistics();
+		const ImageViewCacheStatistics&		 GetImageViewCacheStatistics();
+		const FrameBufferCacheStatistics&	 GetFrameBufferCacheStatistics();
+		const ImagePoolStatistics&			 GetImagePoolStatistics();
+		const RenderPassCacheStatistics&	 GetRenderPassCacheStatistics();
+
+		// timings of the last frame executed on this frame index before current one, in schedule order
+		// requires RenderGraphCompileOptions::gpuProfiling
+		const std::vector<GpuTiming>&		 GetGpuTimings(uint32_t frameIdx);
+		// statistics of every merged pass and compute pass in schedule order, resolved the same way as timings
+		// requires RenderGraphCompileOptions::pipelineStatistics
+		const std::vector<GpuPipelineStatistics>& GetPipelineStatistics(uint32_t frameIdx);
+		// estimates of every merged pass and compute pass in schedule order at current extent and render scale
+		std::vector<RenderGraphPassBandwidth> EstimatePassBandwidth();
+
+		// compiled graph for debugging: merged passes, resource edges, physical resources, lifetimes and barriers,
+		// gpu timings of the frame index are included if RenderGraphCompileOptions::gpuProfiling is enabled
+		void				  ExportGraphviz(std::ostream& os, uint32_t frameIdx = 0);
+		void				  ExportJson(std::ostream& os, uint32_t frameIdx = 0);
+
+		// culled render passes won't be executed and have no compiled render pass
+		bool				  IsRenderPassCulled(RenderPassHandle handle);
+		// in the order of being added, resources only accessed by culled passes are never allocated
+		std::vector<RenderPassHandle> GetCulledRenderPasses();
+
+		// compiled passes in execution order, a graphics pass contains the indices of all of its merged render passes
+		uint32_t			  GetPassInfoCount();
+		std::string			  GetPassInfoName(uint32_t passIdx);
+		std::vector<uint32_t> GetPassInfoRenderPasses(uint32_t passIdx);
+		// compute and ray tracing passes of the same dispatch group share the merged pass, their barriers are recorded together
+		uint32_t			  GetPassInfoMergedPass(uint32_t passIdx);
+
 	private:
 		static constexpr uint32_t invalidIdx = 0xffffffff;
 
+		static opt<ptr<RenderGraph>> BuildFromRecords(const GraphRecords& records, std::string* msg);
+
+		opt<ptr<RenderGraph>> Reload(opt<ptr<RenderGraph>> graph, std::chrono::steady_clock::time_point begin, std::string* msg, RenderGraphReloadStatistics* statistics);
+		void				  AdoptResources(RenderGraph& live);
+		void				  DiffRenderGraph(RenderGraph& live, RenderGraphReloadStatistics& statistics);
+
 		RenderGraphRuntimeState	ValidateResourceBinding(std::string& msg);
 
 		RenderGraphCompileState ValidateCompileOptions(std::string& msg);
 		RenderGraphCompileState ValidateRenderPasses(std::string& msg);
 		RenderGraphCompileState CollectedResourceDependencies(std::string& msg);
 		RenderGraphCompileState BuildGraph(std::string& msg);
+		RenderGraphCompileState CullUnreachablePasses(std::string& msg);
 
 		RenderGraphCompileState ScheduleMergedGraph(std::string& msg);
 		RenderGraphCompileState ScheduleOneByOneGraph(std::string& msg);
+		bool					SortMergedRenderPassGraph();
+		void					CollectScheduleStatistics();
 
 		RenderGraphCompileState AssignPhysicalResources(std::string& msg);
 		RenderGraphCompileState ResolveDependenciesAndCreateRenderPasses(std::string& msg);
@@ -205,12 +401,31 @@ namespace vkrg
 		void					ResizePhysicalResources();
 		void					UpdateDirtyViews();
 		void					UpdateDirtyFrameBuffersAndBarriers();
+		void					UpdateDirtyBarriers(std::vector<RenderGraphBarrier>& barriers);
 		void					ResetResourceBindingDirtyFlag();
+		void					EvaluateEnablePredicates(uint32_t frameIdx);
 		void					GenerateCommands(VkCommandBuffer cmd, uint32_t frameIdx);
+		void					BeginDynamicRendering(VkCommandBuffer cmd, uint32_t passIdx, uint32_t frameIdx, VkRect2D renderArea);
+		void					RecordCommandsInParallel(uint32_t frameIdx);
+		void					RecordRenderPassCommands(uint32_t taskIdx, uint32_t workerIdx, uint32_t frameIdx);
+		void					ExecuteRecordedCommands(VkCommandBuffer cmd, uint32_t taskIdx);
+		VkCommandBuffer			AcquireSecondaryCommandBuffer(uint32_t workerIdx, uint32_t frameIdx);
 
 
 		void					InitializeRPFrameBufferTable();
 		void					InitializeRenderPassViewTable();
+		void					InitializeParallelRecording();
+		void					InitializeGpuProfiling();
+		void					InitializePipelineStatistics();
+
+		// used by exporting, see export.cpp
+		opt<double>				GetPassInfoGpuMilliseconds(uint32_t passIdx, uint32_t frameIdx);
+		// first and last pass info accessing every logical resource, invalidIdx if the resource is never accessed
+		std::vector<tpl<uint32_t, uint32_t>> CollectLogicalResourceLifetimes();
+		std::string				GetBarrierResourceName(RenderGraphBarrier::Handle handle);
+		void					ExportBarriersJson(std::ostream& os, const char* kind, std::vector<RenderGraphBarrier>& barriers, bool& first);
+		void					BeginGpuScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope);
+		void					EndGpuScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope);
 		void					ClearCompileCache();
 		void					PostCompile();
 
@@ -219,7 +434,8 @@ namespace vkrg
 
 		RenderGraphCompileOptions m_Options;
 
-		std::unordered_map<std::string, uint32_t> m_LogicalResourceTable;
+		// keyed by ids of names in NameInterner::Global()
+		std::unordered_map<uint32_t, uint32_t> m_LogicalResourceTable;
 		std::vector<LogicalResource> m_LogicalResourceList;
 
 		struct ExtraPassEdge
@@ -229,20 +445,28 @@ namespace vkrg
 		};
 
 		std::vector<ExtraPassEdge> m_ExtraPassEdges;
-		std::unordered_map<std::string, uint32_t> m_RenderPassTable;
+		std::unordered_map<uint32_t, uint32_t> m_RenderPassTable;
 		std::vector<RenderPassHandle> m_RenderPassList;
 
 		using DAGNode = DirectionalGraph<RenderPassHandle>::NodeIterator;
 		using DAGAdjNode = DirectionalGraph<RenderPassHandle>::NodeAdjucentIterator;
 
 		std::vector<DAGNode> m_RenderPassNodeList;
+		std::vector<bool>	 m_CulledRenderPasses;
+		// enable predicates of passes evaluated once per frame, recording threads and GenerateCommands read them
+		std::vector<uint8_t> m_EnabledRenderPasses;
 
 		struct ResourceIO
 		{
 			std::vector<uint32_t> resourceWriteList;
 			std::vector<uint32_t> resourceReadList;
+			// versions of the same resource, they share one physical resource
+			uint32_t previousVersion = invalidIdx;
+			uint32_t nextVersion = invalidIdx;
 		};
 		std::vector<ResourceIO>	m_LogicalResourceIODenpendencies;
+		// the first version of a logical resource
+		uint32_t GetRootResourceVersion(uint32_t idx);
 
 		DirectionalGraph<RenderPassHandle>	m_Graph;
 
@@ -256,10 +480,13 @@ namespace vkrg
 		};
 
 		using DAGMergedNode = DirectionalGraph<MergedRenderPass>::NodeIterator;
+		using DAGMergedAdjNode = DirectionalGraph<MergedRenderPass>::NodeAdjucentIterator;
 
-		uint32_t			 ScoreMergedNode(DAGMergedNode node);
+		// bytes per pixel of framebuffer traffic saved by merging node to candidate, minus the cost of enlarged lifetimes
+		int64_t				 ScoreMergedNode(DAGMergedNode candidate, DAGNode node);
 
 		DirectionalGraph<MergedRenderPass>		   m_MergedRenderPassGraph;
+		RenderGraphScheduleStatistics			   m_ScheduleStatistics;
 		// std::vector<DAGMergedNode>				   m_MergedRenderPasses;
 
 		DAGMergedNode	   CreateNewMergedNode(DAGNode node, bool mergable);
@@ -273,6 +500,12 @@ namespace vkrg
 		DAGMergedNode FindFirstAccessedNodeForResource(uint32_t logicalResourceIdx);
 
 		tpl<uint32_t, uint32_t, uint32_t> GetExpectedExtension(ResourceInfo::Extension ext, ResourceExtensionType type);
+		// extension scaled by the render scale of current frame, used for render area, viewport and scissor
+		tpl<uint32_t, uint32_t, uint32_t> GetRenderExtension(ResourceInfo::Extension ext, ResourceExtensionType type, bool nativeResolution = false);
+		// render area of passes with the extension, it is also the scissor, and the viewport covering it
+		tpl<VkRect2D, VkViewport>		  GetRenderArea(const RenderPassExtension& ext);
+		// resources that are external or written by passes at native resolution, they are never rendered scaled
+		std::vector<bool>				  m_NativeResolutionResources;
 
 		uint32_t GetRenderGraphPassInfoIndex(DAGMergedNode node);
 
@@ -330,6 +563,10 @@ namespace vkrg
 				VkImageViewType      viewType;
 				ResourceAssignment assign;
 				ImageSlice		   subresource;
+
+				// bytes per texel moved by load and store operations, used by bandwidth estimation
+				uint32_t		   loadBytesPerTexel = 0;
+				uint32_t		   storeBytesPerTexel = 0;
 			};
 
 			// table records witch frame buffer does the logical resource attachmented to 
@@ -340,11 +577,33 @@ namespace vkrg
 				std::vector<uint32_t> mergedSubpassIndices;
 
 				std::vector<RenderGraphBarrier> bufferBarriers;
+				// barriers recorded instead of the render pass when the pass is disabled at runtime
+				std::vector<RenderGraphBarrier> skipBarriers;
 
 				std::vector<FBAttachment> fbAttachmentIdx;
 				std::vector<VkClearValue> fbClearValues;
 
 				RenderPassExtension expectedExtension;
+
+				// the pass is recorded with dynamic rendering, renderPass is null
+				bool dynamicRendering = false;
+				struct DynamicRendering
+				{
+					// image views are patched from frame buffer views before recording
+					std::vector<VkRenderingAttachmentInfoKHR> colorAttachments;
+					std::vector<uint32_t>					  colorFBAttachmentIdx;
+					VkRenderingAttachmentInfoKHR			  depthAttachment;
+					VkRenderingAttachmentInfoKHR			  stencilAttachment;
+					uint32_t								  depthStencilFBAttachmentIdx;
+					// layers rendered, every attachment has at least this many layers
+					uint32_t								  layerCount;
+
+					RenderGraphRenderingFormats				  formats;
+
+					// layout transitions a render pass would have done
+					std::vector<RenderGraphBarrier>			  beginBarriers;
+					std::vector<RenderGraphBarrier>			  endBarriers;
+				} dynamic;
 			} render;
 
 			uint32_t targetMergedPassIdx;
@@ -392,20 +651,81 @@ namespace vkrg
 		{
 			ptr<gvk::Buffer> buffers[maxFrameOnFlightCount];
 			ptr<gvk::Image>  images[maxFrameOnFlightCount];
-			bool			 dirtyFlag;
 		};
 		std::vector<ResourceBindingInfo> m_ExternalResourceBindings;
 		std::vector<ResourceBindingInfo> m_PhysicalResourceBindings;
+		// screen relative images released by resizing
+		ImagePool						 m_ImagePool;
+
+		// resources of the graph this graph is reloaded from, images are moved to the image pool when it is initialized,
+		// buffers are taken by physical resources with the same size and usages
+		std::vector<tpl<ptr<gvk::Image>, GvkImageCreateInfo>> m_AdoptedImages;
+		std::vector<tpl<ptr<gvk::Buffer>, ResourceInfo>>	 m_AdoptedBuffers;
+
+		float							 m_RenderScale = 1.f;
+		// render scale is fixed at the beginning of Execute, passes see the same scale in a frame
+		float							 m_FrameRenderScale = 1.f;
+
+		// bindings changed since last frame, set by data frames and resizing, cleared at end of every frame
+		DynamicBitset m_DirtyExternalResources;
+		DynamicBitset m_DirtyPhysicalResources;
+
+		// views of attachments and frame buffers are acquired from here, passes sharing a subresource share the view
+		ImageViewCache m_ImageViewCache;
 
 		ResourceBindingInfo* GetAssignedResourceBinding(ResourceAssignment assign);
+		bool				 IsResourceBindingDirty(bool external, uint32_t idx);
+		bool				 AnyResourceBindingDirty();
 
 		// list of frame buffers 
 		struct RPFrameBuffer
 		{
 			VkFramebuffer frameBuffer[maxFrameOnFlightCount];
 			std::vector<VkImageView> frameBufferViews[maxFrameOnFlightCount];
+			// only used by imageless frame buffers
+			std::vector<FrameBufferAttachmentImage> attachmentImages;
 		};
 		std::vector<RPFrameBuffer>    m_RPFrameBuffers;
+		// declared after the view cache, frame buffers are destroyed before the views they reference
+		FrameBufferCache			  m_FrameBufferCache;
+		RenderPassCache				  m_RenderPassCache;
+
+		// every worker owns a command pool, secondary command buffers are allocated lazily for every flight frame
+		struct RecordingWorker
+		{
+			ptr<gvk::CommandPool>		 commandPool;
+			std::vector<VkCommandBuffer> commandBuffers[maxFrameOnFlightCount];
+			uint32_t					 usedCommandBufferCount[maxFrameOnFlightCount];
+		};
+		std::vector<RecordingWorker>  m_RecordingWorkers;
+		ptr<JobSystem>				  m_RecordingJobSystem;
+
+		// one task for every subpass or general pass in schedule order, disabled passes leave cmd null
+		struct RecordingTask
+		{
+			uint32_t		passInfoIdx;
+			uint32_t		subpassIdx;
+			VkCommandBuffer cmd;
+		};
+		std::vector<RecordingTask>	  m_RecordingTasks;
+		// index of the first recording task of every pass info
+		std::vector<uint32_t>		  m_PassRecordingTaskOffsets;
+		// edges between recording tasks of passes requiring ordered recording and the passes they depend on
+		std::vector<std::vector<uint32_t>> m_RecordingTaskSuccessors;
+		bool						  m_HasOrderedRecording = false;
+
+		static constexpr uint32_t	  invalidGpuScope = 0xffffffff;
+		GpuProfiler					  m_GpuProfiler;
+		// profiler scope of every render graph pass info
+		std::vector<uint32_t>		  m_PassGpuScopes;
+		// profiler scope of every render pass, only subpasses of merged passes have scopes
+		std::vector<uint32_t>		  m_SubpassGpuScopes;
+		// query index of a pass is its pass info index
+		PipelineStatisticsProfiler	  m_StatisticsProfiler;
+
+		// extension functions are not exported by the loader
+		PFN_vkCmdBeginRenderingKHR	  m_CmdBeginRendering = NULL;
+		PFN_vkCmdEndRenderingKHR	  m_CmdEndRendering = NULL;
 
 		static constexpr VkImageTiling m_DefaultImageTiling = VK_IMAGE_TILING_OPTIMAL;
 	};
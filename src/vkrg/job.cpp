@@ -0,0 +1,223 @@
+#include "job.h"
+
+namespace vkrg
+{
+	void WorkStealingDeque::Reset(uint32_t capacity)
+	{
+		// capacity is rounded up to power of 2 so that indices could be wrapped by mask
+		if (capacity > m_Capacity)
+		{
+			uint32_t newCapacity = 1;
+			while (newCapacity < capacity) newCapacity <<= 1;
+
+			m_Buffer.reset(new std::atomic<uint32_t>[newCapacity]);
+			m_Capacity = newCapacity;
+			m_Mask = newCapacity - 1;
+		}
+
+		m_Top.store(0, std::memory_order_relaxed);
+		m_Bottom.store(0, std::memory_order_relaxed);
+	}
+
+	void WorkStealingDeque::Push(uint32_t task)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		vkrg_assert(bottom - m_Top.load(std::memory_order_acquire) < (int64_t)m_Capacity);
+
+		m_Buffer[bottom & m_Mask].store(task, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	bool WorkStealingDeque::Pop(uint32_t& task)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// the deque is empty
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		task = m_Buffer[bottom & m_Mask].load(std::memory_order_relaxed);
+		if (top != bottom) return true;
+
+		// the last task, race with thieves
+		bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	bool WorkStealingDeque::Steal(uint32_t& task)
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom) return false;
+
+		task = m_Buffer[top & m_Mask].load(std::memory_order_relaxed);
+		return m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	JobSystem::JobSystem(uint32_t workerCount)
+	{
+		m_WorkerCount = vkrg_max(workerCount, 1u);
+		for (uint32_t i = 0; i < m_WorkerCount; i++)
+		{
+			m_Queues.push_back(std::make_shared<WorkStealingDeque>());
+		}
+		for (uint32_t i = 1; i < m_WorkerCount; i++)
+		{
+			m_Threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Exit = true;
+		}
+		m_WakeUp.notify_all();
+
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	uint32_t JobSystem::WorkerCount()
+	{
+		return m_WorkerCount;
+	}
+
+	void JobSystem::Dispatch(uint32_t taskCount, const std::function<void(uint32_t, uint32_t)>& task,
+		const std::vector<std::vector<uint32_t>>* successors)
+	{
+		if (taskCount == 0) return;
+		vkrg_assert(successors == nullptr || successors->size() == taskCount);
+
+		// buffers only grow, dispatching the same amount of tasks every frame doesn't allocate
+		if (taskCount > m_TaskCapacity)
+		{
+			m_PendingDependencies.reset(new std::atomic<uint32_t>[taskCount]);
+			m_TaskCapacity = taskCount;
+		}
+		for (auto& queue : m_Queues)
+		{
+			queue->Reset(taskCount);
+		}
+
+		for (uint32_t i = 0; i < taskCount; i++)
+		{
+			m_PendingDependencies[i].store(0, std::memory_order_relaxed);
+		}
+		if (successors != nullptr)
+		{
+			for (auto& taskSuccessors : *successors)
+			{
+				for (auto successor : taskSuccessors)
+				{
+					m_PendingDependencies[successor].fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// spread tasks without dependencies to all workers, the rest will be balanced by stealing
+		uint32_t readyTaskCount = 0;
+		for (uint32_t i = 0; i < taskCount; i++)
+		{
+			if (m_PendingDependencies[i].load(std::memory_order_relaxed) == 0)
+			{
+				m_Queues[readyTaskCount++ % m_WorkerCount]->Push(i);
+			}
+		}
+		vkrg_assert(readyTaskCount != 0);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Task = &task;
+			m_Successors = successors;
+			m_RemainingTasks.store(taskCount, std::memory_order_relaxed);
+			m_RunningWorkers = m_WorkerCount - 1;
+			m_Generation++;
+		}
+		m_WakeUp.notify_all();
+
+		RunTasks(0);
+
+		std::unique_lock<std::mutex> lock(m_Lock);
+		m_Finished.wait(lock, [&]() { return m_RunningWorkers == 0; });
+		m_Task = nullptr;
+		m_Successors = nullptr;
+	}
+
+	void JobSystem::WorkerLoop(uint32_t workerIdx)
+	{
+		uint64_t generation = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Lock);
+				m_WakeUp.wait(lock, [&]() { return m_Exit || m_Generation != generation; });
+				if (m_Exit) return;
+				generation = m_Generation;
+			}
+
+			RunTasks(workerIdx);
+
+			bool lastWorker = false;
+			{
+				std::lock_guard<std::mutex> lock(m_Lock);
+				lastWorker = --m_RunningWorkers == 0;
+			}
+			if (lastWorker) m_Finished.notify_one();
+		}
+	}
+
+	void JobSystem::RunTasks(uint32_t workerIdx)
+	{
+		while (m_RemainingTasks.load(std::memory_order_acquire) != 0)
+		{
+			uint32_t taskIdx;
+			if (!AcquireTask(workerIdx, taskIdx))
+			{
+				// tasks left are running on other workers or waiting for their dependencies
+				std::this_thread::yield();
+				continue;
+			}
+
+			(*m_Task)(taskIdx, workerIdx);
+
+			// successors become ready are pushed to this worker's deque, they are likely to touch the same data
+			if (m_Successors != nullptr)
+			{
+				for (auto successor : (*m_Successors)[taskIdx])
+				{
+					if (m_PendingDependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						m_Queues[workerIdx]->Push(successor);
+					}
+				}
+			}
+
+			m_RemainingTasks.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	bool JobSystem::AcquireTask(uint32_t workerIdx, uint32_t& task)
+	{
+		if (m_Queues[workerIdx]->Pop(task)) return true;
+
+		for (uint32_t i = 1; i < m_WorkerCount; i++)
+		{
+			if (m_Queues[(workerIdx + i) % m_WorkerCount]->Steal(task)) return true;
+		}
+		return false;
+	}
+}
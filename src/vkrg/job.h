@@ -0,0 +1,91 @@
+#pragma once
+#include "vkrg/common.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <vector>
+
+namespace vkrg
+{
+	/// <summary>
+	/// A fixed capacity Chase-Lev deque of task indices.
+	/// The owner pushes and pops at the bottom, other workers steal from the top without locking.
+	/// </summary>
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque() = default;
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		// not thread safe, should be called when no worker is accessing the deque
+		void Reset(uint32_t capacity);
+
+		// called by the owner
+		void Push(uint32_t task);
+		bool Pop(uint32_t& task);
+
+		// called by any worker
+		bool Steal(uint32_t& task);
+
+	private:
+		std::unique_ptr<std::atomic<uint32_t>[]> m_Buffer;
+		uint32_t			 m_Capacity = 0;
+		uint32_t			 m_Mask = 0;
+
+		std::atomic<int64_t> m_Top{ 0 };
+		std::atomic<int64_t> m_Bottom{ 0 };
+	};
+
+	/// <summary>
+	/// A small work stealing job system used to record render pass commands in parallel.
+	/// Every worker owns a deque, idle workers steal tasks from the others.
+	/// The calling thread works as worker 0, so a job system with n workers owns n - 1 threads.
+	/// </summary>
+	class JobSystem
+	{
+	public:
+		JobSystem(uint32_t workerCount);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		uint32_t WorkerCount();
+
+		/// <summary>
+		/// Run task(taskIdx, workerIdx) for every task in [0, taskCount), returns after all tasks are finished.
+		/// successors[i] lists the tasks which can only start after task i is finished, null if tasks are independent.
+		/// Dependencies must not contain cycles.
+		/// </summary>
+		void	 Dispatch(uint32_t taskCount, const std::function<void(uint32_t, uint32_t)>& task,
+			const std::vector<std::vector<uint32_t>>* successors = nullptr);
+
+	private:
+		void	 WorkerLoop(uint32_t workerIdx);
+		void	 RunTasks(uint32_t workerIdx);
+		bool	 AcquireTask(uint32_t workerIdx, uint32_t& task);
+
+		std::vector<std::thread>			   m_Threads;
+		uint32_t							   m_WorkerCount;
+		std::vector<ptr<WorkStealingDeque>>	   m_Queues;
+
+		// count of unfinished dependencies for every task
+		std::unique_ptr<std::atomic<uint32_t>[]> m_PendingDependencies;
+		uint32_t							   m_TaskCapacity = 0;
+		std::atomic<uint32_t>				   m_RemainingTasks{ 0 };
+
+		std::mutex							   m_Lock;
+		std::condition_variable				   m_WakeUp;
+		std::condition_variable				   m_Finished;
+
+		const std::function<void(uint32_t, uint32_t)>* m_Task = nullptr;
+		const std::vector<std::vector<uint32_t>>*	   m_Successors = nullptr;
+		uint64_t							   m_Generation = 0;
+		uint32_t							   m_RunningWorkers = 0;
+		bool								   m_Exit = false;
+	};
+}
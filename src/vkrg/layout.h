@@ -0,0 +1,256 @@
+#pragma once
+#include "vkrg/common.h"
+#include "vkrg/resource.h"
+#include <algorithm>
+#include <vector>
+
+namespace vkrg
+{
+	// a helper structure record states during transitions
+	// depth and stencil aspects always share a layout, so states are kept per (array layer, mip level).
+	// subresources are stored as runs of equal layouts, dense storage is used when runs are fragmented
+	struct ImageLayoutStatus
+	{
+		ImageLayoutStatus(ResourceInfo info) : ImageLayoutStatus(info, VK_IMAGE_LAYOUT_UNDEFINED) {}
+
+		ImageLayoutStatus(ResourceInfo info, VkImageLayout initLayout) : info(info)
+		{
+			subresourceCount = info.channelCount * info.mipCount;
+			runs.push_back(Run{ 0, initLayout });
+		}
+
+
+		// the layout of the subresources, VK_IMAGE_LAYOUT_UNDEFINED if they are in different layouts
+		VkImageLayout Query(ImageSlice subresource)
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			bool flag = false;
+
+			QueryRanges(subresource,
+				[&](ImageSlice range, VkImageLayout rangeLayout)
+				{
+					layout = flag && layout != rangeLayout ? VK_IMAGE_LAYOUT_UNDEFINED : rangeLayout;
+					flag = true;
+				});
+
+			return layout;
+		}
+
+		// split the subresources to ranges with uniform layouts, op(ImageSlice range, VkImageLayout layout) is called for every range
+		template<typename Op>
+		void QueryRanges(ImageSlice subresource, Op&& op)
+		{
+			Normalize(subresource);
+			uint32_t mipEnd = subresource.baseMipLevel + subresource.levelCount;
+
+			// most queries hit a single run
+			uint32_t begin = LinearIndex(subresource.baseArrayLayer, subresource.baseMipLevel);
+			uint32_t end = LinearIndex(subresource.baseArrayLayer + subresource.layerCount - 1, mipEnd - 1) + 1;
+			if (dense.empty())
+			{
+				uint32_t runIdx = FindRun(begin);
+				if (RunEnd(runIdx) >= end)
+				{
+					op(subresource, runs[runIdx].layout);
+					return;
+				}
+			}
+
+			// segments of mip levels in the current layer, consecutive layers with the same segments are emitted together
+			std::vector<tpl<uint32_t, uint32_t, VkImageLayout>> segments, lastSegments;
+			uint32_t lastLayerBegin = subresource.baseArrayLayer;
+
+			auto emit = [&](uint32_t layerEnd)
+			{
+				for (auto [segmentBegin, segmentEnd, layout] : lastSegments)
+				{
+					ImageSlice range = subresource;
+					range.baseArrayLayer = lastLayerBegin;
+					range.layerCount = layerEnd - lastLayerBegin;
+					range.baseMipLevel = segmentBegin;
+					range.levelCount = segmentEnd - segmentBegin;
+					op(range, layout);
+				}
+			};
+
+			for (uint32_t layer = subresource.baseArrayLayer; layer < subresource.baseArrayLayer + subresource.layerCount; layer++)
+			{
+				segments.clear();
+				ForEachRun(LinearIndex(layer, subresource.baseMipLevel), LinearIndex(layer, mipEnd - 1) + 1,
+					[&](uint32_t runBegin, uint32_t runEnd, VkImageLayout layout)
+					{
+						uint32_t layerOffset = layer * info.mipCount;
+						segments.push_back(std::make_tuple(runBegin - layerOffset, runEnd - layerOffset, layout));
+					});
+
+				if (segments != lastSegments)
+				{
+					emit(layer);
+					std::swap(segments, lastSegments);
+					lastLayerBegin = layer;
+				}
+			}
+			emit(subresource.baseArrayLayer + subresource.layerCount);
+		}
+
+
+		void          Update(ImageSlice subresource, VkImageLayout layout)
+		{
+			Normalize(subresource);
+			uint32_t mipEnd = subresource.baseMipLevel + subresource.levelCount;
+
+			// the whole image goes back to a single run
+			if (subresource.baseArrayLayer == 0 && subresource.layerCount == info.channelCount && subresource.baseMipLevel == 0 && mipEnd == info.mipCount)
+			{
+				dense.clear();
+				runs.clear();
+				runs.push_back(Run{ 0, layout });
+				return;
+			}
+
+			// when all mip levels are covered the layers are contiguous
+			bool contiguous = subresource.baseMipLevel == 0 && mipEnd == info.mipCount;
+			for (uint32_t layer = subresource.baseArrayLayer; layer < subresource.baseArrayLayer + subresource.layerCount; layer++)
+			{
+				uint32_t lastLayer = contiguous ? subresource.baseArrayLayer + subresource.layerCount - 1 : layer;
+				Assign(LinearIndex(layer, subresource.baseMipLevel), LinearIndex(lastLayer, mipEnd - 1) + 1, layout);
+				layer = lastLayer;
+			}
+		}
+
+		static ImageSlice Merge(ImageSlice lhs, ImageSlice rhs)
+		{
+			ImageSlice slice;
+			slice.aspectMask = lhs.aspectMask | rhs.aspectMask;
+			slice.baseArrayLayer = vkrg_min(lhs.baseArrayLayer, rhs.baseArrayLayer);
+			slice.baseMipLevel = vkrg_min(lhs.baseMipLevel, rhs.baseMipLevel);
+
+			uint32_t maxMipLevel = vkrg_max(lhs.baseMipLevel + lhs.levelCount, rhs.baseMipLevel + rhs.levelCount);
+			uint32_t maxArrayLayer = vkrg_max(lhs.baseArrayLayer + lhs.layerCount, rhs.baseArrayLayer + rhs.layerCount);
+
+			slice.layerCount = maxArrayLayer - slice.baseArrayLayer;
+			slice.baseMipLevel = maxMipLevel - slice.baseMipLevel;
+
+			return slice;
+		}
+
+		// the layouts are stored per subresource after too many runs are created
+		bool IsDense() const
+		{
+			return !dense.empty();
+		}
+
+	private:
+		struct Run
+		{
+			uint32_t      begin;
+			VkImageLayout layout;
+		};
+
+		void Normalize(ImageSlice& subresource)
+		{
+			// VkImage of format VK_FORMAT_D24_UNORM_S8_UINT that must have the depth and stencil aspects set, 
+			// but its aspectMask is 0x2. The Vulkan spec states: If image has a depth/stencil format with both 
+			// depth and stencil and the separateDepthStencilLayouts feature is not enabled, then the aspectMask 
+			// member of subresourceRange must include both VK_IMAGE_ASPECT_DEPTH_BIT and VK_IMAGE_ASPECT_STENCIL_BIT
+			if (subresource.aspectMask == VK_IMAGE_ASPECT_DEPTH_BIT || subresource.aspectMask == VK_IMAGE_ASPECT_STENCIL_BIT)
+			{
+				subresource.aspectMask = gvk::GetAllAspects(info.format) & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+			}
+
+			// VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS
+			uint32_t levelCount = info.mipCount - subresource.baseMipLevel;
+			uint32_t layerCount = info.channelCount - subresource.baseArrayLayer;
+			subresource.levelCount = vkrg_min(subresource.levelCount, levelCount);
+			subresource.layerCount = vkrg_min(subresource.layerCount, layerCount);
+		}
+
+		uint32_t LinearIndex(uint32_t layer, uint32_t mip)
+		{
+			return mip + layer * info.mipCount;
+		}
+
+		// the run containing the subresource
+		uint32_t FindRun(uint32_t idx)
+		{
+			auto iter = std::upper_bound(runs.begin(), runs.end(), idx, [](uint32_t value, const Run& run) { return value < run.begin; });
+			return (uint32_t)(iter - runs.begin()) - 1;
+		}
+
+		uint32_t RunEnd(uint32_t runIdx)
+		{
+			return runIdx + 1 < runs.size() ? runs[runIdx + 1].begin : subresourceCount;
+		}
+
+		template<typename Op>
+		void ForEachRun(uint32_t begin, uint32_t end, Op&& op)
+		{
+			if (!dense.empty())
+			{
+				for (uint32_t runBegin = begin; runBegin < end;)
+				{
+					uint32_t runEnd = runBegin + 1;
+					while (runEnd < end && dense[runEnd] == dense[runBegin]) runEnd++;
+					op(runBegin, runEnd, dense[runBegin]);
+					runBegin = runEnd;
+				}
+				return;
+			}
+
+			for (uint32_t runIdx = FindRun(begin); runIdx < runs.size() && runs[runIdx].begin < end; runIdx++)
+			{
+				uint32_t runBegin = vkrg_max(runs[runIdx].begin, begin);
+				uint32_t runEnd = RunEnd(runIdx);
+				op(runBegin, vkrg_min(runEnd, end), runs[runIdx].layout);
+			}
+		}
+
+		void Assign(uint32_t begin, uint32_t end, VkImageLayout layout)
+		{
+			if (!dense.empty())
+			{
+				std::fill(dense.begin() + begin, dense.begin() + end, layout);
+				return;
+			}
+
+			// the subresources after the range keep their layout
+			uint32_t firstRun = FindRun(begin), lastRun = FindRun(end - 1);
+			VkImageLayout tailLayout = runs[lastRun].layout;
+
+			uint32_t position = runs[firstRun].begin < begin ? firstRun + 1 : firstRun;
+			runs.erase(runs.begin() + position, runs.begin() + lastRun + 1);
+			runs.insert(runs.begin() + position, Run{ begin, layout });
+			if (end < subresourceCount && (position + 1 == runs.size() || runs[position + 1].begin != end))
+			{
+				runs.insert(runs.begin() + position + 1, Run{ end, tailLayout });
+			}
+
+			// merge neighbor runs of the same layout
+			if (position + 1 < runs.size() && runs[position + 1].layout == layout)
+			{
+				runs.erase(runs.begin() + position + 1);
+			}
+			if (position > 0 && runs[position - 1].layout == layout)
+			{
+				runs.erase(runs.begin() + position);
+			}
+
+			// fragmented runs cost more than a layout per subresource
+			uint32_t denseRunCount = vkrg_max(subresourceCount / 4, 8u);
+			if (runs.size() > denseRunCount)
+			{
+				dense.resize(subresourceCount);
+				for (uint32_t runIdx = 0; runIdx < runs.size(); runIdx++)
+				{
+					std::fill(dense.begin() + runs[runIdx].begin, dense.begin() + RunEnd(runIdx), runs[runIdx].layout);
+				}
+				runs.clear();
+			}
+		}
+
+		ResourceInfo               info;
+		uint32_t                   subresourceCount;
+		std::vector<Run>           runs;
+		std::vector<VkImageLayout> dense;
+	};
+}
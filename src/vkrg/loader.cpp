@@ -0,0 +1,1606 @@
+#include "graph.h"
+#include "trace.h"
+#include <cmath>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace vkrg
+{
+	RenderPassPrototypeRegistry& RenderPassPrototypeRegistry::Global()
+	{
+		static RenderPassPrototypeRegistry registry;
+		return registry;
+	}
+
+	bool RenderPassPrototypeRegistry::Register(const std::string& prototype, RenderPassPrototypeFactory factory)
+	{
+		if (m_Names.Find(prototype) != NameInterner::invalidId) return false;
+
+		m_Names.Intern(prototype);
+		m_Factories.push_back(factory);
+		return true;
+	}
+
+	const RenderPassPrototypeFactory* RenderPassPrototypeRegistry::Find(std::string_view prototype)
+	{
+		uint32_t id = m_Names.Find(prototype);
+		return id == NameInterner::invalidId ? NULL : &m_Factories[id];
+	}
+
+	/// <summary>
+	/// Pull parser reading values in document order, strings are returned as views of the document.
+	/// Every call returns false after the first error, callers only check the error once in the end.
+	/// </summary>
+	class JsonReader
+	{
+	public:
+		JsonReader(std::string_view json)
+			:m_Begin(json.data()), m_Cur(json.data()), m_End(json.data() + json.size())
+		{}
+
+		bool BeginObject()
+		{
+			return BeginScope('{');
+		}
+
+		// returns false at the end of the object
+		bool NextKey(std::string_view& key)
+		{
+			if (!NextInScope('}') || !ReadString(key)) return false;
+
+			SkipWhitespace();
+			if (m_Cur == m_End || *m_Cur != ':') return Fail("expected ':'");
+			m_Cur++;
+			return true;
+		}
+
+		bool BeginArray()
+		{
+			return BeginScope('[');
+		}
+
+		// returns false at the end of the array
+		bool NextElement()
+		{
+			return NextInScope(']');
+		}
+
+		bool ReadString(std::string_view& str)
+		{
+			if (Failed()) return false;
+
+			SkipWhitespace();
+			if (m_Cur == m_End || *m_Cur != '"') return Fail("expected string");
+
+			const char* begin = ++m_Cur;
+			while (m_Cur != m_End && *m_Cur != '"' && *m_Cur != '\\') m_Cur++;
+			if (m_Cur == m_End) return Fail("unterminated string");
+
+			if (*m_Cur == '"')
+			{
+				str = std::string_view(begin, m_Cur - begin);
+				m_Cur++;
+				return true;
+			}
+
+			// escaped strings are decoded to stored strings, views of them stay valid until the reader is destroyed
+			std::string& decoded = m_DecodedStrings.emplace_back(begin, m_Cur - begin);
+			while (m_Cur != m_End && *m_Cur != '"')
+			{
+				char c = *m_Cur++;
+				if (c != '\\')
+				{
+					decoded += c;
+					continue;
+				}
+				if (m_Cur == m_End) break;
+
+				switch (char e = *m_Cur++)
+				{
+				case '"': case '\\': case '/': decoded += e; break;
+				case 'b': decoded += '\b'; break;
+				case 'f': decoded += '\f'; break;
+				case 'n': decoded += '\n'; break;
+				case 'r': decoded += '\r'; break;
+				case 't': decoded += '\t'; break;
+				case 'u':
+				{
+					uint32_t code = 0;
+					for (uint32_t i = 0; i < 4; i++)
+					{
+						if (m_Cur == m_End || !isxdigit((unsigned char)*m_Cur)) return Fail("invalid unicode escape");
+						char h = *m_Cur++;
+						code = code * 16 + (isdigit((unsigned char)h) ? h - '0' : (tolower(h) - 'a' + 10));
+					}
+					// surrogate pairs are not combined, names are not expected to use them
+					if (code < 0x80)
+					{
+						decoded += (char)code;
+					}
+					else if (code < 0x800)
+					{
+						decoded += (char)(0xc0 | (code >> 6));
+						decoded += (char)(0x80 | (code & 0x3f));
+					}
+					else
+					{
+						decoded += (char)(0xe0 | (code >> 12));
+						decoded += (char)(0x80 | ((code >> 6) & 0x3f));
+						decoded += (char)(0x80 | (code & 0x3f));
+					}
+					break;
+				}
+				default:
+					return Fail("invalid escape sequence");
+				}
+			}
+			if (m_Cur == m_End) return Fail("unterminated string");
+			m_Cur++;
+
+			str = decoded;
+			return true;
+		}
+
+		bool ReadNumber(double& value)
+		{
+			if (Failed()) return false;
+
+			SkipWhitespace();
+			bool negative = m_Cur != m_End && *m_Cur == '-';
+			if (negative) m_Cur++;
+			if (m_Cur == m_End || !isdigit((unsigned char)*m_Cur)) return Fail("expected number");
+
+			// digits beyond the precision of the mantissa only scale the value
+			uint64_t mantissa = 0;
+			int32_t  exponent = 0;
+			auto readDigits = [&](bool fraction)
+			{
+				while (m_Cur != m_End && isdigit((unsigned char)*m_Cur))
+				{
+					if (mantissa < 1000000000000000000ull)
+					{
+						mantissa = mantissa * 10 + (*m_Cur - '0');
+						exponent -= fraction ? 1 : 0;
+					}
+					else
+					{
+						exponent += fraction ? 0 : 1;
+					}
+					m_Cur++;
+				}
+			};
+
+			readDigits(false);
+			if (m_Cur != m_End && *m_Cur == '.')
+			{
+				m_Cur++;
+				if (m_Cur == m_End || !isdigit((unsigned char)*m_Cur)) return Fail("expected digits after '.'");
+				readDigits(true);
+			}
+			if (m_Cur != m_End && (*m_Cur == 'e' || *m_Cur == 'E'))
+			{
+				m_Cur++;
+				bool negativeExponent = m_Cur != m_End && *m_Cur == '-';
+				if (m_Cur != m_End && (*m_Cur == '-' || *m_Cur == '+')) m_Cur++;
+				if (m_Cur == m_End || !isdigit((unsigned char)*m_Cur)) return Fail("expected exponent");
+
+				int32_t e = 0;
+				while (m_Cur != m_End && isdigit((unsigned char)*m_Cur))
+				{
+					e = vkrg_min(e * 10 + (*m_Cur - '0'), 100000);
+					m_Cur++;
+				}
+				exponent += negativeExponent ? -e : e;
+			}
+
+			value = (double)mantissa;
+			if (exponent != 0) value *= std::pow(10.0, exponent);
+			if (negative) value = -value;
+			return true;
+		}
+
+		bool ReadUInt(uint32_t& value)
+		{
+			double number;
+			if (!ReadNumber(number)) return false;
+			if (number < 0 || number > 4294967295.0 || number != std::floor(number)) return Fail("expected non-negative integer");
+			value = (uint32_t)number;
+			return true;
+		}
+
+		bool ReadBool(bool& value)
+		{
+			if (Failed()) return false;
+
+			if (Literal("true"))
+			{
+				value = true;
+				return true;
+			}
+			if (Literal("false"))
+			{
+				value = false;
+				return true;
+			}
+			return Fail("expected boolean");
+		}
+
+		bool Skip()
+		{
+			switch (Peek())
+			{
+			case '{':
+			{
+				BeginObject();
+				std::string_view key;
+				while (NextKey(key)) Skip();
+				break;
+			}
+			case '[':
+			{
+				BeginArray();
+				while (NextElement()) Skip();
+				break;
+			}
+			case '"':
+			{
+				std::string_view str;
+				ReadString(str);
+				break;
+			}
+			case 't': case 'f':
+			{
+				bool b;
+				ReadBool(b);
+				break;
+			}
+			case 'n':
+			{
+				if (!Literal("null")) Fail("expected null");
+				break;
+			}
+			default:
+			{
+				double number;
+				ReadNumber(number);
+			}
+			}
+			return !Failed();
+		}
+
+		// next non-whitespace character, 0 at the end of document
+		char Peek()
+		{
+			SkipWhitespace();
+			return m_Cur == m_End ? 0 : *m_Cur;
+		}
+
+		bool AtEnd()
+		{
+			return Peek() == 0;
+		}
+
+		bool Failed()
+		{
+			return m_Error != NULL;
+		}
+
+		// records the first error, always returns false
+		bool Fail(const char* error)
+		{
+			if (m_Error == NULL)
+			{
+				m_Error = error;
+				m_ErrorPos = m_Cur;
+			}
+			return false;
+		}
+
+		std::string ErrorMessage()
+		{
+			uint32_t line = 1, column = 1;
+			for (const char* c = m_Begin; c < m_ErrorPos; c++)
+			{
+				column = *c == '\n' ? 1 : column + 1;
+				line += *c == '\n' ? 1 : 0;
+			}
+			return "line " + std::to_string(line) + " column " + std::to_string(column) + ": " + m_Error;
+		}
+
+	private:
+		static constexpr uint32_t maxDepth = 64;
+
+		void SkipWhitespace()
+		{
+			while (m_Cur != m_End && (*m_Cur == ' ' || *m_Cur == '\t' || *m_Cur == '\n' || *m_Cur == '\r')) m_Cur++;
+		}
+
+		bool Literal(std::string_view literal)
+		{
+			SkipWhitespace();
+			if ((size_t)(m_End - m_Cur) < literal.size() || std::string_view(m_Cur, literal.size()) != literal) return false;
+			m_Cur += literal.size();
+			return true;
+		}
+
+		bool BeginScope(char open)
+		{
+			if (Failed()) return false;
+
+			SkipWhitespace();
+			if (m_Cur == m_End || *m_Cur != open) return Fail(open == '{' ? "expected '{'" : "expected '['");
+			if (m_Depth == maxDepth) return Fail("document is nested too deep");
+
+			m_Cur++;
+			m_HasElement[m_Depth++] = false;
+			return true;
+		}
+
+		bool NextInScope(char close)
+		{
+			if (Failed()) return false;
+
+			SkipWhitespace();
+			if (m_Cur != m_End && *m_Cur == close)
+			{
+				m_Cur++;
+				m_Depth--;
+				return false;
+			}
+
+			if (m_HasElement[m_Depth - 1])
+			{
+				if (m_Cur == m_End || *m_Cur != ',') return Fail(close == '}' ? "expected ',' or '}'" : "expected ',' or ']'");
+				m_Cur++;
+			}
+			m_HasElement[m_Depth - 1] = true;
+			return true;
+		}
+
+		const char* m_Begin;
+		const char* m_Cur;
+		const char* m_End;
+
+		// whether a scope has read an element, elements after the first one are preceded by ','
+		bool		m_HasElement[maxDepth];
+		uint32_t	m_Depth = 0;
+
+		const char* m_Error = NULL;
+		const char* m_ErrorPos = NULL;
+
+		std::deque<std::string> m_DecodedStrings;
+	};
+
+	template<typename T>
+	struct JsonEnumEntry
+	{
+		std::string_view name;
+		T				 value;
+	};
+
+	template<typename T, size_t N>
+	static bool FindJsonEnum(const JsonEnumEntry<T>(&entries)[N], std::string_view name, T& value)
+	{
+		for (auto& entry : entries)
+		{
+			if (entry.name == name)
+			{
+				value = entry.value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename T, size_t N>
+	static std::string_view FindJsonEnumName(const JsonEnumEntry<T>(&entries)[N], T value)
+	{
+		for (auto& entry : entries)
+		{
+			if (entry.value == value) return entry.name;
+		}
+		return std::string_view();
+	}
+
+	static const JsonEnumEntry<GraphResourceLayout> jsonLayouts[] =
+	{
+		{ "texture1d", GraphResourceLayout::Texture1D },
+		{ "texture2d", GraphResourceLayout::Texture2D },
+		{ "texture3d", GraphResourceLayout::Texture3D },
+		{ "buffer", GraphResourceLayout::Buffer },
+	};
+
+	static const JsonEnumEntry<VkFormat> jsonFormats[] =
+	{
+		{ "buffer", VK_FORMAT_UNDEFINED },
+		{ "r8", VK_FORMAT_R8_UNORM },
+		{ "rg8", VK_FORMAT_R8G8_UNORM },
+		{ "rgba8", VK_FORMAT_R8G8B8A8_UNORM },
+		{ "rgba8-srgb", VK_FORMAT_R8G8B8A8_SRGB },
+		{ "bgra8", VK_FORMAT_B8G8R8A8_UNORM },
+		{ "bgra8-srgb", VK_FORMAT_B8G8R8A8_SRGB },
+		{ "rgb10a2", VK_FORMAT_A2B10G10R10_UNORM_PACK32 },
+		{ "r11g11b10f", VK_FORMAT_B10G11R11_UFLOAT_PACK32 },
+		{ "r16f", VK_FORMAT_R16_SFLOAT },
+		{ "rg16f", VK_FORMAT_R16G16_SFLOAT },
+		{ "rgba16f", VK_FORMAT_R16G16B16A16_SFLOAT },
+		{ "r32f", VK_FORMAT_R32_SFLOAT },
+		{ "r32ui", VK_FORMAT_R32_UINT },
+		{ "rg32f", VK_FORMAT_R32G32_SFLOAT },
+		{ "rgba32f", VK_FORMAT_R32G32B32A32_SFLOAT },
+		{ "d16", VK_FORMAT_D16_UNORM },
+		{ "d32", VK_FORMAT_D32_SFLOAT },
+		{ "d24s8", VK_FORMAT_D24_UNORM_S8_UINT },
+		{ "d32s8", VK_FORMAT_D32_SFLOAT_S8_UINT },
+	};
+
+	static const JsonEnumEntry<VkImageLayout> jsonImageLayouts[] =
+	{
+		{ "undefined", VK_IMAGE_LAYOUT_UNDEFINED },
+		{ "general", VK_IMAGE_LAYOUT_GENERAL },
+		{ "color-attachment", VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+		{ "depth-stencil-attachment", VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL },
+		{ "shader-read", VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		{ "transfer-src", VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL },
+		{ "transfer-dst", VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL },
+		{ "present", VK_IMAGE_LAYOUT_PRESENT_SRC_KHR },
+	};
+
+	static const JsonEnumEntry<RenderPassType> jsonPassTypes[] =
+	{
+		{ "render-pass", RenderPassType::Graphics },
+		{ "graphics", RenderPassType::Graphics },
+		{ "compute-pass", RenderPassType::Compute },
+		{ "compute", RenderPassType::Compute },
+		{ "raytracing-pass", RenderPassType::Raytracing },
+		{ "raytracing", RenderPassType::Raytracing },
+	};
+
+	static const JsonEnumEntry<GraphAttachmentUsage> jsonAttachmentUsages[] =
+	{
+		{ "color", GraphAttachmentUsage::Color },
+		{ "depth", GraphAttachmentUsage::Depth },
+		{ "sampled", GraphAttachmentUsage::Sampled },
+		{ "input", GraphAttachmentUsage::Sampled },
+		{ "storage", GraphAttachmentUsage::Storage },
+		{ "rt", GraphAttachmentUsage::RayTracing },
+		{ "rt-sampled", GraphAttachmentUsage::RayTracingSampled },
+		{ "uniform", GraphAttachmentUsage::Uniform },
+		{ "color-rw", GraphAttachmentUsage::ColorReadWrite },
+		{ "storage-rw", GraphAttachmentUsage::StorageReadWrite },
+	};
+
+	// usages of resources other than the ones added by attachments automatically
+	static const JsonEnumEntry<VkFlags> jsonResourceUsages[] =
+	{
+		{ "transfer-src", VK_IMAGE_USAGE_TRANSFER_SRC_BIT },
+		{ "transfer-dst", VK_IMAGE_USAGE_TRANSFER_DST_BIT },
+		{ "sampled", VK_IMAGE_USAGE_SAMPLED_BIT },
+		{ "storage", VK_IMAGE_USAGE_STORAGE_BIT },
+		{ "color", VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT },
+		{ "depth", VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT },
+		{ "input", VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT },
+	};
+
+	static const JsonEnumEntry<VkFlags> jsonBufferUsages[] =
+	{
+		{ "transfer-src", VK_BUFFER_USAGE_TRANSFER_SRC_BIT },
+		{ "transfer-dst", VK_BUFFER_USAGE_TRANSFER_DST_BIT },
+		{ "uniform", VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT },
+		{ "storage", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT },
+		{ "vertex", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT },
+		{ "index", VK_BUFFER_USAGE_INDEX_BUFFER_BIT },
+		{ "indirect", VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT },
+	};
+
+	static GraphResourceFieldsRecord DefaultGraphResourceFields()
+	{
+		GraphResourceFieldsRecord fields{};
+		fields.layout = (uint32_t)GraphResourceLayout::Unspecified;
+		fields.format = VK_FORMAT_UNDEFINED;
+		fields.channelCount = 1;
+		fields.mipCount = 1;
+		return fields;
+	}
+
+	// resources without layout are buffers if their format is "buffer", otherwise they are 2d textures
+	static GraphResourceLayout GetGraphResourceLayout(const GraphResourceFieldsRecord& fields)
+	{
+		if (fields.layout != (uint32_t)GraphResourceLayout::Unspecified) return (GraphResourceLayout)fields.layout;
+		return (fields.flags & GraphRecordHasFormat) && fields.format == VK_FORMAT_UNDEFINED ? GraphResourceLayout::Buffer : GraphResourceLayout::Texture2D;
+	}
+
+	// records parsed from a json document, names are interned in the order they first appear
+	struct JsonGraphDocument
+	{
+		NameInterner					   names;
+		std::vector<GraphResourceRecord>   resources;
+		std::vector<GraphPassRecord>	   passes;
+		std::vector<GraphAttachmentRecord> attachments;
+		std::vector<GraphEdgeRecord>	   edges;
+
+		GraphRecords Records()
+		{
+			GraphRecords records;
+			records.names.resize(names.Count());
+			for (uint32_t i = 0; i < names.Count(); i++)
+			{
+				records.names[i] = names.Get(i).c_str();
+			}
+			records.resources = resources.data();
+			records.resourceCount = resources.size();
+			records.passes = passes.data();
+			records.passCount = passes.size();
+			records.attachments = attachments.data();
+			records.attachmentCount = attachments.size();
+			records.edges = edges.data();
+			records.edgeCount = edges.size();
+			return records;
+		}
+	};
+
+	// names of usages are resolved after the whole resource is read, the layout could be declared after usages
+	struct JsonUsageList
+	{
+		std::string_view names[8];
+		uint32_t		 count = 0;
+	};
+
+	static void ParseJsonExtent(JsonReader& reader, GraphResourceFieldsRecord& fields)
+	{
+		fields.flags |= GraphRecordHasExtent;
+
+		reader.BeginObject();
+		std::string_view key;
+		while (reader.NextKey(key))
+		{
+			double number;
+			if (key == "screen-scale")
+			{
+				reader.ReadNumber(number);
+				if (number < 0) reader.Fail("screen-scale should not be negative");
+				fields.screenScale = number;
+			}
+			else if (key == "width") reader.ReadUInt(fields.width);
+			else if (key == "height") reader.ReadUInt(fields.height);
+			else if (key == "depth") reader.ReadUInt(fields.depth);
+			else if (key == "size")
+			{
+				reader.ReadNumber(number);
+				if (number < 0 || number != std::floor(number)) reader.Fail("size should be a non-negative integer");
+				fields.size = (uint64_t)number;
+			}
+			else reader.Skip();
+		}
+	}
+
+	// reads a field of a resource, returns false if the key is not a resource field
+	static bool ParseJsonResourceField(JsonReader& reader, std::string_view key, GraphResourceFieldsRecord& fields)
+	{
+		std::string_view str;
+		if (key == "layout")
+		{
+			GraphResourceLayout layout;
+			if (reader.ReadString(str) && !FindJsonEnum(jsonLayouts, str, layout)) reader.Fail("unknown layout");
+			fields.layout = (uint32_t)layout;
+		}
+		else if (key == "format")
+		{
+			VkFormat format;
+			fields.flags |= GraphRecordHasFormat;
+			if (reader.ReadString(str) && !FindJsonEnum(jsonFormats, str, format)) reader.Fail("unknown format");
+			fields.format = format;
+		}
+		else if (key == "extent")
+		{
+			ParseJsonExtent(reader, fields);
+		}
+		else if (key == "channel-count")
+		{
+			reader.ReadUInt(fields.channelCount);
+			if (fields.channelCount == 0) reader.Fail("channel-count should be positive");
+		}
+		else if (key == "mip-count")
+		{
+			reader.ReadUInt(fields.mipCount);
+			if (fields.mipCount == 0) reader.Fail("mip-count should be positive");
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// usage is a string or an array of strings
+	static void ParseJsonUsages(JsonReader& reader, JsonUsageList& usages)
+	{
+		auto addUsage = [&](std::string_view usage)
+		{
+			if (usages.count == std::size(usages.names))
+			{
+				reader.Fail("too many usages");
+				return;
+			}
+			usages.names[usages.count++] = usage;
+		};
+
+		std::string_view str;
+		if (reader.Peek() != '[')
+		{
+			if (reader.ReadString(str)) addUsage(str);
+			return;
+		}
+
+		reader.BeginArray();
+		while (reader.NextElement())
+		{
+			if (reader.ReadString(str)) addUsage(str);
+		}
+	}
+
+	static void ResolveJsonUsages(JsonReader& reader, const JsonUsageList& usages, GraphResourceFieldsRecord& fields)
+	{
+		bool buffer = GetGraphResourceLayout(fields) == GraphResourceLayout::Buffer;
+		for (uint32_t i = 0; i < usages.count; i++)
+		{
+			VkFlags usage;
+			if (!(buffer ? FindJsonEnum(jsonBufferUsages, usages.names[i], usage) : FindJsonEnum(jsonResourceUsages, usages.names[i], usage)))
+			{
+				reader.Fail(buffer ? "unknown buffer usage" : "unknown image usage");
+				return;
+			}
+			fields.usages |= usage;
+		}
+	}
+
+	static void ParseJsonAttachment(JsonReader& reader, JsonGraphDocument& doc, bool output)
+	{
+		GraphAttachmentRecord attachment{};
+		attachment.fields = DefaultGraphResourceFields();
+		attachment.resource = NameInterner::invalidId;
+		attachment.usage = (uint32_t)GraphAttachmentUsage::Default;
+		attachment.output = output;
+
+		reader.BeginObject();
+		std::string_view key, str;
+		while (reader.NextKey(key))
+		{
+			if (key == "name")
+			{
+				if (reader.ReadString(str)) attachment.resource = doc.names.Intern(str);
+			}
+			else if (key == "usage")
+			{
+				GraphAttachmentUsage usage;
+				if (reader.ReadString(str) && !FindJsonEnum(jsonAttachmentUsages, str, usage)) reader.Fail("unknown attachment usage");
+				attachment.usage = (uint32_t)usage;
+			}
+			else if (key == "mip-idx")
+			{
+				reader.ReadUInt(attachment.mipIdx);
+			}
+			else if (!ParseJsonResourceField(reader, key, attachment.fields))
+			{
+				reader.Skip();
+			}
+		}
+
+		if (!reader.Failed() && attachment.resource == NameInterner::invalidId) reader.Fail("attachment should have a name");
+		doc.attachments.push_back(attachment);
+	}
+
+	// "out" and "in" of an edge is the name of a pass or an object with the name in "pass"
+	static uint32_t ParseJsonEdgeEnd(JsonReader& reader, JsonGraphDocument& doc)
+	{
+		std::string_view key, str;
+		uint32_t pass = NameInterner::invalidId;
+		if (reader.Peek() == '"')
+		{
+			if (reader.ReadString(str)) pass = doc.names.Intern(str);
+			return pass;
+		}
+
+		reader.BeginObject();
+		while (reader.NextKey(key))
+		{
+			if (key == "pass")
+			{
+				if (reader.ReadString(str)) pass = doc.names.Intern(str);
+			}
+			else
+			{
+				reader.Skip();
+			}
+		}
+		if (!reader.Failed() && pass == NameInterner::invalidId) reader.Fail("edge should name a pass");
+		return pass;
+	}
+
+	static void ParseJsonGraphDocument(JsonReader& reader, JsonGraphDocument& doc)
+	{
+		std::string_view key, str;
+
+		reader.BeginObject();
+		while (reader.NextKey(key))
+		{
+			if (key == "resources")
+			{
+				reader.BeginArray();
+				while (reader.NextElement())
+				{
+					GraphResourceRecord resource{};
+					resource.fields = DefaultGraphResourceFields();
+					resource.name = NameInterner::invalidId;
+					resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+					JsonUsageList usages;
+
+					reader.BeginObject();
+					while (reader.NextKey(key))
+					{
+						if (key == "name")
+						{
+							if (reader.ReadString(str)) resource.name = doc.names.Intern(str);
+						}
+						else if (key == "external")
+						{
+							bool external = false;
+							reader.ReadBool(external);
+							resource.fields.flags |= external ? GraphRecordExternal : 0;
+						}
+						else if (key == "final-layout")
+						{
+							VkImageLayout layout;
+							if (reader.ReadString(str) && !FindJsonEnum(jsonImageLayouts, str, layout)) reader.Fail("unknown image layout");
+							resource.finalLayout = layout;
+						}
+						else if (key == "usage")
+						{
+							ParseJsonUsages(reader, usages);
+						}
+						else if (!ParseJsonResourceField(reader, key, resource.fields))
+						{
+							reader.Skip();
+						}
+					}
+
+					ResolveJsonUsages(reader, usages, resource.fields);
+					if (!reader.Failed() && resource.name == NameInterner::invalidId) reader.Fail("resource should have a name");
+					doc.resources.push_back(resource);
+				}
+			}
+			else if (key == "passes")
+			{
+				reader.BeginArray();
+				while (reader.NextElement())
+				{
+					GraphPassRecord pass{};
+					pass.extension = DefaultGraphResourceFields();
+					pass.name = NameInterner::invalidId;
+					pass.prototype = NameInterner::invalidId;
+					pass.type = (uint32_t)RenderPassType::Graphics;
+					pass.attachmentOffset = doc.attachments.size();
+
+					reader.BeginObject();
+					while (reader.NextKey(key))
+					{
+						if (key == "name")
+						{
+							if (reader.ReadString(str)) pass.name = doc.names.Intern(str);
+						}
+						else if (key == "prototype")
+						{
+							if (reader.ReadString(str)) pass.prototype = doc.names.Intern(str);
+						}
+						else if (key == "type")
+						{
+							RenderPassType type;
+							if (reader.ReadString(str) && !FindJsonEnum(jsonPassTypes, str, type)) reader.Fail("unknown pass type");
+							pass.type = (uint32_t)type;
+						}
+						else if (key == "extent")
+						{
+							ParseJsonExtent(reader, pass.extension);
+						}
+						else if (key == "input" || key == "output")
+						{
+							bool output = key == "output";
+							reader.BeginArray();
+							while (reader.NextElement())
+							{
+								ParseJsonAttachment(reader, doc, output);
+							}
+						}
+						else
+						{
+							reader.Skip();
+						}
+					}
+
+					if (!reader.Failed() && pass.name == NameInterner::invalidId) reader.Fail("pass should have a name");
+					pass.attachmentCount = doc.attachments.size() - pass.attachmentOffset;
+					doc.passes.push_back(pass);
+				}
+			}
+			else if (key == "edges")
+			{
+				reader.BeginArray();
+				while (reader.NextElement())
+				{
+					GraphEdgeRecord edge;
+					edge.outPass = NameInterner::invalidId;
+					edge.inPass = NameInterner::invalidId;
+
+					reader.BeginObject();
+					while (reader.NextKey(key))
+					{
+						if (key == "out") edge.outPass = ParseJsonEdgeEnd(reader, doc);
+						else if (key == "in") edge.inPass = ParseJsonEdgeEnd(reader, doc);
+						else reader.Skip();
+					}
+
+					if (!reader.Failed() && (edge.outPass == NameInterner::invalidId || edge.inPass == NameInterner::invalidId))
+					{
+						reader.Fail("edge should have out and in");
+					}
+					doc.edges.push_back(edge);
+				}
+			}
+			else
+			{
+				reader.Skip();
+			}
+		}
+
+		if (!reader.Failed() && !reader.AtEnd()) reader.Fail("unexpected content after document");
+	}
+
+	static bool ParseJsonGraphDocument(std::string_view json, JsonGraphDocument& doc, std::string* msg)
+	{
+		JsonReader reader(json);
+		ParseJsonGraphDocument(reader, doc);
+		if (reader.Failed())
+		{
+			if (msg != NULL) *msg = "Render graph json error: " + reader.ErrorMessage();
+			return false;
+		}
+		return true;
+	}
+
+	static uint64_t AlignGraphBinaryOffset(uint64_t offset)
+	{
+		return (offset + 7) & ~(uint64_t)7;
+	}
+
+	static void WriteGraphBinary(JsonGraphDocument& doc, std::vector<char>& binary)
+	{
+		GraphBinaryHeader header{};
+		header.magic = GraphBinaryHeader::magicNumber;
+		header.version = GraphBinaryHeader::currentVersion;
+		header.stringCount = doc.names.Count();
+		header.resourceCount = doc.resources.size();
+		header.passCount = doc.passes.size();
+		header.attachmentCount = doc.attachments.size();
+		header.edgeCount = doc.edges.size();
+
+		for (uint32_t i = 0; i < doc.names.Count(); i++)
+		{
+			header.stringDataSize += doc.names.Get(i).size() + 1;
+		}
+
+		header.stringRecordOffset = AlignGraphBinaryOffset(sizeof(GraphBinaryHeader));
+		header.stringDataOffset = AlignGraphBinaryOffset(header.stringRecordOffset + sizeof(uint32_t) * 2 * header.stringCount);
+		header.resourceOffset = AlignGraphBinaryOffset(header.stringDataOffset + header.stringDataSize);
+		header.passOffset = AlignGraphBinaryOffset(header.resourceOffset + sizeof(GraphResourceRecord) * header.resourceCount);
+		header.attachmentOffset = AlignGraphBinaryOffset(header.passOffset + sizeof(GraphPassRecord) * header.passCount);
+		header.edgeOffset = AlignGraphBinaryOffset(header.attachmentOffset + sizeof(GraphAttachmentRecord) * header.attachmentCount);
+		header.fileSize = AlignGraphBinaryOffset(header.edgeOffset + sizeof(GraphEdgeRecord) * header.edgeCount);
+
+		binary.assign(header.fileSize, 0);
+		char* data = binary.data();
+		memcpy(data, &header, sizeof(header));
+
+		uint32_t* stringRecords = (uint32_t*)(data + header.stringRecordOffset);
+		uint32_t stringOffset = 0;
+		for (uint32_t i = 0; i < doc.names.Count(); i++)
+		{
+			const std::string& name = doc.names.Get(i);
+			stringRecords[i * 2] = stringOffset;
+			stringRecords[i * 2 + 1] = name.size();
+			memcpy(data + header.stringDataOffset + stringOffset, name.c_str(), name.size() + 1);
+			stringOffset += name.size() + 1;
+		}
+
+		// vectors could be empty, their data() could be null
+		auto writeRecords = [&](uint64_t offset, const void* records, size_t size)
+		{
+			if (size != 0) memcpy(data + offset, records, size);
+		};
+		writeRecords(header.resourceOffset, doc.resources.data(), sizeof(GraphResourceRecord) * doc.resources.size());
+		writeRecords(header.passOffset, doc.passes.data(), sizeof(GraphPassRecord) * doc.passes.size());
+		writeRecords(header.attachmentOffset, doc.attachments.data(), sizeof(GraphAttachmentRecord) * doc.attachments.size());
+		writeRecords(header.edgeOffset, doc.edges.data(), sizeof(GraphEdgeRecord) * doc.edges.size());
+	}
+
+	// records point to the binary data directly, the data should be kept until the records are not used
+	static bool ReadGraphBinary(const void* data, size_t size, GraphRecords& records, std::string* msg)
+	{
+		auto error = [&](const char* err)
+		{
+			if (msg != NULL) *msg = std::string("Render graph binary error: ") + err;
+			return false;
+		};
+
+		const char* bytes = (const char*)data;
+		if ((uintptr_t)bytes % 8 != 0) return error("data should be 8 bytes aligned");
+		if (size < sizeof(GraphBinaryHeader)) return error("data is smaller than the header");
+
+		const GraphBinaryHeader& header = *(const GraphBinaryHeader*)bytes;
+		if (header.magic != GraphBinaryHeader::magicNumber) return error("invalid magic number");
+		if (header.version != GraphBinaryHeader::currentVersion) return error("unsupported version");
+		if (header.fileSize > size) return error("data is truncated");
+
+		auto checkSection = [&](uint64_t offset, uint64_t count, uint64_t stride)
+		{
+			return offset % 8 == 0 && offset >= sizeof(GraphBinaryHeader) && offset <= header.fileSize && count * stride <= header.fileSize - offset;
+		};
+		if (!checkSection(header.stringRecordOffset, header.stringCount, sizeof(uint32_t) * 2)
+			|| !checkSection(header.stringDataOffset, header.stringDataSize, 1)
+			|| !checkSection(header.resourceOffset, header.resourceCount, sizeof(GraphResourceRecord))
+			|| !checkSection(header.passOffset, header.passCount, sizeof(GraphPassRecord))
+			|| !checkSection(header.attachmentOffset, header.attachmentCount, sizeof(GraphAttachmentRecord))
+			|| !checkSection(header.edgeOffset, header.edgeCount, sizeof(GraphEdgeRecord)))
+		{
+			return error("section is out of range");
+		}
+
+		const uint32_t* stringRecords = (const uint32_t*)(bytes + header.stringRecordOffset);
+		const char* stringData = bytes + header.stringDataOffset;
+		records.names.resize(header.stringCount);
+		for (uint32_t i = 0; i < header.stringCount; i++)
+		{
+			uint64_t offset = stringRecords[i * 2], length = stringRecords[i * 2 + 1];
+			if (offset + length >= header.stringDataSize || stringData[offset + length] != '\0') return error("invalid string");
+			records.names[i] = stringData + offset;
+		}
+
+		records.resources = (const GraphResourceRecord*)(bytes + header.resourceOffset);
+		records.resourceCount = header.resourceCount;
+		records.passes = (const GraphPassRecord*)(bytes + header.passOffset);
+		records.passCount = header.passCount;
+		records.attachments = (const GraphAttachmentRecord*)(bytes + header.attachmentOffset);
+		records.attachmentCount = header.attachmentCount;
+		records.edges = (const GraphEdgeRecord*)(bytes + header.edgeOffset);
+		records.edgeCount = header.edgeCount;
+
+		// records are used as indices when building graphs, they are checked once here
+		auto validFields = [&](const GraphResourceFieldsRecord& fields)
+		{
+			return fields.layout <= (uint32_t)GraphResourceLayout::Buffer && fields.channelCount != 0 && fields.mipCount != 0;
+		};
+		for (uint32_t i = 0; i < records.resourceCount; i++)
+		{
+			auto& resource = records.resources[i];
+			if (resource.name >= header.stringCount || !validFields(resource.fields)) return error("invalid resource record");
+		}
+		for (uint32_t i = 0; i < records.passCount; i++)
+		{
+			auto& pass = records.passes[i];
+			if (pass.name >= header.stringCount || (pass.prototype != NameInterner::invalidId && pass.prototype >= header.stringCount)
+				|| pass.type > (uint32_t)RenderPassType::Compute || (uint64_t)pass.attachmentOffset + pass.attachmentCount > records.attachmentCount)
+			{
+				return error("invalid pass record");
+			}
+		}
+		for (uint32_t i = 0; i < records.attachmentCount; i++)
+		{
+			auto& attachment = records.attachments[i];
+			if (attachment.resource >= header.stringCount || attachment.usage > (uint32_t)GraphAttachmentUsage::StorageReadWrite || !validFields(attachment.fields))
+			{
+				return error("invalid attachment record");
+			}
+		}
+		for (uint32_t i = 0; i < records.edgeCount; i++)
+		{
+			auto& edge = records.edges[i];
+			if (edge.outPass >= header.stringCount || edge.inPass >= header.stringCount) return error("invalid edge record");
+		}
+
+		return true;
+	}
+
+	static void WriteJsonExtent(std::ostream& os, const GraphResourceFieldsRecord& fields)
+	{
+		os << "\"extent\" : { ";
+		if (GetGraphResourceLayout(fields) == GraphResourceLayout::Buffer)
+		{
+			os << "\"size\" : " << fields.size;
+		}
+		else if (fields.screenScale > 0)
+		{
+			os << "\"screen-scale\" : " << fields.screenScale;
+		}
+		else
+		{
+			os << "\"width\" : " << fields.width << ", \"height\" : " << fields.height << ", \"depth\" : " << fields.depth;
+		}
+		os << " }";
+	}
+
+	static void WriteJsonResourceFields(std::ostream& os, const GraphResourceFieldsRecord& fields)
+	{
+		if (fields.layout != (uint32_t)GraphResourceLayout::Unspecified)
+		{
+			os << ", \"layout\" : \"" << FindJsonEnumName(jsonLayouts, (GraphResourceLayout)fields.layout) << "\"";
+		}
+		if (fields.flags & GraphRecordHasFormat)
+		{
+			os << ", \"format\" : \"" << FindJsonEnumName(jsonFormats, (VkFormat)fields.format) << "\"";
+		}
+		if (fields.flags & GraphRecordHasExtent)
+		{
+			os << ", ";
+			WriteJsonExtent(os, fields);
+		}
+		if (fields.channelCount != 1) os << ", \"channel-count\" : " << fields.channelCount;
+		if (fields.mipCount != 1) os << ", \"mip-count\" : " << fields.mipCount;
+	}
+
+	static void WriteGraphJson(const GraphRecords& records, std::ostream& os)
+	{
+		// screen scales are floats, 9 digits make them read back to the same value
+		auto precision = os.precision(9);
+		auto name = [&](uint32_t id) { return EscapeString(records.names[id]); };
+
+		os << "{\n\t\"resources\" : [";
+		for (uint32_t i = 0; i < records.resourceCount; i++)
+		{
+			auto& resource = records.resources[i];
+			os << (i == 0 ? "\n" : ",\n") << "\t\t{ \"name\" : \"" << name(resource.name) << "\"";
+			WriteJsonResourceFields(os, resource.fields);
+
+			if (resource.fields.usages != 0)
+			{
+				bool buffer = GetGraphResourceLayout(resource.fields) == GraphResourceLayout::Buffer;
+				os << ", \"usage\" : [";
+				bool first = true;
+				const JsonEnumEntry<VkFlags>* begin = buffer ? std::begin(jsonBufferUsages) : std::begin(jsonResourceUsages);
+				const JsonEnumEntry<VkFlags>* end = buffer ? std::end(jsonBufferUsages) : std::end(jsonResourceUsages);
+				for (auto entry = begin; entry != end; entry++)
+				{
+					if ((resource.fields.usages & entry->value) == 0) continue;
+					os << (first ? " \"" : ", \"") << entry->name << "\"";
+					first = false;
+				}
+				os << " ]";
+			}
+			if (resource.fields.flags & GraphRecordExternal) os << ", \"external\" : true";
+			if (resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+			{
+				os << ", \"final-layout\" : \"" << FindJsonEnumName(jsonImageLayouts, (VkImageLayout)resource.finalLayout) << "\"";
+			}
+			os << " }";
+		}
+		os << "\n\t],\n\t\"passes\" : [";
+
+		for (uint32_t i = 0; i < records.passCount; i++)
+		{
+			auto& pass = records.passes[i];
+			os << (i == 0 ? "\n" : ",\n") << "\t\t{\n\t\t\t\"name\" : \"" << name(pass.name) << "\", \"type\" : \""
+				<< FindJsonEnumName(jsonPassTypes, (RenderPassType)pass.type) << "\"";
+			if (pass.prototype != NameInterner::invalidId) os << ", \"prototype\" : \"" << name(pass.prototype) << "\"";
+			if (pass.extension.flags & GraphRecordHasExtent)
+			{
+				os << ", ";
+				WriteJsonExtent(os, pass.extension);
+			}
+
+			// attachments are written in their original order, inputs and outputs could be interleaved
+			for (uint32_t j = 0; j < pass.attachmentCount; j++)
+			{
+				auto& attachment = records.attachments[pass.attachmentOffset + j];
+				bool first = j == 0 || records.attachments[pass.attachmentOffset + j - 1].output != attachment.output;
+				bool last = j + 1 == pass.attachmentCount || records.attachments[pass.attachmentOffset + j + 1].output != attachment.output;
+
+				if (first) os << ",\n\t\t\t\"" << (attachment.output ? "output" : "input") << "\" : [";
+				os << (first ? "\n" : ",\n") << "\t\t\t\t{ \"name\" : \"" << name(attachment.resource) << "\"";
+				if (attachment.usage != (uint32_t)GraphAttachmentUsage::Default)
+				{
+					os << ", \"usage\" : \"" << FindJsonEnumName(jsonAttachmentUsages, (GraphAttachmentUsage)attachment.usage) << "\"";
+				}
+				if (attachment.mipIdx != 0) os << ", \"mip-idx\" : " << attachment.mipIdx;
+				WriteJsonResourceFields(os, attachment.fields);
+				os << " }";
+				if (last) os << "\n\t\t\t]";
+			}
+			os << "\n\t\t}";
+		}
+		os << "\n\t],\n\t\"edges\" : [";
+
+		for (uint32_t i = 0; i < records.edgeCount; i++)
+		{
+			auto& edge = records.edges[i];
+			os << (i == 0 ? "\n" : ",\n") << "\t\t{ \"out\" : \"" << name(edge.outPass) << "\", \"in\" : \"" << name(edge.inPass) << "\" }";
+		}
+		os << "\n\t]\n}\n";
+		os.precision(precision);
+	}
+
+	bool ConvertGraphJsonToBinary(std::string_view json, std::vector<char>& binary, std::string* msg)
+	{
+		JsonGraphDocument doc;
+		if (!ParseJsonGraphDocument(json, doc, msg)) return false;
+
+		WriteGraphBinary(doc, binary);
+		return true;
+	}
+
+	bool ConvertGraphBinaryToJson(const void* data, size_t size, std::ostream& os, std::string* msg)
+	{
+		GraphRecords records;
+		if (!ReadGraphBinary(data, size, records, msg)) return false;
+
+		WriteGraphJson(records, os);
+		return true;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// the mapping keeps the file open, the file handle could be closed
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (mapping == NULL) return false;
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == NULL)
+		{
+			CloseHandle(mapping);
+			return false;
+		}
+
+		m_Mapping = mapping;
+		m_Data = data;
+		m_Size = (size_t)size.QuadPart;
+#else
+		int file = open(path, O_RDONLY);
+		if (file < 0) return false;
+
+		struct stat st;
+		if (fstat(file, &st) != 0 || st.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// the mapping keeps the file open, the descriptor could be closed
+		void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED) return false;
+
+		m_Data = data;
+		m_Size = (size_t)st.st_size;
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data == NULL) return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		m_Mapping = NULL;
+#else
+		munmap((void*)m_Data, m_Size);
+#endif
+		m_Data = NULL;
+		m_Size = 0;
+	}
+
+	const void* MappedFile::Data()
+	{
+		return m_Data;
+	}
+
+	size_t MappedFile::Size()
+	{
+		return m_Size;
+	}
+
+	static bool BuildGraphResourceInfo(const GraphResourceFieldsRecord& fields, ResourceInfo& info, const char*& error)
+	{
+		info = ResourceInfo();
+		info.channelCount = fields.channelCount;
+		info.mipCount = fields.mipCount;
+		info.usages = fields.usages;
+
+		GraphResourceLayout layout = GetGraphResourceLayout(fields);
+		if (layout == GraphResourceLayout::Buffer)
+		{
+			if (fields.size == 0)
+			{
+				error = "size of buffer should be positive";
+				return false;
+			}
+			info.extType = ResourceExtensionType::Buffer;
+			info.ext.buffer.size = fields.size;
+			info.format = VK_FORMAT_UNDEFINED;
+			return true;
+		}
+
+		if (!(fields.flags & GraphRecordHasFormat) || fields.format == VK_FORMAT_UNDEFINED)
+		{
+			error = "images should have a format";
+			return false;
+		}
+		info.format = (VkFormat)fields.format;
+
+		if (layout == GraphResourceLayout::Texture2D && fields.screenScale > 0)
+		{
+			info.extType = ResourceExtensionType::Screen;
+			info.ext.screen.x = fields.screenScale;
+			info.ext.screen.y = fields.screenScale;
+			info.expectedDimension = VK_IMAGE_TYPE_2D;
+			return true;
+		}
+
+		info.extType = ResourceExtensionType::Fixed;
+		info.ext.fixed.x = fields.width;
+		info.ext.fixed.y = layout == GraphResourceLayout::Texture1D ? 1 : fields.height;
+		info.ext.fixed.z = layout == GraphResourceLayout::Texture3D ? fields.depth : 1;
+		info.expectedDimension = layout == GraphResourceLayout::Texture1D ? VK_IMAGE_TYPE_1D :
+			(layout == GraphResourceLayout::Texture2D ? VK_IMAGE_TYPE_2D : VK_IMAGE_TYPE_3D);
+
+		if (info.ext.fixed.x == 0 || info.ext.fixed.y == 0 || info.ext.fixed.z == 0)
+		{
+			error = layout == GraphResourceLayout::Texture2D ? "texture2d should have a positive screen-scale or width and height" : "extent of image should be positive";
+			return false;
+		}
+		return true;
+	}
+
+	static opt<RenderPassAttachment> AddGraphAttachment(RenderPass* pass, const GraphAttachmentRecord& desc, ResourceHandle handle, ResourceInfo info, const char*& error)
+	{
+		if (info.IsBuffer())
+		{
+			BufferSlice range = { info.ext.buffer.size, 0 };
+
+			GraphAttachmentUsage usage = (GraphAttachmentUsage)desc.usage;
+			if (usage == GraphAttachmentUsage::Default)
+			{
+				usage = desc.output ? GraphAttachmentUsage::Storage : GraphAttachmentUsage::Uniform;
+			}
+
+			if (usage == GraphAttachmentUsage::Storage)
+			{
+				return desc.output ? pass->AddBufferStorageOutput(handle, range) : pass->AddBufferStorageInput(handle, range);
+			}
+			if (usage == GraphAttachmentUsage::RayTracing)
+			{
+				return desc.output ? pass->AddBufferRTOutput(handle, range) : pass->AddBufferRTInput(handle, range);
+			}
+			if (usage == GraphAttachmentUsage::Uniform && !desc.output)
+			{
+				return pass->AddBufferInput(handle, range);
+			}
+			if (usage == GraphAttachmentUsage::StorageReadWrite && desc.output)
+			{
+				return pass->AddBufferStorageInputOutput(handle, range);
+			}
+
+			error = "usage is not supported by buffers";
+			return std::nullopt;
+		}
+
+		bool depthFormat = GetFormatStencilSize(info.format) != 0 || info.format == VK_FORMAT_D16_UNORM || info.format == VK_FORMAT_D32_SFLOAT;
+
+		ImageSlice range;
+		range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		range.baseMipLevel = desc.mipIdx;
+		range.levelCount = 1;
+		range.baseArrayLayer = 0;
+		range.layerCount = info.channelCount;
+
+		VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;
+		if (info.expectedDimension == VK_IMAGE_TYPE_1D)
+		{
+			viewType = info.channelCount > 1 ? VK_IMAGE_VIEW_TYPE_1D_ARRAY : VK_IMAGE_VIEW_TYPE_1D;
+		}
+		else if (info.expectedDimension == VK_IMAGE_TYPE_3D)
+		{
+			viewType = VK_IMAGE_VIEW_TYPE_3D;
+		}
+		else
+		{
+			viewType = info.channelCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+		}
+
+		GraphAttachmentUsage usage = (GraphAttachmentUsage)desc.usage;
+		if (usage == GraphAttachmentUsage::Default)
+		{
+			usage = desc.output ? (depthFormat ? GraphAttachmentUsage::Depth : GraphAttachmentUsage::Color) : GraphAttachmentUsage::Sampled;
+		}
+
+		switch (usage)
+		{
+		case GraphAttachmentUsage::Color:
+			if (desc.output) return pass->AddImageColorOutput(handle, range, viewType);
+			return pass->AddImageColorInput(handle, range, viewType);
+		case GraphAttachmentUsage::Depth:
+			if (!desc.output) break;
+			range.aspectMask = GetFormatStencilSize(info.format) != 0 ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+			return pass->AddImageDepthOutput(handle, range, viewType);
+		case GraphAttachmentUsage::Sampled:
+			if (desc.output) break;
+			range.aspectMask = depthFormat ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			return pass->AddImageColorInput(handle, range, viewType);
+		case GraphAttachmentUsage::Storage:
+			if (desc.output) return pass->AddImageStorageOutput(handle, range, viewType);
+			return pass->AddImageStorageInput(handle, range, viewType);
+		case GraphAttachmentUsage::RayTracing:
+			if (desc.output) return pass->AddImageRTOutput(handle, range, viewType);
+			return pass->AddImageRTInput(handle, range, viewType);
+		case GraphAttachmentUsage::RayTracingSampled:
+			if (desc.output) break;
+			return pass->AddImageRTSampledInput(handle, range, viewType);
+		case GraphAttachmentUsage::ColorReadWrite:
+			if (!desc.output) break;
+			return pass->AddImageColorInputOutput(handle, range, viewType);
+		case GraphAttachmentUsage::StorageReadWrite:
+			if (!desc.output) break;
+			return pass->AddImageStorageInputOutput(handle, range, viewType);
+		default:
+			break;
+		}
+
+		error = "usage is not supported by images in this direction";
+		return std::nullopt;
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::LoadFromJson(const char* path, std::string* msg)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			if (msg != NULL) *msg = std::string("fail to open render graph file ") + path;
+			return std::nullopt;
+		}
+
+		std::string json;
+		file.seekg(0, std::ios::end);
+		json.resize((size_t)file.tellg());
+		file.seekg(0, std::ios::beg);
+		file.read(json.data(), json.size());
+
+		return LoadFromJsonString(json, msg);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::LoadFromJsonString(std::string_view json, std::string* msg)
+	{
+		VKRG_TRACE_SCOPE("RenderGraph::LoadFromJsonString");
+
+		JsonGraphDocument doc;
+		if (!ParseJsonGraphDocument(json, doc, msg)) return std::nullopt;
+
+		return BuildFromRecords(doc.Records(), msg);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::LoadFromBinary(const char* path, std::string* msg)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+		{
+			if (msg != NULL) *msg = std::string("fail to map render graph file ") + path;
+			return std::nullopt;
+		}
+
+		// names are copied by the graph, the file could be unmapped after building
+		return LoadFromBinaryMemory(file.Data(), file.Size(), msg);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::LoadFromBinaryMemory(const void* data, size_t size, std::string* msg)
+	{
+		VKRG_TRACE_SCOPE("RenderGraph::LoadFromBinaryMemory");
+
+		GraphRecords records;
+		if (!ReadGraphBinary(data, size, records, msg)) return std::nullopt;
+
+		return BuildFromRecords(records, msg);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::BuildFromRecords(const GraphRecords& records, std::string* msg)
+	{
+		std::string prefix = "Render graph description error: ";
+		auto error = [&](const std::string& err) -> opt<ptr<RenderGraph>>
+		{
+			if (msg != NULL) *msg = prefix + err;
+			return std::nullopt;
+		};
+		auto name = [&](uint32_t id) { return std::string(records.names[id]); };
+
+		ptr<RenderGraph> graph = std::make_shared<RenderGraph>();
+		const char* err = NULL;
+
+		// resources are declared by the resource list and attachments with extent, passes by the pass list
+		uint32_t maxResourceCount = records.resourceCount;
+		for (uint32_t i = 0; i < records.attachmentCount; i++)
+		{
+			maxResourceCount += (records.attachments[i].fields.flags & GraphRecordHasExtent) ? 1 : 0;
+		}
+		graph->m_LogicalResourceList.reserve(maxResourceCount);
+		graph->m_LogicalResourceTable.reserve(maxResourceCount);
+		graph->m_RenderPassList.reserve(records.passCount);
+		graph->m_RenderPassTable.reserve(records.passCount);
+		graph->m_ExtraPassEdges.reserve(records.edgeCount);
+
+		// name id to handles, names of passes and resources are only hashed once by the graph
+		std::vector<uint32_t> resourceTable(records.names.size(), invalidIdx);
+		std::vector<uint32_t> passTable(records.names.size(), invalidIdx);
+
+		auto addResource = [&](uint32_t name, const GraphResourceFieldsRecord& fields, bool external, VkImageLayout finalLayout)
+		{
+			ResourceInfo info;
+			if (!BuildGraphResourceInfo(fields, info, err)) return false;
+			if (auto handle = graph->AddGraphResource(records.names[name], info, external, finalLayout); handle.has_value())
+			{
+				resourceTable[name] = handle.value().idx;
+				return true;
+			}
+			err = "resource is declared twice";
+			return false;
+		};
+
+		for (uint32_t i = 0; i < records.resourceCount; i++)
+		{
+			auto& resource = records.resources[i];
+			if (!addResource(resource.name, resource.fields, (resource.fields.flags & GraphRecordExternal) != 0, (VkImageLayout)resource.finalLayout))
+			{
+				return error("resource " + name(resource.name) + ": " + err);
+			}
+		}
+
+		// resources could be declared by any attachment having an extent, so inputs could refer to outputs of later passes
+		for (uint32_t i = 0; i < records.attachmentCount; i++)
+		{
+			auto& attachment = records.attachments[i];
+			if (!(attachment.fields.flags & GraphRecordHasExtent) || resourceTable[attachment.resource] != invalidIdx) continue;
+			if (!addResource(attachment.resource, attachment.fields, false, VK_IMAGE_LAYOUT_UNDEFINED))
+			{
+				return error("resource " + name(attachment.resource) + ": " + err);
+			}
+		}
+
+		std::vector<RenderPassAttachment> attachments;
+		for (uint32_t passIdx = 0; passIdx < records.passCount; passIdx++)
+		{
+			auto& passDesc = records.passes[passIdx];
+			const char* passName = records.names[passDesc.name];
+
+			// passes without extent use the extent of their first image attachment
+			RenderPassExtension extension;
+			if (passDesc.extension.flags & GraphRecordHasExtent)
+			{
+				if (passDesc.extension.screenScale > 0)
+				{
+					extension.extensionType = ResourceExtensionType::Screen;
+					extension.extension.screen.x = passDesc.extension.screenScale;
+					extension.extension.screen.y = passDesc.extension.screenScale;
+				}
+				else
+				{
+					extension.extensionType = ResourceExtensionType::Fixed;
+					extension.extension.fixed.x = passDesc.extension.width;
+					extension.extension.fixed.y = vkrg_max(passDesc.extension.height, 1u);
+					extension.extension.fixed.z = vkrg_max(passDesc.extension.depth, 1u);
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0; i < passDesc.attachmentCount; i++)
+				{
+					uint32_t resourceIdx = resourceTable[records.attachments[passDesc.attachmentOffset + i].resource];
+					if (resourceIdx == invalidIdx) continue;
+
+					auto& info = graph->m_LogicalResourceList[resourceIdx].info;
+					if (info.IsBuffer()) continue;
+
+					extension.extensionType = info.extType;
+					extension.extension = info.ext;
+					break;
+				}
+			}
+
+			auto passHandle = graph->AddGraphRenderPass(passName, (RenderPassType)passDesc.type, extension);
+			if (!passHandle.has_value())
+			{
+				return error("pass " + name(passDesc.name) + " is declared twice");
+			}
+			passTable[passDesc.name] = passHandle.value().idx;
+			RenderPass* pass = passHandle.value().pass.get();
+
+			attachments.clear();
+			for (uint32_t i = 0; i < passDesc.attachmentCount; i++)
+			{
+				auto& desc = records.attachments[passDesc.attachmentOffset + i];
+				uint32_t resourceIdx = resourceTable[desc.resource];
+				if (resourceIdx == invalidIdx)
+				{
+					return error("pass " + name(passDesc.name) + ": resource " + name(desc.resource) + " is not declared");
+				}
+
+				ResourceInfo info = graph->m_LogicalResourceList[resourceIdx].info;
+				if ((desc.fields.flags & GraphRecordHasFormat) && desc.fields.format != info.format)
+				{
+					return error("pass " + name(passDesc.name) + ": format of " + name(desc.resource) + " doesn't match the declared resource");
+				}
+
+				err = "attachment is not compatible with the resource or the pass";
+				auto attachment = AddGraphAttachment(pass, desc, graph->m_LogicalResourceList[resourceIdx].handle, info, err);
+				if (!attachment.has_value())
+				{
+					return error("pass " + name(passDesc.name) + ": invalid attachment " + name(desc.resource) + ", " + err);
+				}
+				attachments.push_back(attachment.value());
+			}
+
+			// passes without prototype should get their interfaces attached before compiling
+			if (passDesc.prototype != NameInterner::invalidId)
+			{
+				auto factory = RenderPassPrototypeRegistry::Global().Find(records.names[passDesc.prototype]);
+				if (factory == NULL)
+				{
+					return error("pass " + name(passDesc.name) + ": prototype " + name(passDesc.prototype) + " is not registered");
+				}
+
+				auto rpi = (*factory)(pass, attachments);
+				if (rpi == nullptr)
+				{
+					return error("pass " + name(passDesc.name) + ": prototype " + name(passDesc.prototype) + " fails to create interface");
+				}
+				pass->AttachInterface(rpi);
+			}
+		}
+
+		for (uint32_t i = 0; i < records.edgeCount; i++)
+		{
+			auto& edge = records.edges[i];
+			uint32_t outPass = passTable[edge.outPass], inPass = passTable[edge.inPass];
+			if (outPass == invalidIdx || inPass == invalidIdx)
+			{
+				return error("edge from " + name(edge.outPass) + " to " + name(edge.inPass) + " refers to undeclared pass");
+			}
+			graph->AddEdge(graph->m_RenderPassList[outPass], graph->m_RenderPassList[inPass]);
+		}
+
+		return graph;
+	}
+}
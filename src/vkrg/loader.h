@@ -0,0 +1,209 @@
+#pragma once
+#include "vkrg/pass.h"
+#include <string_view>
+#include <ostream>
+#include <chrono>
+#include <filesystem>
+
+namespace vkrg
+{
+	enum class GraphResourceLayout : uint32_t
+	{
+		Unspecified,
+		Texture1D,
+		Texture2D,
+		Texture3D,
+		Buffer
+	};
+
+	// how a pass accesses an attachment, combined with direction and resource kind to choose the attachment type
+	enum class GraphAttachmentUsage : uint32_t
+	{
+		Default,
+		Color,
+		Depth,
+		Sampled,
+		Storage,
+		RayTracing,
+		RayTracingSampled,
+		Uniform,
+		// read-write attachments, only valid as outputs
+		ColorReadWrite,
+		StorageReadWrite
+	};
+
+	enum GraphRecordFlags : uint32_t
+	{
+		GraphRecordHasFormat = 1,
+		GraphRecordHasExtent = 2,
+		GraphRecordExternal = 4
+	};
+
+	// records are stored in binary graph files as they are, fields have fixed size and the layout should not change without a version bump
+	struct GraphResourceFieldsRecord
+	{
+		uint64_t size;
+		float	 screenScale;
+		uint32_t layout;
+		uint32_t format;
+		uint32_t flags;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+		uint32_t channelCount;
+		uint32_t mipCount;
+		// usages other than the ones added by attachments, VkImageUsageFlags or VkBufferUsageFlags depending on layout
+		uint32_t usages;
+	};
+
+	struct GraphResourceRecord
+	{
+		GraphResourceFieldsRecord fields;
+		uint32_t				  name;
+		uint32_t				  finalLayout;
+	};
+
+	struct GraphAttachmentRecord
+	{
+		// attachments with extent declare the resource if it is not declared anywhere else
+		GraphResourceFieldsRecord fields;
+		uint32_t				  resource;
+		uint32_t				  usage;
+		uint32_t				  mipIdx;
+		uint32_t				  output;
+	};
+
+	struct GraphPassRecord
+	{
+		// the extent of the pass, only valid with GraphRecordHasExtent
+		GraphResourceFieldsRecord extension;
+		uint32_t				  name;
+		uint32_t				  prototype;
+		uint32_t				  type;
+		uint32_t				  attachmentOffset;
+		uint32_t				  attachmentCount;
+		uint32_t				  reserved;
+	};
+
+	struct GraphEdgeRecord
+	{
+		uint32_t outPass;
+		uint32_t inPass;
+	};
+
+	static_assert(sizeof(GraphResourceFieldsRecord) == 48 && sizeof(GraphResourceRecord) == 56 && sizeof(GraphAttachmentRecord) == 64
+		&& sizeof(GraphPassRecord) == 72 && sizeof(GraphEdgeRecord) == 8, "layout of binary graph records should not change");
+
+	/// <summary>
+	/// Records of a graph description, names are ids into the name array.
+	/// Records are owned by the json document or the mapped binary file they come from.
+	/// </summary>
+	struct GraphRecords
+	{
+		std::vector<const char*>	 names;
+		const GraphResourceRecord*	 resources = NULL;
+		uint32_t					 resourceCount = 0;
+		const GraphPassRecord*		 passes = NULL;
+		uint32_t					 passCount = 0;
+		const GraphAttachmentRecord* attachments = NULL;
+		uint32_t					 attachmentCount = 0;
+		const GraphEdgeRecord*		 edges = NULL;
+		uint32_t					 edgeCount = 0;
+	};
+
+	/// <summary>
+	/// Header of binary graph files, followed by the string table and records at the offsets in the header.
+	/// Strings are null terminated, every section starts at a multiple of 8 bytes.
+	/// Files are written in the byte order of the writer, only little endian files are accepted.
+	/// </summary>
+	struct GraphBinaryHeader
+	{
+		static constexpr uint32_t magicNumber = 0x47524b56; // "VKRG"
+		static constexpr uint32_t currentVersion = 1;
+
+		uint32_t magic;
+		uint32_t version;
+		uint32_t stringCount;
+		uint32_t resourceCount;
+		uint32_t passCount;
+		uint32_t attachmentCount;
+		uint32_t edgeCount;
+		uint32_t reserved;
+		// offset and length of every string in the string data
+		uint64_t stringRecordOffset;
+		uint64_t stringDataOffset;
+		uint64_t stringDataSize;
+		uint64_t resourceOffset;
+		uint64_t passOffset;
+		uint64_t attachmentOffset;
+		uint64_t edgeOffset;
+		uint64_t fileSize;
+	};
+
+	/// <summary>
+	/// Read only memory map of a whole file.
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		bool		Open(const char* path);
+		void		Close();
+
+		const void* Data();
+		size_t		Size();
+
+	private:
+		const void* m_Data = NULL;
+		size_t		m_Size = 0;
+		// file mapping object on windows
+		void*		m_Mapping = NULL;
+	};
+
+	// the binary file has the same content as the json document, passes and resources are in the same order
+	bool ConvertGraphJsonToBinary(std::string_view json, std::vector<char>& binary, std::string* msg = NULL);
+	bool ConvertGraphBinaryToJson(const void* data, size_t size, std::ostream& os, std::string* msg = NULL);
+
+	/// <summary>
+	/// Polls the last write time of a graph file, cheap enough to be polled every frame.
+	/// Reload the graph with RenderGraph::ReloadFromJson or ReloadFromBinary when Poll returns true.
+	/// </summary>
+	class RenderGraphFileWatcher
+	{
+	public:
+		RenderGraphFileWatcher(const std::string& path);
+
+		// returns true once after every modification, a missing file is not a modification
+		bool			   Poll();
+		const std::string& GetPath();
+
+	private:
+		std::string						m_Path;
+		std::filesystem::file_time_type m_LastWriteTime;
+	};
+
+	// creates the interface of a pass loaded from a json or binary graph, attachments are in the order they are declared in the document
+	using RenderPassPrototypeFactory = std::function<ptr<RenderPassInterface>(RenderPass* pass, const std::vector<RenderPassAttachment>& attachments)>;
+
+	/// <summary>
+	/// Prototypes are classes deriving RenderPassInterface, passes loaded from json refer to them by name.
+	/// Prototypes should be registered before loading graphs.
+	/// </summary>
+	class RenderPassPrototypeRegistry
+	{
+	public:
+		static RenderPassPrototypeRegistry& Global();
+
+		// returns false if the prototype has been registered
+		bool							  Register(const std::string& prototype, RenderPassPrototypeFactory factory);
+		const RenderPassPrototypeFactory* Find(std::string_view prototype);
+
+	private:
+		NameInterner					  m_Names;
+		std::vector<RenderPassPrototypeFactory> m_Factories;
+	};
+}
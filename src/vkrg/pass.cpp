@@ -85,15 +85,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageColorOutput(const char* name, ImageSlice range, VkImageViewType    viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageColorOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageColorOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Graphics)
 		{
@@ -121,15 +119,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageDepthOutput(const char* name, ImageSlice range, VkImageViewType    viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageDepthOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageDepthOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Graphics)
 		{
@@ -159,15 +155,13 @@ namespace vkrg {
 	/*
 	opt<RenderPassAttachment> RenderPass::AddImageDepthInput(const char* name, ImageSlice range, VkImageViewType viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageDepthInput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageDepthInput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -196,15 +190,13 @@ namespace vkrg {
 	*/
 	opt<RenderPassAttachment> RenderPass::AddImageColorInput(const char* name, ImageSlice range, VkImageViewType    viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageColorInput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageColorInput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -230,15 +222,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageStorageInput(const char* name, ImageSlice range, VkImageViewType  viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageStorageInput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageStorageInput(ResourceHandle handle, ImageSlice range, VkImageViewType  viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -264,15 +254,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageStorageOutput(const char* name, ImageSlice range, VkImageViewType    viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageStorageOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageStorageOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -298,16 +286,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageRTSampledInput(const char* name, ImageSlice range, VkImageViewType viewType)
 	{
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageRTSampledInput(res.value(), range, viewType);
+		return std::nullopt;
+	}
 
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+	opt<RenderPassAttachment> RenderPass::AddImageRTSampledInput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Raytracing)
 		{
@@ -333,15 +318,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageRTInput(const char* name, ImageSlice range, VkImageViewType viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageRTInput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageRTInput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Raytracing)
 		{
@@ -367,15 +350,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddImageRTOutput(const char* name, ImageSlice range, VkImageViewType viewType)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageRTOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageRTOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Raytracing)
 		{
@@ -401,15 +382,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddBufferRTInput(const char* name, BufferSlice range)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferRTInput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferRTInput(ResourceHandle handle, BufferSlice range)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Raytracing)
 		{
@@ -439,15 +418,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddBufferRTOutput(const char* name, BufferSlice range)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferRTOutput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferRTOutput(ResourceHandle handle, BufferSlice range)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType != RenderPassType::Raytracing)
 		{
@@ -476,15 +453,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddBufferStorageInput(const char* name, BufferSlice range)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferStorageInput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferStorageInput(ResourceHandle handle, BufferSlice range)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		auto resInfo = m_Graph->GetResourceInfo(handle);
 		if (range.size == 0xffffffff)
@@ -513,15 +488,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddBufferStorageOutput(const char* name, BufferSlice range)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferStorageOutput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferStorageOutput(ResourceHandle handle, BufferSlice range)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -550,15 +523,13 @@ namespace vkrg {
 
 	opt<RenderPassAttachment> RenderPass::AddBufferInput(const char* name, BufferSlice range)
 	{
-		ResourceHandle handle;
-		if (auto res = m_Graph->FindGraphResource(name); res.has_value())
-		{
-			handle = res.value();
-		}
-		else
-		{
-			return std::nullopt;
-		}
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferInput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferInput(ResourceHandle handle, BufferSlice range)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
 
 		if (m_RenderPassType == RenderPassType::Raytracing)
 		{
@@ -585,6 +556,88 @@ namespace vkrg {
 		return attachment;
 	}
 
+	opt<RenderPassAttachment> RenderPass::AddImageColorInputOutput(const char* name, ImageSlice range, VkImageViewType viewType)
+	{
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageColorInputOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageColorInputOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		if (range.aspectMask != VK_IMAGE_ASPECT_COLOR_BIT) return std::nullopt;
+
+		RenderPassAttachment attachment{};
+		attachment.type = RenderPassAttachment::ImageColorInputOutput;
+		attachment.range.imageRange = range;
+		attachment.viewType = viewType;
+		return AddInputOutputAttachment(handle, attachment);
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageStorageInputOutput(const char* name, ImageSlice range, VkImageViewType viewType)
+	{
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddImageStorageInputOutput(res.value(), range, viewType);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddImageStorageInputOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType)
+	{
+		RenderPassAttachment attachment{};
+		attachment.type = RenderPassAttachment::ImageStorageInputOutput;
+		attachment.range.imageRange = range;
+		attachment.viewType = viewType;
+		return AddInputOutputAttachment(handle, attachment);
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferStorageInputOutput(const char* name, BufferSlice range)
+	{
+		if (auto res = m_Graph->FindGraphResource(name); res.has_value()) return AddBufferStorageInputOutput(res.value(), range);
+		return std::nullopt;
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddBufferStorageInputOutput(ResourceHandle handle, BufferSlice range)
+	{
+		RenderPassAttachment attachment{};
+		attachment.type = RenderPassAttachment::BufferStorageInputOutput;
+		attachment.range.bufferRange = range;
+		return AddInputOutputAttachment(handle, attachment);
+	}
+
+	opt<RenderPassAttachment> RenderPass::AddInputOutputAttachment(ResourceHandle handle, RenderPassAttachment attachment)
+	{
+		if (!m_Graph->GetGraphResource(handle.idx).has_value()) return std::nullopt;
+
+		// color attachments are only loaded in graphics passes, storage resources are not accessible by ray tracing passes
+		bool colorAttachment = attachment.type == RenderPassAttachment::ImageColorInputOutput;
+		if (colorAttachment ? m_RenderPassType != RenderPassType::Graphics : m_RenderPassType == RenderPassType::Raytracing)
+		{
+			return std::nullopt;
+		}
+
+		auto resInfo = m_Graph->GetResourceInfo(handle);
+		if (attachment.IsImage())
+		{
+			if (!CheckAttachmentCompality(m_ExpectedExtension, attachment.range.imageRange, resInfo)
+				|| !CheckAttachmentViewCompality(resInfo, attachment.range.imageRange, attachment.viewType))
+				return std::nullopt;
+		}
+		else
+		{
+			if (attachment.range.bufferRange.size == 0xffffffff)
+			{
+				attachment.range.bufferRange.size = resInfo.ext.buffer.size;
+			}
+			if (!CheckAttachmentCompality(attachment.range.bufferRange, resInfo)) return std::nullopt;
+		}
+
+		attachment.idx = m_Attachments.size();
+		attachment.targetPass = this;
+
+		m_Attachments.push_back(attachment);
+		m_AttachmentResourceHandle.push_back(handle);
+
+		return attachment;
+	}
+
 	void RenderPass::AttachInterface(ptr<RenderPassInterface> inter)
 	{
 		m_RenderPassInterface = inter;
@@ -600,12 +653,20 @@ namespace vkrg {
 	{
 		vkrg_assert(idx.targetPass == this);
 		m_RenderPassInterface->GetAttachmentStoreLoadOperation(idx.idx, state.load, state.store, state.stencilLoad, state.stencilStore);
+
+		// content written before the pass is preserved
+		if (idx.type == RenderPassAttachment::Type::ImageColorInputOutput)
+		{
+			state.load = VK_ATTACHMENT_LOAD_OP_LOAD;
+			state.store = VK_ATTACHMENT_STORE_OP_STORE;
+		}
 	}
 
 	VkImageLayout RenderPass::GetAttachmentExpectedState(const RenderPassAttachment& idx)
 	{
 		VkImageLayout initGuess = VK_IMAGE_LAYOUT_UNDEFINED;
-		if (idx.type == RenderPassAttachment::Type::ImageColorOutput)
+		if (idx.type == RenderPassAttachment::Type::ImageColorOutput
+			|| idx.type == RenderPassAttachment::Type::ImageColorInputOutput)
 		{
 			initGuess = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
@@ -619,6 +680,7 @@ namespace vkrg {
 			initGuess = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		}
 		else if (idx.type == RenderPassAttachment::Type::ImageStorageOutput
+			|| idx.type == RenderPassAttachment::Type::ImageStorageInputOutput
 			|| idx.type == RenderPassAttachment::Type::ImageRTOutput)
 		{
 			initGuess = VK_IMAGE_LAYOUT_GENERAL;
@@ -667,9 +729,39 @@ namespace vkrg {
 		m_RenderPassInterface->OnRender(ctx, cmd);
 	}
 
+	bool RenderPass::RequireOrderedRecording()
+	{
+		return m_RenderPassInterface->RequireOrderedRecording();
+	}
+
 	RenderPassExtension RenderPass::GetRenderPassExtension()
 	{
-		return m_ExpectedExtension;
+		RenderPassExtension extension = m_ExpectedExtension;
+		for (uint32_t i = 0; i < m_Attachments.size() && !extension.nativeResolution; i++)
+		{
+			extension.nativeResolution = m_Attachments[i].WriteToResource() && m_AttachmentResourceHandle[i].external;
+		}
+		return extension;
+	}
+
+	void RenderPass::SetNativeResolution(bool nativeResolution)
+	{
+		m_ExpectedExtension.nativeResolution = nativeResolution;
+	}
+
+	void RenderPass::SetEnablePredicate(std::function<bool(uint32_t frameIdx)> predicate)
+	{
+		m_EnablePredicate = predicate;
+	}
+
+	bool RenderPass::IsConditional()
+	{
+		return m_EnablePredicate != nullptr;
+	}
+
+	bool RenderPass::IsEnabled(uint32_t frameIdx)
+	{
+		return m_EnablePredicate == nullptr || m_EnablePredicate(frameIdx);
 	}
 
 	bool RenderPass::ValidationCheck(std::string& msg)
@@ -688,7 +780,8 @@ namespace vkrg {
 
 		for (auto& attachment : m_Attachments)
 		{
-			if (attachment.type == RenderPassAttachment::BufferStorageOutput || attachment.type == RenderPassAttachment::ImageStorageOutput)
+			if (attachment.type == RenderPassAttachment::BufferStorageOutput || attachment.type == RenderPassAttachment::ImageStorageOutput
+				|| attachment.type == RenderPassAttachment::BufferStorageInputOutput || attachment.type == RenderPassAttachment::ImageStorageInputOutput)
 			{
 				if (m_RenderPassType != RenderPassType::Compute)
 				{
@@ -696,7 +789,7 @@ namespace vkrg {
 					return false;
 				}
 			}
-			if (attachment.type == RenderPassAttachment::ImageColorOutput)
+			if (attachment.type == RenderPassAttachment::ImageColorOutput || attachment.type == RenderPassAttachment::ImageColorInputOutput)
 			{
 				if (GetAttachmentExpectedState(attachment) != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
 				{
@@ -735,26 +828,34 @@ namespace vkrg {
 	bool RenderPassAttachment::WriteToResource() const
 	{
 		return type == RenderPassAttachment::ImageColorOutput || type == RenderPassAttachment::ImageDepthOutput || type == RenderPassAttachment::ImageStorageOutput
-			|| type == RenderPassAttachment::BufferStorageOutput || type == RenderPassAttachment::ImageRTOutput;
+			|| type == RenderPassAttachment::BufferStorageOutput || type == RenderPassAttachment::ImageRTOutput || IsReadWrite();
 	}
 
 	bool RenderPassAttachment::ReadFromResource() const
 	{
 		return type == RenderPassAttachment::ImageColorInput || type == RenderPassAttachment::BufferStorageInput || type == RenderPassAttachment::ImageStorageInput
-			|| type == RenderPassAttachment::ImageDepthInput || type == RenderPassAttachment::ImageRTInput || type == RenderPassAttachment::ImageRTSampledInput;
+			|| type == RenderPassAttachment::ImageDepthInput || type == RenderPassAttachment::ImageRTInput || type == RenderPassAttachment::ImageRTSampledInput
+			|| IsReadWrite();
 	}
 
 	bool RenderPassAttachment::IsImage() const
 	{
 		return type == RenderPassAttachment::ImageColorInput || type == RenderPassAttachment::ImageDepthOutput || type == RenderPassAttachment::ImageStorageOutput
 			|| type == RenderPassAttachment::ImageColorOutput || type == RenderPassAttachment::ImageStorageInput || type == RenderPassAttachment::ImageRTSampledInput
-			|| type == RenderPassAttachment::ImageRTInput || type == RenderPassAttachment::ImageRTOutput;
+			|| type == RenderPassAttachment::ImageRTInput || type == RenderPassAttachment::ImageRTOutput || type == RenderPassAttachment::ImageColorInputOutput
+			|| type == RenderPassAttachment::ImageStorageInputOutput;
 	}
 
 	bool RenderPassAttachment::IsBuffer() const
 	{
 		return type == RenderPassAttachment::BufferInput || type == RenderPassAttachment::BufferStorageInput || type == RenderPassAttachment::BufferStorageOutput
-			|| type == RenderPassAttachment::BufferRTInput || type == RenderPassAttachment::BufferRTOutput;
+			|| type == RenderPassAttachment::BufferRTInput || type == RenderPassAttachment::BufferRTOutput || type == RenderPassAttachment::BufferStorageInputOutput;
+	}
+
+	bool RenderPassAttachment::IsReadWrite() const
+	{
+		return type == RenderPassAttachment::ImageColorInputOutput || type == RenderPassAttachment::ImageStorageInputOutput
+			|| type == RenderPassAttachment::BufferStorageInputOutput;
 	}
 
 	RenderPassType RenderPass::GetType()
@@ -838,10 +939,20 @@ namespace vkrg {
 		ResourceHandle resource = m_Graph->m_RenderPassList[m_passIdx].pass->GetAttachedResourceHandles()[attachment.idx];
 
 		ResourceInfo& info = m_Graph->m_LogicalResourceList[resource.idx].info;
-		auto [w, h, d] = m_Graph->GetExpectedExtension(info.ext, info.extType);
+		auto [w, h, d] = m_Graph->GetRenderExtension(info.ext, info.extType, m_Graph->m_NativeResolutionResources[resource.idx]);
 		return VkExtent3D{ w >> mipLevel, h >> mipLevel ,d };
 	}
 
+	VkRect2D RenderPassRuntimeContext::GetRenderArea()
+	{
+		return std::get<0>(m_Graph->GetRenderArea(m_Graph->m_RenderPassList[m_passIdx].pass->GetRenderPassExtension()));
+	}
+
+	VkViewport RenderPassRuntimeContext::GetViewport()
+	{
+		return std::get<1>(m_Graph->GetRenderArea(m_Graph->m_RenderPassList[m_passIdx].pass->GetRenderPassExtension()));
+	}
+
 	// TODO dirty flag for every view
 	bool RenderPassRuntimeContext::CheckAttachmentDirtyFlag(RenderPassAttachment attachment)
 	{
@@ -849,6 +960,6 @@ namespace vkrg {
 		auto& resource = rp.pass->m_AttachmentResourceHandle[attachment.idx];
 
 		auto& resourceAssignment = m_Graph->m_LogicalResourceAssignmentTable[resource.idx];
-		return m_Graph->GetAssignedResourceBinding(resourceAssignment)->dirtyFlag;
+		return m_Graph->IsResourceBindingDirty(resourceAssignment.external, resourceAssignment.idx);
 	}
 }
@@ -39,6 +39,12 @@ namespace vkrg
 
 			BufferRTInput,
 			BufferRTOutput,
+
+			// read the content written before the pass and write it in place
+			// color attachments are always loaded, storage images are in general layout
+			ImageColorInputOutput,
+			ImageStorageInputOutput,
+			BufferStorageInputOutput,
 		} type;
 
 		VkImageViewType    viewType;
@@ -53,6 +59,8 @@ namespace vkrg
 
 		bool WriteToResource() const;
 		bool ReadFromResource() const;
+		// both reads and writes the resource
+		bool IsReadWrite() const;
 
 		bool IsImage() const;
 		bool IsBuffer() const;
@@ -75,14 +83,17 @@ namespace vkrg
 			extensionType = ResourceExtensionType::Screen;
 			extension.screen.x = 1;
 			extension.screen.y = 1;
+			nativeResolution = false;
 		}
 
 		ResourceInfo::Extension extension;
 		ResourceExtensionType   extensionType;
+		// screen relative passes at native resolution ignore the render scale of the graph
+		bool					nativeResolution;
 
 		bool operator==(const RenderPassExtension& other) const
 		{
-			if (extensionType != other.extensionType) return false;
+			if (extensionType != other.extensionType || nativeResolution != other.nativeResolution) return false;
 			if (extensionType == ResourceExtensionType::Fixed)
 			{
 				return extension.fixed.x == other.extension.fixed.x &&
@@ -118,7 +129,12 @@ namespace vkrg
 		VkImageLayout	GetImageLayout(RenderPassAttachment attachment);
 
 		VkImageSubresourceRange GetImageViewRange(RenderPassAttachment attachment);
+		// extent rendered in current frame, screen relative images are scaled by render scale of the graph
+		// the allocated extent of the image could be queried by GetImage()->Info()
 		VkExtent3D				GetImageExtent(RenderPassAttachment attachment, uint32_t mipLevel = 0);
+		// render area of the pass in current frame, viewport and scissor of graphics passes are set to it before OnRender
+		VkRect2D				GetRenderArea();
+		VkViewport				GetViewport();
 
 		bool		CheckAttachmentDirtyFlag(RenderPassAttachment attachment);
 
@@ -133,6 +149,7 @@ namespace vkrg
 	class RenderPass
 	{
 		friend class RenderPassRuntimeContext;
+		friend class RenderGraph;
 	public:
 		RenderPass(RenderGraph* graph, const char* name, RenderPassType type, RenderPassExtension expectedExtension);
 
@@ -155,16 +172,49 @@ namespace vkrg
 		opt<RenderPassAttachment> AddBufferStorageOutput(const char* name, BufferSlice range);
 		opt<RenderPassAttachment> AddBufferInput(const char* name, BufferSlice range);
 
+		opt<RenderPassAttachment> AddImageColorInputOutput(const char* name, ImageSlice range, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D);
+		opt<RenderPassAttachment> AddImageStorageInputOutput(const char* name, ImageSlice range, VkImageViewType viewType);
+		opt<RenderPassAttachment> AddBufferStorageInputOutput(const char* name, BufferSlice range);
+
+		// handles returned by RenderGraph::FindGraphResource or AddGraphResource, attaching by handles doesn't look up names
+		opt<RenderPassAttachment> AddImageColorOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType = VK_IMAGE_VIEW_TYPE_2D);
+		opt<RenderPassAttachment> AddImageDepthOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType = VK_IMAGE_VIEW_TYPE_2D);
+		opt<RenderPassAttachment> AddImageColorInput(ResourceHandle handle, ImageSlice range, VkImageViewType	 viewType);
+		opt<RenderPassAttachment> AddImageStorageInput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType);
+		opt<RenderPassAttachment> AddImageStorageOutput(ResourceHandle handle, ImageSlice range, VkImageViewType    viewType);
+		opt<RenderPassAttachment> AddImageRTSampledInput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType);
+		opt<RenderPassAttachment> AddImageRTInput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType);
+		opt<RenderPassAttachment> AddImageRTOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType);
+		opt<RenderPassAttachment> AddBufferRTInput(ResourceHandle handle, BufferSlice range);
+		opt<RenderPassAttachment> AddBufferRTOutput(ResourceHandle handle, BufferSlice range);
+		opt<RenderPassAttachment> AddBufferStorageInput(ResourceHandle handle, BufferSlice range);
+		opt<RenderPassAttachment> AddBufferStorageOutput(ResourceHandle handle, BufferSlice range);
+		opt<RenderPassAttachment> AddBufferInput(ResourceHandle handle, BufferSlice range);
+		opt<RenderPassAttachment> AddImageColorInputOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D);
+		opt<RenderPassAttachment> AddImageStorageInputOutput(ResourceHandle handle, ImageSlice range, VkImageViewType viewType);
+		opt<RenderPassAttachment> AddBufferStorageInputOutput(ResourceHandle handle, BufferSlice range);
+
 		void					  AttachInterface(ptr<RenderPassInterface> inter);
 
+		// the predicate is evaluated every frame, the pass is skipped when it returns false
+		// it must be set before compiling the graph, passes with predicate won't be merged with other passes
+		// the predicate is called once per frame before commands are recorded
+		void					  SetEnablePredicate(std::function<bool(uint32_t frameIdx)> predicate);
+		bool					  IsConditional();
+		bool					  IsEnabled(uint32_t frameIdx);
+
 		ResourceInfo			  GetAttachmentInfo(const RenderPassAttachment& idx);
 		void					  GetAttachmentOperationState(const RenderPassAttachment& idx, RenderPassAttachmentOperationState& state);
 		VkImageLayout			  GetAttachmentExpectedState(const RenderPassAttachment& idx);
 		bool					  RequireClearColor(const RenderPassAttachment& idx);
 		void					  GetClearColor(const RenderPassAttachment& idx, VkClearValue& clearValue);
 		void					  OnRender(RenderPassRuntimeContext& ctx, VkCommandBuffer cmd);
+		bool					  RequireOrderedRecording();
 
+		// passes writing external resources like back buffers are always at native resolution
 		RenderPassExtension		  GetRenderPassExtension();
+		// upscaling passes writing internal images could opt out of the render scale, it must be set before compiling
+		void					  SetNativeResolution(bool nativeResolution);
 
 		bool					  ValidationCheck(std::string& msg);
 
@@ -178,6 +228,9 @@ namespace vkrg
 		bool		   IsGeneralPass();
 
 	private:
+		// shared by the read-write attachments, type, range and view type of the attachment are filled by the caller
+		opt<RenderPassAttachment> AddInputOutputAttachment(ResourceHandle handle, RenderPassAttachment attachment);
+
 		std::string name;
 
 		RenderGraph* m_Graph;
@@ -188,6 +241,8 @@ namespace vkrg
 		RenderPassType m_RenderPassType;
 
 		RenderPassExtension m_ExpectedExtension;
+
+		std::function<bool(uint32_t)> m_EnablePredicate;
 	};
 
 	class RenderPassInterface
@@ -212,6 +267,10 @@ namespace vkrg
 
 		virtual void OnRender(RenderPassRuntimeContext& ctx, VkCommandBuffer cmd) = 0;
 
+		// when recording in parallel, OnRender of this pass is called after OnRender of all passes it depends on
+		// useful when OnRender consumes cpu side data produced by previous passes
+		virtual bool RequireOrderedRecording() { return false; }
+
 		virtual RenderPassType ExpectedType() = 0;
 
 		void AttachRenderPass(RenderPass* renderPass)
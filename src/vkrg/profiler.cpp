@@ -0,0 +1,269 @@
+#include "profiler.h"
+
+namespace vkrg
+{
+	GpuProfiler::~GpuProfiler()
+	{
+		if (m_Context == nullptr) return;
+
+		for (uint32_t i = 0; i < m_FlightFrameCount; i++)
+		{
+			vkDestroyQueryPool(m_Context->GetDevice(), m_Frames[i].queryPool, NULL);
+		}
+	}
+
+	uint32_t GpuProfiler::AddScope(const std::string& name, uint32_t depth)
+	{
+		vkrg_assert(!m_Initialized);
+
+		GpuTiming scope;
+		scope.name = name;
+		scope.depth = depth;
+		scope.valid = false;
+		scope.milliseconds = 0;
+		m_Scopes.push_back(scope);
+
+		return m_Scopes.size() - 1;
+	}
+
+	void GpuProfiler::Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount)
+	{
+		vkrg_assert(flightFrameCount <= maxFrameOnFlightCount);
+
+		m_Context = ctx;
+		m_FlightFrameCount = flightFrameCount;
+
+		// every scope has a begin and an end timestamp
+		uint32_t queryCount = m_Scopes.size() * 2;
+
+		if (m_Context != nullptr)
+		{
+			VkPhysicalDeviceProperties properties{};
+			vkGetPhysicalDeviceProperties(m_Context->GetPhysicalDevice(), &properties);
+			m_TimestampPeriod = properties.limits.timestampPeriod;
+		}
+
+		for (uint32_t i = 0; i < m_FlightFrameCount; i++)
+		{
+			m_Frames[i].queryResults.resize(queryCount * 2);
+			m_Frames[i].timings = m_Scopes;
+
+			if (m_Context != nullptr && queryCount != 0)
+			{
+				VkQueryPoolCreateInfo info{};
+				info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+				info.queryCount = queryCount;
+
+				vkrg_assert(vkCreateQueryPool(m_Context->GetDevice(), &info, NULL, &m_Frames[i].queryPool) == VK_SUCCESS);
+			}
+		}
+
+		m_Initialized = true;
+	}
+
+	bool GpuProfiler::IsInitialized()
+	{
+		return m_Initialized;
+	}
+
+	void GpuProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t frameIdx)
+	{
+		auto& frame = m_Frames[frameIdx];
+		if (frame.submitted)
+		{
+			ResolveTimings(frameIdx);
+		}
+
+		uint32_t queryCount = m_Scopes.size() * 2;
+		if (frame.queryPool != NULL)
+		{
+			vkCmdResetQueryPool(cmd, frame.queryPool, 0, queryCount);
+		}
+		else
+		{
+			std::fill(frame.queryResults.begin(), frame.queryResults.end(), 0);
+		}
+		frame.submitted = true;
+	}
+
+	void GpuProfiler::BeginScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope)
+	{
+		WriteTimestamp(cmd, frameIdx, scope * 2, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+	}
+
+	void GpuProfiler::EndScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope)
+	{
+		WriteTimestamp(cmd, frameIdx, scope * 2 + 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	}
+
+	const std::vector<GpuTiming>& GpuProfiler::GetTimings(uint32_t frameIdx)
+	{
+		return m_Frames[frameIdx].timings;
+	}
+
+	void GpuProfiler::WriteTimestamp(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query, VkPipelineStageFlagBits stage)
+	{
+		auto& frame = m_Frames[frameIdx];
+		if (frame.queryPool != NULL)
+		{
+			vkCmdWriteTimestamp(cmd, stage, frame.queryPool, query);
+		}
+		else
+		{
+			frame.queryResults[query * 2] = m_SyntheticClock.fetch_add(syntheticTimestampStep) + syntheticTimestampStep;
+			frame.queryResults[query * 2 + 1] = 1;
+		}
+	}
+
+	void GpuProfiler::ResolveTimings(uint32_t frameIdx)
+	{
+		auto& frame = m_Frames[frameIdx];
+		uint32_t queryCount = m_Scopes.size() * 2;
+
+		// the frame using this pool has retired, queries not written in that frame are unavailable
+		if (frame.queryPool != NULL)
+		{
+			vkGetQueryPoolResults(m_Context->GetDevice(), frame.queryPool, 0, queryCount,
+				frame.queryResults.size() * sizeof(uint64_t), frame.queryResults.data(), sizeof(uint64_t) * 2,
+				VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		}
+
+		for (uint32_t scope = 0; scope < m_Scopes.size(); scope++)
+		{
+			uint64_t begin = frame.queryResults[scope * 4], beginAvailable = frame.queryResults[scope * 4 + 1];
+			uint64_t end = frame.queryResults[scope * 4 + 2], endAvailable = frame.queryResults[scope * 4 + 3];
+
+			auto& timing = frame.timings[scope];
+			timing.valid = beginAvailable != 0 && endAvailable != 0 && end >= begin;
+			timing.milliseconds = timing.valid ? (double)(end - begin) * m_TimestampPeriod * 1e-6 : 0;
+		}
+	}
+
+	PipelineStatisticsProfiler::~PipelineStatisticsProfiler()
+	{
+		if (m_Context == nullptr) return;
+
+		for (uint32_t i = 0; i < m_FlightFrameCount; i++)
+		{
+			vkDestroyQueryPool(m_Context->GetDevice(), m_Frames[i].queryPool, NULL);
+		}
+	}
+
+	uint32_t PipelineStatisticsProfiler::AddQuery(const std::string& name)
+	{
+		vkrg_assert(!m_Initialized);
+
+		GpuPipelineStatistics query{};
+		query.name = name;
+		query.valid = false;
+		m_Queries.push_back(query);
+
+		return m_Queries.size() - 1;
+	}
+
+	void PipelineStatisticsProfiler::Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount)
+	{
+		vkrg_assert(flightFrameCount <= maxFrameOnFlightCount);
+
+		m_Context = ctx;
+		m_FlightFrameCount = flightFrameCount;
+
+		uint32_t queryCount = m_Queries.size();
+		for (uint32_t i = 0; i < m_FlightFrameCount; i++)
+		{
+			m_Frames[i].queryResults.resize(queryCount * queryResultCount);
+			m_Frames[i].statistics = m_Queries;
+
+			if (m_Context != nullptr && queryCount != 0)
+			{
+				VkQueryPoolCreateInfo info{};
+				info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				info.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+				info.queryCount = queryCount;
+				info.pipelineStatistics = statisticFlags;
+
+				vkrg_assert(vkCreateQueryPool(m_Context->GetDevice(), &info, NULL, &m_Frames[i].queryPool) == VK_SUCCESS);
+			}
+		}
+
+		m_Initialized = true;
+	}
+
+	bool PipelineStatisticsProfiler::IsInitialized()
+	{
+		return m_Initialized;
+	}
+
+	void PipelineStatisticsProfiler::BeginFrame(VkCommandBuffer cmd, uint32_t frameIdx)
+	{
+		auto& frame = m_Frames[frameIdx];
+		if (frame.submitted)
+		{
+			ResolveStatistics(frameIdx);
+		}
+
+		if (frame.queryPool != NULL)
+		{
+			vkCmdResetQueryPool(cmd, frame.queryPool, 0, m_Queries.size());
+		}
+		else
+		{
+			std::fill(frame.queryResults.begin(), frame.queryResults.end(), 0);
+		}
+		frame.submitted = true;
+	}
+
+	void PipelineStatisticsProfiler::BeginQuery(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query)
+	{
+		auto& frame = m_Frames[frameIdx];
+		if (frame.queryPool != NULL)
+		{
+			vkCmdBeginQuery(cmd, frame.queryPool, query, 0);
+		}
+	}
+
+	void PipelineStatisticsProfiler::EndQuery(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query)
+	{
+		auto& frame = m_Frames[frameIdx];
+		if (frame.queryPool != NULL)
+		{
+			vkCmdEndQuery(cmd, frame.queryPool, query);
+		}
+		else
+		{
+			frame.queryResults[query * queryResultCount + queryResultCount - 1] = 1;
+		}
+	}
+
+	const std::vector<GpuPipelineStatistics>& PipelineStatisticsProfiler::GetStatistics(uint32_t frameIdx)
+	{
+		return m_Frames[frameIdx].statistics;
+	}
+
+	void PipelineStatisticsProfiler::ResolveStatistics(uint32_t frameIdx)
+	{
+		auto& frame = m_Frames[frameIdx];
+
+		if (frame.queryPool != NULL)
+		{
+			vkGetQueryPoolResults(m_Context->GetDevice(), frame.queryPool, 0, m_Queries.size(),
+				frame.queryResults.size() * sizeof(uint64_t), frame.queryResults.data(), sizeof(uint64_t) * queryResultCount,
+				VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		}
+
+		for (uint32_t query = 0; query < m_Queries.size(); query++)
+		{
+			uint64_t* results = frame.queryResults.data() + query * queryResultCount;
+
+			auto& statistics = frame.statistics[query];
+			statistics.valid = results[queryResultCount - 1] != 0;
+			statistics.inputAssemblyVertices = statistics.valid ? results[0] : 0;
+			statistics.inputAssemblyPrimitives = statistics.valid ? results[1] : 0;
+			statistics.vertexShaderInvocations = statistics.valid ? results[2] : 0;
+			statistics.clippingPrimitives = statistics.valid ? results[3] : 0;
+			statistics.fragmentShaderInvocations = statistics.valid ? results[4] : 0;
+			statistics.computeShaderInvocations = statistics.valid ? results[5] : 0;
+		}
+	}
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "vkrg/common.h"
+#include <vector>
+#include <atomic>
+
+namespace vkrg
+{
+	struct GpuTiming
+	{
+		std::string name;
+		// 0 for a merged pass, 1 for a subpass inside it
+		uint32_t	depth;
+		// false if the scope is not recorded in the frame, e.g. the pass is disabled
+		bool		valid;
+		double		milliseconds;
+	};
+
+	struct GpuPipelineStatistics
+	{
+		std::string name;
+		// false if the pass is not recorded in the frame
+		bool		valid;
+		uint64_t	inputAssemblyVertices;
+		uint64_t	inputAssemblyPrimitives;
+		uint64_t	vertexShaderInvocations;
+		uint64_t	clippingPrimitives;
+		uint64_t	fragmentShaderInvocations;
+		uint64_t	computeShaderInvocations;
+	};
+
+	/// <summary>
+	/// Timestamp queries around scopes of command buffers. Every frame on flight owns a query pool,
+	/// results of a frame are read back when its query pool is reused, so reading never stalls.
+	/// Without a device timestamps are synthetic, every timestamp advances a fake clock by 1 microsecond.
+	/// </summary>
+	class GpuProfiler
+	{
+	public:
+		GpuProfiler() = default;
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		// scopes should be added before initialization
+		uint32_t AddScope(const std::string& name, uint32_t depth);
+		void	 Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount);
+
+		bool	 IsInitialized();
+
+		// resolves results of the last frame using the same query pool and resets the pool
+		void	 BeginFrame(VkCommandBuffer cmd, uint32_t frameIdx);
+		void	 BeginScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope);
+		void	 EndScope(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t scope);
+
+		// results of the last frame resolved on this frame index
+		const std::vector<GpuTiming>& GetTimings(uint32_t frameIdx);
+
+	private:
+		static constexpr uint32_t maxFrameOnFlightCount = 4;
+		static constexpr uint64_t syntheticTimestampStep = 1000;
+
+		void	 WriteTimestamp(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query, VkPipelineStageFlagBits stage);
+		void	 ResolveTimings(uint32_t frameIdx);
+
+		ptr<gvk::Context>	   m_Context;
+		uint32_t			   m_FlightFrameCount = 0;
+		bool				   m_Initialized = false;
+		// nanoseconds per timestamp tick
+		float				   m_TimestampPeriod = 1.f;
+
+		std::vector<GpuTiming> m_Scopes;
+
+		struct Frame
+		{
+			VkQueryPool			   queryPool = NULL;
+			// a frame has results only if its query pool has been used
+			bool				   submitted = false;
+			// value and availability of every query
+			std::vector<uint64_t>  queryResults;
+			std::vector<GpuTiming> timings;
+		} m_Frames[maxFrameOnFlightCount];
+
+		// scopes might be written from recording threads
+		std::atomic<uint64_t>  m_SyntheticClock{ 0 };
+	};
+
+	/// <summary>
+	/// Pipeline statistics queries around passes, results are read back the same way as GpuProfiler.
+	/// Without a device all counters of recorded queries are zero.
+	/// </summary>
+	class PipelineStatisticsProfiler
+	{
+	public:
+		// counters are written to query results in the order of their bits
+		static constexpr VkQueryPipelineStatisticFlags statisticFlags =
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+			VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+		PipelineStatisticsProfiler() = default;
+		~PipelineStatisticsProfiler();
+
+		PipelineStatisticsProfiler(const PipelineStatisticsProfiler&) = delete;
+		PipelineStatisticsProfiler& operator=(const PipelineStatisticsProfiler&) = delete;
+
+		// queries should be added before initialization
+		uint32_t AddQuery(const std::string& name);
+		void	 Initialize(ptr<gvk::Context> ctx, uint32_t flightFrameCount);
+
+		bool	 IsInitialized();
+
+		// resolves results of the last frame using the same query pool and resets the pool
+		void	 BeginFrame(VkCommandBuffer cmd, uint32_t frameIdx);
+		void	 BeginQuery(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query);
+		void	 EndQuery(VkCommandBuffer cmd, uint32_t frameIdx, uint32_t query);
+
+		// results of the last frame resolved on this frame index
+		const std::vector<GpuPipelineStatistics>& GetStatistics(uint32_t frameIdx);
+
+	private:
+		static constexpr uint32_t maxFrameOnFlightCount = 4;
+		// counters and availability of a query
+		static constexpr uint32_t queryResultCount = 7;
+
+		void	 ResolveStatistics(uint32_t frameIdx);
+
+		ptr<gvk::Context>	   m_Context;
+		uint32_t			   m_FlightFrameCount = 0;
+		bool				   m_Initialized = false;
+
+		std::vector<GpuPipelineStatistics> m_Queries;
+
+		struct Frame
+		{
+			VkQueryPool			   queryPool = NULL;
+			bool				   submitted = false;
+			std::vector<uint64_t>  queryResults;
+			std::vector<GpuPipelineStatistics> statistics;
+		} m_Frames[maxFrameOnFlightCount];
+	};
+}
@@ -0,0 +1,217 @@
+#include "graph.h"
+#include "trace.h"
+
+namespace vkrg
+{
+	RenderGraphFileWatcher::RenderGraphFileWatcher(const std::string& path)
+		:m_Path(path)
+	{
+		std::error_code ec;
+		m_LastWriteTime = std::filesystem::last_write_time(m_Path, ec);
+	}
+
+	bool RenderGraphFileWatcher::Poll()
+	{
+		// editors might remove the file before writing the new one
+		std::error_code ec;
+		auto writeTime = std::filesystem::last_write_time(m_Path, ec);
+		if (ec || writeTime == m_LastWriteTime) return false;
+
+		m_LastWriteTime = writeTime;
+		return true;
+	}
+
+	const std::string& RenderGraphFileWatcher::GetPath()
+	{
+		return m_Path;
+	}
+
+	static bool SameResourceInfo(const ResourceInfo& a, const ResourceInfo& b)
+	{
+		if (a.extType != b.extType || a.format != b.format || a.mipCount != b.mipCount || a.channelCount != b.channelCount
+			|| a.usages != b.usages || a.extraFlags != b.extraFlags || a.expectedDimension != b.expectedDimension)
+		{
+			return false;
+		}
+
+		switch (a.extType)
+		{
+		case ResourceExtensionType::Screen:
+			return a.ext.screen.x == b.ext.screen.x && a.ext.screen.y == b.ext.screen.y;
+		case ResourceExtensionType::Fixed:
+			return a.ext.fixed.x == b.ext.fixed.x && a.ext.fixed.y == b.ext.fixed.y && a.ext.fixed.z == b.ext.fixed.z;
+		default:
+			return a.ext.buffer.size == b.ext.buffer.size;
+		}
+	}
+
+	static bool SameAttachmentRange(const RenderPassAttachment& a, const RenderPassAttachment& b)
+	{
+		if (a.IsBuffer())
+		{
+			return a.range.bufferRange.size == b.range.bufferRange.size && a.range.bufferRange.offset == b.range.bufferRange.offset;
+		}
+
+		const ImageSlice& ra = a.range.imageRange;
+		const ImageSlice& rb = b.range.imageRange;
+		return ra.aspectMask == rb.aspectMask && ra.baseMipLevel == rb.baseMipLevel && ra.levelCount == rb.levelCount
+			&& ra.baseArrayLayer == rb.baseArrayLayer && ra.layerCount == rb.layerCount;
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::ReloadFromJson(const char* path, std::string* msg, RenderGraphReloadStatistics* statistics)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		return Reload(LoadFromJson(path, msg), begin, msg, statistics);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::ReloadFromJsonString(std::string_view json, std::string* msg, RenderGraphReloadStatistics* statistics)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		return Reload(LoadFromJsonString(json, msg), begin, msg, statistics);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::ReloadFromBinary(const char* path, std::string* msg, RenderGraphReloadStatistics* statistics)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		return Reload(LoadFromBinary(path, msg), begin, msg, statistics);
+	}
+
+	opt<ptr<RenderGraph>> RenderGraph::Reload(opt<ptr<RenderGraph>> graph, std::chrono::steady_clock::time_point begin, std::string* msg, RenderGraphReloadStatistics* statistics)
+	{
+		VKRG_TRACE_SCOPE("RenderGraph::Reload");
+		vkrg_assert(m_HaveCompiled);
+
+		// this graph is kept unchanged if the new graph fails to load or compile
+		if (!graph.has_value()) return std::nullopt;
+		auto loaded = std::chrono::steady_clock::now();
+
+		ptr<RenderGraph> reloaded = graph.value();
+		reloaded->AdoptResources(*this);
+		reloaded->m_RenderScale = m_RenderScale;
+		uint32_t adoptedBufferCount = reloaded->m_AdoptedBuffers.size();
+
+		auto [state, compileMsg] = reloaded->Compile(m_Options, m_vulkanContext);
+		if (state != RenderGraphCompileState::Success)
+		{
+			if (msg != NULL) *msg = compileMsg;
+			return std::nullopt;
+		}
+		auto compiled = std::chrono::steady_clock::now();
+
+		if (statistics != NULL)
+		{
+			*statistics = RenderGraphReloadStatistics();
+			reloaded->DiffRenderGraph(*this, *statistics);
+
+			auto& renderPassStatistics = reloaded->m_RenderPassCache.GetStatistics();
+			statistics->createdRenderPassCount = renderPassStatistics.missCount;
+			statistics->reusedRenderPassCount = renderPassStatistics.hitCount;
+			statistics->releasedRenderPassCount = renderPassStatistics.evictCount;
+
+			auto& imageStatistics = reloaded->m_ImagePool.GetStatistics();
+			statistics->createdImageCount = imageStatistics.createCount;
+			statistics->reusedImageCount = imageStatistics.reuseCount;
+
+			uint32_t bufferCount = 0;
+			for (auto& binding : reloaded->m_PhysicalResourceBindings)
+			{
+				for (auto& buffer : binding.buffers)
+				{
+					bufferCount += buffer != nullptr ? 1 : 0;
+				}
+			}
+			statistics->reusedBufferCount = adoptedBufferCount - reloaded->m_AdoptedBuffers.size();
+			statistics->createdBufferCount = bufferCount - statistics->reusedBufferCount;
+
+			statistics->loadMilliseconds = std::chrono::duration<float, std::milli>(loaded - begin).count();
+			statistics->compileMilliseconds = std::chrono::duration<float, std::milli>(compiled - loaded).count();
+		}
+
+		// buffers not taken by the new graph are released with this graph
+		reloaded->m_AdoptedBuffers.clear();
+
+		return reloaded;
+	}
+
+	void RenderGraph::AdoptResources(RenderGraph& live)
+	{
+		m_RenderPassCache.Adopt(live.m_RenderPassCache);
+
+		uint32_t resourceFrameCount = live.m_Options.disableFrameOnFlight ? 1 : live.m_Options.flightFrameCount;
+		for (uint32_t physicalResourceIdx = 0; physicalResourceIdx < live.m_PhysicalResourceBindings.size(); physicalResourceIdx++)
+		{
+			auto& binding = live.m_PhysicalResourceBindings[physicalResourceIdx];
+			for (uint32_t i = 0; i < resourceFrameCount; i++)
+			{
+				if (binding.images[i] != nullptr)
+				{
+					m_AdoptedImages.push_back(std::make_tuple(binding.images[i], binding.images[i]->Info()));
+				}
+				if (binding.buffers[i] != nullptr)
+				{
+					m_AdoptedBuffers.push_back(std::make_tuple(binding.buffers[i], live.m_PhysicalResources[physicalResourceIdx].info));
+				}
+			}
+		}
+	}
+
+	void RenderGraph::DiffRenderGraph(RenderGraph& live, RenderGraphReloadStatistics& statistics)
+	{
+		// versions are created while compiling, they are compared through the passes writing them
+		for (auto& resource : m_LogicalResourceList)
+		{
+			if (resource.version != 0) continue;
+
+			auto liveHandle = live.FindGraphResource(resource.name);
+			if (!liveHandle.has_value())
+			{
+				statistics.addedResourceCount++;
+				continue;
+			}
+
+			auto& liveResource = live.m_LogicalResourceList[liveHandle.value().idx];
+			if (!SameResourceInfo(resource.info, liveResource.info) || resource.handle.external != liveResource.handle.external
+				|| resource.finalLayout != liveResource.finalLayout)
+			{
+				statistics.changedResourceCount++;
+			}
+		}
+		for (auto& resource : live.m_LogicalResourceList)
+		{
+			if (resource.version != 0) continue;
+			statistics.removedResourceCount += FindGraphResource(resource.name).has_value() ? 0 : 1;
+		}
+
+		// passes are compared by type, extension and attachments, interfaces created by prototypes are not compared
+		for (auto& handle : m_RenderPassList)
+		{
+			auto liveHandle = live.FindGraphRenderPass(handle.pass->GetName());
+			if (!liveHandle.has_value())
+			{
+				statistics.addedPassCount++;
+				continue;
+			}
+
+			RenderPass* pass = handle.pass.get();
+			RenderPass* livePass = liveHandle.value().pass.get();
+
+			bool changed = pass->GetType() != livePass->GetType() || !(pass->GetRenderPassExtension() == livePass->GetRenderPassExtension())
+				|| pass->GetAttachments().size() != livePass->GetAttachments().size();
+			for (uint32_t i = 0; !changed && i < pass->GetAttachments().size(); i++)
+			{
+				auto& attachment = pass->GetAttachments()[i];
+				auto& liveAttachment = livePass->GetAttachments()[i];
+				auto& resource = m_LogicalResourceList[pass->GetAttachedResourceHandles()[i].idx];
+				auto& liveResource = live.m_LogicalResourceList[livePass->GetAttachedResourceHandles()[i].idx];
+
+				changed = attachment.type != liveAttachment.type || attachment.viewType != liveAttachment.viewType
+					|| resource.name != liveResource.name || !SameAttachmentRange(attachment, liveAttachment);
+			}
+			statistics.changedPassCount += changed ? 1 : 0;
+		}
+		for (auto& handle : live.m_RenderPassList)
+		{
+			statistics.removedPassCount += FindGraphRenderPass(handle.pass->GetName()).has_value() ? 0 : 1;
+		}
+	}
+}
@@ -78,4 +78,11 @@ namespace vkrg
 
 		static BufferSlice fullBuffer;
 	};
+
+	// bytes of a texel of uncompressed formats, 0 for compressed or unknown formats
+	uint32_t GetFormatTexelSize(VkFormat format);
+	// bytes of the stencil part of a texel, 0 if the format has no stencil
+	uint32_t GetFormatStencilSize(VkFormat format);
+	// replaces VK_REMAINING_MIP_LEVELS and VK_REMAINING_ARRAY_LAYERS with the counts left in the resource
+	ImageSlice ResolveImageSlice(ImageSlice slice, const ResourceInfo& info);
 }
\ No newline at end of file
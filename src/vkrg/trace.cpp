@@ -0,0 +1,103 @@
+#include "trace.h"
+#include <mutex>
+#include <iomanip>
+
+namespace vkrg
+{
+	// ring buffers are never released, events of exited threads could still be exported
+	static std::mutex								traceBufferLock;
+	static std::vector<std::unique_ptr<TraceRingBuffer>> traceBuffers;
+
+	TraceRingBuffer::TraceRingBuffer(uint32_t threadId)
+		:m_Events(new TraceEvent[capacity]), m_ThreadId(threadId)
+	{
+	}
+
+	void TraceRingBuffer::Push(const TraceEvent& e)
+	{
+		uint64_t head = m_Head.load(std::memory_order_relaxed);
+		m_Events[head & (capacity - 1)] = e;
+		m_Head.store(head + 1, std::memory_order_release);
+	}
+
+	void TraceRingBuffer::Collect(std::vector<TraceEvent>& events)
+	{
+		uint64_t head = m_Head.load(std::memory_order_acquire);
+		uint64_t begin = head > capacity ? head - capacity : 0;
+		for (uint64_t i = begin; i < head; i++)
+		{
+			events.push_back(m_Events[i & (capacity - 1)]);
+		}
+	}
+
+	void TraceRingBuffer::Clear()
+	{
+		m_Head.store(0, std::memory_order_release);
+	}
+
+	uint32_t TraceRingBuffer::ThreadId()
+	{
+		return m_ThreadId;
+	}
+
+	uint64_t Tracer::Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Tracer::Record(const char* name, uint64_t beginNs, uint64_t endNs)
+	{
+		GetThreadBuffer()->Push(TraceEvent{ name, beginNs, endNs });
+	}
+
+	bool Tracer::ExportChromeTrace(const char* path)
+	{
+		std::ofstream file(path);
+		if (!file.is_open()) return false;
+
+		std::lock_guard<std::mutex> guard(traceBufferLock);
+
+		file << std::fixed << std::setprecision(3);
+		file << "{\"traceEvents\":[";
+		bool first = true;
+		std::vector<TraceEvent> events;
+		for (auto& buffer : traceBuffers)
+		{
+			events.clear();
+			buffer->Collect(events);
+
+			for (auto& e : events)
+			{
+				// complete events, timestamps are in microseconds
+				file << (first ? "\n" : ",\n");
+				file << "{\"name\":\"" << EscapeString(e.name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ThreadId()
+					<< ",\"ts\":" << e.beginNs / 1000.0 << ",\"dur\":" << (e.endNs - e.beginNs) / 1000.0 << "}";
+				first = false;
+			}
+		}
+		file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		return true;
+	}
+
+	void Tracer::Clear()
+	{
+		std::lock_guard<std::mutex> guard(traceBufferLock);
+		for (auto& buffer : traceBuffers)
+		{
+			buffer->Clear();
+		}
+	}
+
+	TraceRingBuffer* Tracer::GetThreadBuffer()
+	{
+		thread_local TraceRingBuffer* buffer = NULL;
+		if (buffer == NULL)
+		{
+			std::lock_guard<std::mutex> guard(traceBufferLock);
+			traceBuffers.push_back(std::make_unique<TraceRingBuffer>(traceBuffers.size()));
+			buffer = traceBuffers.back().get();
+		}
+		return buffer;
+	}
+}
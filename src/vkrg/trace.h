@@ -0,0 +1,87 @@
+#pragma once
+#include "vkrg/common.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+
+namespace vkrg
+{
+	struct TraceEvent
+	{
+		// names are not copied, they should outlive the export
+		const char* name;
+		uint64_t	beginNs;
+		uint64_t	endNs;
+	};
+
+	/// <summary>
+	/// Fixed capacity ring of trace events written by a single thread.
+	/// Old events are overwritten when the ring is full.
+	/// </summary>
+	class TraceRingBuffer
+	{
+	public:
+		TraceRingBuffer(uint32_t threadId);
+
+		// called by the owner thread only
+		void	 Push(const TraceEvent& e);
+
+		// events are read without locking, the owner thread should not be recording
+		void	 Collect(std::vector<TraceEvent>& events);
+		void	 Clear();
+
+		uint32_t ThreadId();
+
+	private:
+		static constexpr uint32_t capacity = 1 << 14;
+
+		std::unique_ptr<TraceEvent[]> m_Events;
+		std::atomic<uint64_t>		  m_Head{ 0 };
+		uint32_t					  m_ThreadId;
+	};
+
+	/// <summary>
+	/// CPU trace recorder, every thread records to its own ring buffer.
+	/// Recording is only compiled in with VKRG_ENABLE_TRACE, see VKRG_TRACE_SCOPE.
+	/// </summary>
+	class Tracer
+	{
+	public:
+		static uint64_t Now();
+		static void		Record(const char* name, uint64_t beginNs, uint64_t endNs);
+
+		// chrome trace event json, could be loaded by chrome://tracing or perfetto ui
+		static bool		ExportChromeTrace(const char* path);
+		static void		Clear();
+
+	private:
+		static TraceRingBuffer* GetThreadBuffer();
+	};
+
+	class TraceScope
+	{
+	public:
+		TraceScope(const char* name)
+			:m_Name(name), m_Begin(Tracer::Now())
+		{}
+
+		~TraceScope()
+		{
+			Tracer::Record(m_Name, m_Begin, Tracer::Now());
+		}
+
+	private:
+		const char* m_Name;
+		uint64_t	m_Begin;
+	};
+}
+
+#define vkrg_trace_concat_impl(a, b) a##b
+#define vkrg_trace_concat(a, b) vkrg_trace_concat_impl(a, b)
+
+#ifdef VKRG_ENABLE_TRACE
+#define VKRG_TRACE_SCOPE(name) vkrg::TraceScope vkrg_trace_concat(vkrg_trace_scope_, __LINE__)(name)
+#else
+#define VKRG_TRACE_SCOPE(name)
+#endif
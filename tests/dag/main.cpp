@@ -594,6 +594,152 @@ TEST(GraphTest, GraphClear)
 	ASSERT_TRUE(g.Begin().Invalid());
 }
 
+using Graph = vkrg::DirectionalGraph<int>;
+using Edges = std::vector<std::vector<int>>;
+
+static std::vector<Graph::NodeIterator> BuildGraph(Graph& g, int nodeCount, const Edges& edges)
+{
+	std::vector<Graph::NodeIterator> nodes;
+	for (int i = 0; i < nodeCount; i++)
+	{
+		nodes.push_back(g.AddNode(i));
+	}
+	for (auto& e : edges)
+	{
+		g.AddEdge(nodes[e[0]], nodes[e[1]]);
+	}
+	return nodes;
+}
+
+// frame-like graph : passes mostly consume the pass declared right before them,
+// with a few long range dependencies and independent passes
+static Edges RandomFrameGraph(int nodeCount, uint32_t seed)
+{
+	Edges edges;
+	auto next = [&]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7fff; };
+	for (int node = 1; node < nodeCount; node++)
+	{
+		if (next() % 10 < 8)
+		{
+			edges.push_back({ node - 1, node });
+		}
+		if (next() % 10 < 3)
+		{
+			edges.push_back({ (int)(next() % node), node });
+		}
+	}
+	return edges;
+}
+
+// 0->1->2->3->4 is the critical path, 5, 6, 7 are independent producers consumed by 4
+static const Edges overlapGraphEdges =
+{
+	{0, 1},
+	{1, 2},
+	{2, 3},
+	{3, 4},
+	{5, 4},
+	{6, 4},
+	{7, 4}
+};
+
+// count of edges whose consumer is scheduled right after its producer
+static uint32_t CountAdjacentEdges(std::vector<Graph::NodeIterator>& nodes, const Edges& edges)
+{
+	uint32_t adjacent = 0;
+	for (auto& e : edges)
+	{
+		int32_t distance = nodes[e[1]] - nodes[e[0]];
+		EXPECT_GT(distance, 0);
+		adjacent += distance == 1;
+	}
+	return adjacent;
+}
+
+// frame time of a schedule on a single queue : a pass is issued one cycle after the previous one,
+// waits until its producers finish and takes latency cycles. a waiting pass stalls the passes after it like a barrier
+static uint32_t SimulateSchedule(Graph& g, std::vector<Graph::NodeIterator>& nodes, const Edges& edges, uint32_t latency)
+{
+	std::vector<int> order(nodes.size());
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		order[nodes[i] - g.Begin()] = i;
+	}
+
+	std::vector<uint32_t> finish(nodes.size(), 0);
+	uint32_t issue = 0, frameTime = 0;
+	for (int node : order)
+	{
+		uint32_t start = issue;
+		for (auto& e : edges)
+		{
+			if (e[1] == node) start = std::max(start, finish[e[0]]);
+		}
+		finish[node] = start + latency;
+		issue = start + 1;
+		frameTime = std::max(frameTime, finish[node]);
+	}
+	return frameTime;
+}
+
+TEST(GraphSortTest, GraphSortOverlapAware)
+{
+	const uint32_t maxLifetimeExtension = 4;
+
+	Graph kahnGraph, overlapGraph;
+	auto kahnNodes = BuildGraph(kahnGraph, 8, overlapGraphEdges);
+	auto overlapNodes = BuildGraph(overlapGraph, 8, overlapGraphEdges);
+	ASSERT_TRUE(kahnGraph.Sort());
+	ASSERT_TRUE(overlapGraph.SortOverlapAware(maxLifetimeExtension));
+
+	EXPECT_LT(CountAdjacentEdges(overlapNodes, overlapGraphEdges), CountAdjacentEdges(kahnNodes, overlapGraphEdges));
+
+	// producers are kept alive at most maxLifetimeExtension passes longer than in kahn's order
+	std::vector<uint32_t> kahnLifetimes(8, 0), overlapLifetimes(8, 0);
+	for (auto& e : overlapGraphEdges)
+	{
+		kahnLifetimes[e[0]] = std::max<uint32_t>(kahnLifetimes[e[0]], kahnNodes[e[1]] - kahnNodes[e[0]]);
+		overlapLifetimes[e[0]] = std::max<uint32_t>(overlapLifetimes[e[0]], overlapNodes[e[1]] - overlapNodes[e[0]]);
+	}
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		EXPECT_LE(overlapLifetimes[i], kahnLifetimes[i] + maxLifetimeExtension);
+	}
+}
+
+TEST(GraphSortTest, GraphSortOverlapAwareRandom)
+{
+	const int nodeCount = 128;
+	Edges edges = RandomFrameGraph(nodeCount, 7);
+
+	Graph kahnGraph, overlapGraph;
+	auto kahnNodes = BuildGraph(kahnGraph, nodeCount, edges);
+	auto overlapNodes = BuildGraph(overlapGraph, nodeCount, edges);
+	ASSERT_TRUE(kahnGraph.Sort());
+	ASSERT_TRUE(overlapGraph.SortOverlapAware(4));
+
+	EXPECT_LE(CountAdjacentEdges(overlapNodes, edges), CountAdjacentEdges(kahnNodes, edges));
+}
+
+TEST(GraphSortTest, GraphSortOverlapAwareCriticalPath)
+{
+	// kahn's order is 0 5 6 7 1 2 3 4, 1 waits for 0 and stalls the chain behind 7.
+	// moving 7 between 1 and 2 hides it in the wait, the frame takes exactly the 5 passes of the critical path
+	const uint32_t latency = 3;
+
+	Graph kahnGraph, overlapGraph;
+	auto kahnNodes = BuildGraph(kahnGraph, 8, overlapGraphEdges);
+	auto overlapNodes = BuildGraph(overlapGraph, 8, overlapGraphEdges);
+	ASSERT_TRUE(kahnGraph.Sort());
+	ASSERT_TRUE(overlapGraph.SortOverlapAware(4));
+
+	uint32_t kahnFrameTime = SimulateSchedule(kahnGraph, kahnNodes, overlapGraphEdges, latency);
+	uint32_t overlapFrameTime = SimulateSchedule(overlapGraph, overlapNodes, overlapGraphEdges, latency);
+	EXPECT_EQ(kahnFrameTime, 16);
+	EXPECT_EQ(overlapFrameTime, 5 * latency);
+	EXPECT_LT(overlapFrameTime, kahnFrameTime);
+}
+
 int main() {
 	testing::InitGoogleTest();
 	RUN_ALL_TESTS();
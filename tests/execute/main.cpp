@@ -0,0 +1,1220 @@
+#include "vkrg/graph.h"
+#include "vkrg/bitset.h"
+#include "vkrg/cache.h"
+#include "vkrg/layout.h"
+#include "vkrg/trace.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+// counting allocator, every allocation through global operator new is recorded
+static std::atomic<uint64_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	if (void* p = malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+class EmptyComputePass : public vkrg::RenderPassInterface
+{
+public:
+	EmptyComputePass(vkrg::RenderPass* pass)
+		:vkrg::RenderPassInterface(pass)
+	{}
+
+	virtual void OnRender(vkrg::RenderPassRuntimeContext& ctx, VkCommandBuffer cmd) override
+	{
+		renderCount++;
+	}
+
+	virtual vkrg::RenderPassType ExpectedType() override
+	{
+		return vkrg::RenderPassType::Compute;
+	}
+
+	uint32_t renderCount = 0;
+};
+
+class EmptyGraphicsPass : public vkrg::RenderPassInterface
+{
+public:
+	EmptyGraphicsPass(vkrg::RenderPass* pass)
+		:vkrg::RenderPassInterface(pass)
+	{}
+
+	virtual void OnRender(vkrg::RenderPassRuntimeContext& ctx, VkCommandBuffer cmd) override {}
+
+	virtual vkrg::RenderPassType ExpectedType() override
+	{
+		return vkrg::RenderPassType::Graphics;
+	}
+};
+
+TEST(DynamicBitsetTest, SetTestClear)
+{
+	vkrg::DynamicBitset bits;
+	bits.Resize(130);
+	EXPECT_FALSE(bits.Any());
+
+	uint32_t setBits[] = { 0, 63, 64, 129 };
+	for (uint32_t i = 0; i < _countof(setBits); i++)
+	{
+		bits.Set(setBits[i]);
+	}
+	for (uint32_t i = 0; i < bits.Size(); i++)
+	{
+		bool expected = std::find(setBits, setBits + _countof(setBits), i) != setBits + _countof(setBits);
+		EXPECT_EQ(bits.Test(i), expected);
+	}
+
+	bits.Reset(0);
+	bits.Reset(63);
+	bits.Reset(64);
+	EXPECT_TRUE(bits.Any());
+	bits.Reset(129);
+	EXPECT_FALSE(bits.Any());
+
+	bits.SetAll();
+	EXPECT_TRUE(bits.Test(129));
+	bits.Clear();
+	EXPECT_FALSE(bits.Any());
+}
+
+static vkrg::ResourceInfo MakeImageInfo(uint32_t mipCount, uint32_t layerCount)
+{
+	vkrg::ResourceInfo info;
+	info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	info.mipCount = mipCount;
+	info.channelCount = layerCount;
+	return info;
+}
+
+static vkrg::ImageSlice MakeSlice(uint32_t baseMip, uint32_t mipCount, uint32_t baseLayer, uint32_t layerCount)
+{
+	vkrg::ImageSlice slice{};
+	slice.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	slice.baseMipLevel = baseMip;
+	slice.levelCount = mipCount;
+	slice.baseArrayLayer = baseLayer;
+	slice.layerCount = layerCount;
+	return slice;
+}
+
+static uint32_t CountRanges(vkrg::ImageLayoutStatus& status, vkrg::ImageSlice slice)
+{
+	uint32_t count = 0;
+	status.QueryRanges(slice, [&](vkrg::ImageSlice, VkImageLayout) { count++; });
+	return count;
+}
+
+TEST(ResourceTest, ResolveImageSlice)
+{
+	vkrg::ResourceInfo info = MakeImageInfo(4, 6);
+
+	auto slice = vkrg::ResolveImageSlice(MakeSlice(1, VK_REMAINING_MIP_LEVELS, 2, VK_REMAINING_ARRAY_LAYERS), info);
+	EXPECT_EQ(slice.levelCount, 3);
+	EXPECT_EQ(slice.layerCount, 4);
+
+	// explicit counts are kept
+	slice = vkrg::ResolveImageSlice(MakeSlice(0, 1, 0, 2), info);
+	EXPECT_EQ(slice.levelCount, 1);
+	EXPECT_EQ(slice.layerCount, 2);
+}
+
+static GvkImageCreateInfo MakePoolImageInfo(uint32_t width, uint32_t height)
+{
+	GvkImageCreateInfo info{};
+	info.extent = { width, height, 1 };
+	info.arrayLayers = 1;
+	info.mipLevels = 1;
+	info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	info.imageType = VK_IMAGE_TYPE_2D;
+	info.usage = VK_IMAGE_USAGE_STORAGE_BIT;
+	info.samples = VK_SAMPLE_COUNT_1_BIT;
+	return info;
+}
+
+TEST(ImagePoolTest, SizeClass)
+{
+	VkExtent3D sizeClass = vkrg::ImagePool::GetSizeClass({ 1920, 1080, 1 });
+	EXPECT_EQ(sizeClass.width, 1920);
+	EXPECT_EQ(sizeClass.height, 1088);
+	EXPECT_EQ(sizeClass.depth, 1);
+
+	EXPECT_TRUE(vkrg::ImagePool::InSizeClass({ 128, 64, 1 }, { 100, 60, 1 }));
+	// too small for the requested extent
+	EXPECT_FALSE(vkrg::ImagePool::InSizeClass({ 100, 60, 1 }, { 120, 60, 1 }));
+	// larger than the size class of the requested extent
+	EXPECT_FALSE(vkrg::ImagePool::InSizeClass({ 1920, 1088, 1 }, { 1280, 720, 1 }));
+}
+
+// pooled images are never created in these tests, images are only handed out when the pool has one
+TEST(ImagePoolTest, ReuseInSizeClass)
+{
+	vkrg::ImagePool pool;
+	pool.Initialize(nullptr, 2, 4);
+
+	pool.Release(nullptr, MakePoolImageInfo(128, 64));
+	pool.Adopt(nullptr, MakePoolImageInfo(100, 60));
+	EXPECT_EQ(pool.GetStatistics().pooledImageCount, 2);
+
+	// adopted images are reused immediately, exact extents only match requests of the same extent
+	pool.Acquire(MakePoolImageInfo(100, 60), false);
+	EXPECT_EQ(pool.GetStatistics().reuseCount, 1);
+
+	// the released image is reused by any extent in its size class after frames on flight retire
+	pool.OnNewFrame();
+	pool.OnNewFrame();
+	pool.Acquire(MakePoolImageInfo(90, 50), true);
+	EXPECT_EQ(pool.GetStatistics().reuseCount, 2);
+	EXPECT_EQ(pool.GetStatistics().createCount, 0);
+	EXPECT_EQ(pool.GetStatistics().pooledImageCount, 0);
+}
+
+TEST(ImagePoolTest, EvictLeastRecentlyReleased)
+{
+	vkrg::ImagePool pool;
+	pool.Initialize(nullptr, 2, 1);
+
+	pool.Release(nullptr, MakePoolImageInfo(256, 256));
+	pool.Release(nullptr, MakePoolImageInfo(128, 128));
+
+	// both images might still be used by frames on flight, the pool keeps more images than its capacity
+	pool.OnNewFrame();
+	EXPECT_EQ(pool.GetStatistics().pooledImageCount, 2);
+	pool.Release(nullptr, MakePoolImageInfo(64, 64));
+
+	// the first two images retired, they are dropped until the pool fits in its capacity
+	pool.OnNewFrame();
+	EXPECT_EQ(pool.GetStatistics().pooledImageCount, 1);
+
+	// the most recently released image is kept
+	pool.OnNewFrame();
+	pool.Acquire(MakePoolImageInfo(64, 64), true);
+	EXPECT_EQ(pool.GetStatistics().reuseCount, 1);
+	EXPECT_EQ(pool.GetStatistics().pooledImageCount, 0);
+}
+
+TEST(ImageLayoutStatusTest, SplitAndMergeRuns)
+{
+	vkrg::ImageLayoutStatus status(MakeImageInfo(4, 1), VK_IMAGE_LAYOUT_GENERAL);
+	vkrg::ImageSlice whole = MakeSlice(0, VK_REMAINING_MIP_LEVELS, 0, 1);
+	EXPECT_EQ(status.Query(whole), VK_IMAGE_LAYOUT_GENERAL);
+	EXPECT_EQ(CountRanges(status, whole), 1);
+
+	// updating a mip level in the middle splits the run into three
+	status.Update(MakeSlice(1, 1, 0, 1), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(status.Query(whole), VK_IMAGE_LAYOUT_UNDEFINED);
+	EXPECT_EQ(status.Query(MakeSlice(1, 1, 0, 1)), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(status.Query(MakeSlice(2, 2, 0, 1)), VK_IMAGE_LAYOUT_GENERAL);
+	EXPECT_EQ(CountRanges(status, whole), 3);
+
+	// extending the run to the last mip level leaves two runs
+	status.Update(MakeSlice(2, VK_REMAINING_MIP_LEVELS, 0, 1), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(CountRanges(status, whole), 2);
+	EXPECT_EQ(status.Query(MakeSlice(1, 3, 0, 1)), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	// restoring the first mip level merges the neighbor runs back into one
+	status.Update(MakeSlice(0, 1, 0, 1), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(status.Query(whole), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(CountRanges(status, whole), 1);
+	EXPECT_FALSE(status.IsDense());
+}
+
+TEST(ImageLayoutStatusTest, MultiRangeQueries)
+{
+	vkrg::ImageLayoutStatus status(MakeImageInfo(3, 4), VK_IMAGE_LAYOUT_GENERAL);
+	status.Update(MakeSlice(1, 1, 1, 2), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	// layers 1 and 2 share their segments and are reported together
+	std::vector<std::pair<vkrg::ImageSlice, VkImageLayout>> ranges;
+	status.QueryRanges(MakeSlice(0, VK_REMAINING_MIP_LEVELS, 0, 4), [&](vkrg::ImageSlice range, VkImageLayout layout) { ranges.push_back({ range, layout }); });
+
+	uint32_t covered = 0;
+	for (auto& [range, layout] : ranges)
+	{
+		for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + range.layerCount; layer++)
+		{
+			for (uint32_t mip = range.baseMipLevel; mip < range.baseMipLevel + range.levelCount; mip++)
+			{
+				bool updated = mip == 1 && (layer == 1 || layer == 2);
+				EXPECT_EQ(layout, updated ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL);
+				covered++;
+			}
+		}
+	}
+	EXPECT_EQ(covered, 12);
+	EXPECT_EQ(ranges.size(), 5);
+
+	EXPECT_EQ(status.Query(MakeSlice(1, 1, 1, 2)), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_EQ(status.Query(MakeSlice(1, 1, 0, 2)), VK_IMAGE_LAYOUT_UNDEFINED);
+	EXPECT_EQ(status.Query(MakeSlice(0, 1, 0, 4)), VK_IMAGE_LAYOUT_GENERAL);
+}
+
+TEST(ImageLayoutStatusTest, DenseFallback)
+{
+	vkrg::ImageLayoutStatus status(MakeImageInfo(8, 8));
+
+	// alternating layouts fragment the runs until dense storage is used
+	for (uint32_t layer = 0; layer < 8; layer++)
+	{
+		for (uint32_t mip = layer % 2; mip < 8; mip += 2)
+		{
+			status.Update(MakeSlice(mip, 1, layer, 1), VK_IMAGE_LAYOUT_GENERAL);
+		}
+	}
+	EXPECT_TRUE(status.IsDense());
+	for (uint32_t layer = 0; layer < 8; layer++)
+	{
+		for (uint32_t mip = 0; mip < 8; mip++)
+		{
+			EXPECT_EQ(status.Query(MakeSlice(mip, 1, layer, 1)), (mip + layer) % 2 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL);
+		}
+	}
+	EXPECT_EQ(CountRanges(status, MakeSlice(0, 8, 0, 1)), 8);
+
+	// updating the whole image goes back to a single run
+	status.Update(MakeSlice(0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EXPECT_FALSE(status.IsDense());
+	EXPECT_EQ(CountRanges(status, MakeSlice(0, 8, 0, 8)), 1);
+}
+
+// random updates and queries are compared against a layout per subresource
+TEST(ImageLayoutStatusTest, RandomAgainstDenseReference)
+{
+	std::mt19937 rng(1);
+	VkImageLayout layouts[] = { VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+	for (uint32_t iteration = 0; iteration < 500; iteration++)
+	{
+		vkrg::ResourceInfo info = MakeImageInfo(1 + rng() % 6, 1 + rng() % 12);
+		vkrg::ImageLayoutStatus status(info);
+		std::vector<VkImageLayout> reference(info.mipCount * info.channelCount, VK_IMAGE_LAYOUT_UNDEFINED);
+		auto referenceIdx = [&](uint32_t layer, uint32_t mip) { return layer * info.mipCount + mip; };
+
+		for (uint32_t op = 0; op < 60; op++)
+		{
+			uint32_t baseMip = rng() % info.mipCount, baseLayer = rng() % info.channelCount;
+			vkrg::ImageSlice slice = MakeSlice(baseMip, 1 + rng() % (info.mipCount - baseMip), baseLayer, 1 + rng() % (info.channelCount - baseLayer));
+			uint32_t mipEnd = slice.baseMipLevel + slice.levelCount;
+			if (rng() % 5 == 0) slice.levelCount = VK_REMAINING_MIP_LEVELS, mipEnd = info.mipCount;
+			uint32_t layerEnd = slice.baseArrayLayer + slice.layerCount;
+
+			if (rng() % 2)
+			{
+				VkImageLayout layout = layouts[rng() % _countof(layouts)];
+				status.Update(slice, layout);
+				for (uint32_t layer = slice.baseArrayLayer; layer < layerEnd; layer++)
+				{
+					for (uint32_t mip = slice.baseMipLevel; mip < mipEnd; mip++) reference[referenceIdx(layer, mip)] = layout;
+				}
+				continue;
+			}
+
+			// every subresource in the slice is covered by exactly one range of the right layout
+			std::vector<uint32_t> coverage(reference.size(), 0);
+			status.QueryRanges(slice, [&](vkrg::ImageSlice range, VkImageLayout layout)
+				{
+					for (uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + range.layerCount; layer++)
+					{
+						for (uint32_t mip = range.baseMipLevel; mip < range.baseMipLevel + range.levelCount; mip++)
+						{
+							EXPECT_EQ(reference[referenceIdx(layer, mip)], layout);
+							coverage[referenceIdx(layer, mip)]++;
+						}
+					}
+				});
+
+			bool uniform = true;
+			VkImageLayout first = reference[referenceIdx(slice.baseArrayLayer, slice.baseMipLevel)];
+			for (uint32_t layer = 0; layer < info.channelCount; layer++)
+			{
+				for (uint32_t mip = 0; mip < info.mipCount; mip++)
+				{
+					bool inside = layer >= slice.baseArrayLayer && layer < layerEnd && mip >= slice.baseMipLevel && mip < mipEnd;
+					EXPECT_EQ(coverage[referenceIdx(layer, mip)], inside ? 1 : 0);
+					if (inside) uniform &= reference[referenceIdx(layer, mip)] == first;
+				}
+			}
+			EXPECT_EQ(status.Query(slice), uniform ? first : VK_IMAGE_LAYOUT_UNDEFINED);
+		}
+	}
+}
+
+// compute passes without attachments could be compiled and executed without a vulkan device
+// builds a chain of compute passes, the 4th pass is only enabled on even frame indices
+static void BuildComputePassChain(vkrg::RenderGraph& graph, uint32_t passCount, std::vector<std::shared_ptr<EmptyComputePass>>& interfaces)
+{
+	std::vector<vkrg::RenderPassHandle> passes;
+	for (uint32_t i = 0; i < passCount; i++)
+	{
+		std::string name = "pass" + std::to_string(i);
+		auto pass = graph.AddGraphRenderPass(name.c_str(), vkrg::RenderPassType::Compute).value();
+
+		auto rpi = std::make_shared<EmptyComputePass>(pass.pass.get());
+		pass.pass->AttachInterface(rpi);
+
+		if (!passes.empty())
+		{
+			graph.AddEdge(passes.back(), pass);
+		}
+		passes.push_back(pass);
+		interfaces.push_back(rpi);
+	}
+	passes[3].pass->SetEnablePredicate([](uint32_t frameIdx) { return frameIdx % 2 == 0; });
+}
+
+// a chain of 8 compute passes compiled with 2 frames on flight, tests change the options before compiling
+class ComputePassChainTest : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		BuildComputePassChain(graph, 8, interfaces);
+		options.flightFrameCount = 2;
+	}
+
+	void Compile()
+	{
+		auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+		ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+	}
+
+	// results of a frame, like gpu timings, are resolved when its frame index is used again
+	void WarmUp()
+	{
+		for (uint32_t frame = 0; frame < warmUpFrameCount; frame++)
+		{
+			auto [state, msg] = graph.Execute(frame % options.flightFrameCount, NULL);
+			ASSERT_EQ(state, vkrg::RenderGraphRuntimeState::Success) << msg;
+		}
+	}
+
+	static constexpr uint32_t warmUpFrameCount = 4;
+
+	vkrg::RenderGraph graph;
+	std::vector<std::shared_ptr<EmptyComputePass>> interfaces;
+	vkrg::RenderGraphCompileOptions options;
+};
+
+TEST_F(ComputePassChainTest, SteadyStateExecuteDoesNotAllocate)
+{
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	// the buffer is not attached to any pass, its binding is validated without recording barriers to the null command buffer
+	auto particles = graph.AddGraphResource("particles", info, true).value();
+
+	ASSERT_NO_FATAL_FAILURE(Compile());
+	EXPECT_EQ(std::get<0>(graph.Execute(0, NULL)), vkrg::RenderGraphRuntimeState::Error_MissingExternalResourceAttachment);
+
+	// there is no device to create buffers in tests, the buffer is never dereferenced or destroyed
+	alignas(gvk::Buffer) static uint8_t bufferStorage[sizeof(gvk::Buffer)] = {};
+	vkrg::ptr<gvk::Buffer> buffer(reinterpret_cast<gvk::Buffer*>(bufferStorage), [](gvk::Buffer*) {});
+
+	// the first frame sees the dirty binding
+	auto dataFrame = graph.GetExternalDataFrame();
+	for (uint32_t frameIdx = 0; frameIdx < options.flightFrameCount; frameIdx++)
+	{
+		ASSERT_TRUE(dataFrame.BindBuffer(particles, frameIdx, buffer));
+	}
+	ASSERT_NO_FATAL_FAILURE(WarmUp());
+
+	// rebinding the same buffer every frame keeps the steady state
+	const uint32_t frameCount = 100;
+	uint64_t allocationsBefore = allocationCount;
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		dataFrame.BindBuffer(particles, frame % options.flightFrameCount, buffer);
+		auto [state, _] = graph.Execute(frame % options.flightFrameCount, NULL);
+		EXPECT_EQ(state, vkrg::RenderGraphRuntimeState::Success);
+	}
+	EXPECT_EQ(allocationCount - allocationsBefore, 0);
+
+	for (uint32_t i = 0; i < interfaces.size(); i++)
+	{
+		uint32_t expected = i == 3 ? (warmUpFrameCount + frameCount) / 2 : warmUpFrameCount + frameCount;
+		EXPECT_EQ(interfaces[i]->renderCount, expected);
+	}
+}
+
+TEST_F(ComputePassChainTest, EnablePredicateEvaluatedOncePerFrame)
+{
+	// the predicate flips on every call, a second evaluation in the same frame would disagree with the first
+	uint32_t callCount = 0;
+	graph.FindGraphRenderPass("pass3").value().pass->SetEnablePredicate([&](uint32_t) { return callCount++ % 2 == 0; });
+	ASSERT_NO_FATAL_FAILURE(Compile());
+
+	const uint32_t frameCount = 10;
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		graph.Execute(frame % options.flightFrameCount, NULL);
+	}
+
+	EXPECT_EQ(callCount, frameCount);
+	EXPECT_EQ(interfaces[3]->renderCount, frameCount / 2);
+}
+
+TEST(ExecuteTest, RenderScaleSkipsNativeResolutionPasses)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	auto gbuffer = graph.AddGraphResource("gbuffer", info, false).value();
+	auto upscaled = graph.AddGraphResource("upscaled", info, false).value();
+	info.format = VK_FORMAT_B8G8R8A8_UNORM;
+	auto backBuffer = graph.AddGraphResource("backBuffer", info, true, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR).value();
+
+	VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	auto geometry = graph.AddGraphRenderPass("geometry", vkrg::RenderPassType::Graphics).value();
+	geometry.pass->AddImageColorOutput(gbuffer, range);
+
+	// the upscaling pass writes an internal image, it opts out of the render scale itself
+	auto upscale = graph.AddGraphRenderPass("upscale", vkrg::RenderPassType::Graphics).value();
+	upscale.pass->AddImageColorInput(gbuffer, range, VK_IMAGE_VIEW_TYPE_2D);
+	upscale.pass->AddImageColorOutput(upscaled, range);
+	upscale.pass->SetNativeResolution(true);
+
+	auto present = graph.AddGraphRenderPass("present", vkrg::RenderPassType::Graphics).value();
+	present.pass->AddImageColorInput(upscaled, range, VK_IMAGE_VIEW_TYPE_2D);
+	present.pass->AddImageColorOutput(backBuffer, range);
+
+	EXPECT_FALSE(geometry.pass->GetRenderPassExtension().nativeResolution);
+	EXPECT_TRUE(upscale.pass->GetRenderPassExtension().nativeResolution);
+	EXPECT_TRUE(present.pass->GetRenderPassExtension().nativeResolution);
+
+	// passes with different render areas are never merged into one render pass
+	EXPECT_FALSE(geometry.pass->GetRenderPassExtension() == present.pass->GetRenderPassExtension());
+	EXPECT_TRUE(upscale.pass->GetRenderPassExtension() == present.pass->GetRenderPassExtension());
+}
+
+// without a device the profiler writes synthetic timestamps, 1 microsecond apart
+TEST_F(ComputePassChainTest, SyntheticGpuTimings)
+{
+	options.gpuProfiling = true;
+	ASSERT_NO_FATAL_FAILURE(Compile());
+	ASSERT_NO_FATAL_FAILURE(WarmUp());
+
+	uint64_t allocationsBefore = allocationCount;
+	for (uint32_t frame = 0; frame < 10; frame++)
+	{
+		graph.Execute(frame % options.flightFrameCount, NULL);
+	}
+	EXPECT_EQ(allocationCount - allocationsBefore, 0);
+
+	for (uint32_t frameIdx = 0; frameIdx < options.flightFrameCount; frameIdx++)
+	{
+		auto& timings = graph.GetGpuTimings(frameIdx);
+		ASSERT_EQ(timings.size(), interfaces.size());
+
+		for (uint32_t i = 0; i < timings.size(); i++)
+		{
+			EXPECT_EQ(timings[i].name, "pass" + std::to_string(i));
+			EXPECT_EQ(timings[i].depth, 0);
+
+			bool enabled = i != 3 || frameIdx % 2 == 0;
+			EXPECT_EQ(timings[i].valid, enabled);
+			if (enabled)
+			{
+				EXPECT_NEAR(timings[i].milliseconds, 1e-3, 1e-9);
+			}
+		}
+	}
+}
+
+// without a device statistics of recorded passes are valid zeros, compute passes have no attachment traffic
+TEST_F(ComputePassChainTest, SyntheticPipelineStatistics)
+{
+	options.pipelineStatistics = true;
+	ASSERT_NO_FATAL_FAILURE(Compile());
+	ASSERT_NO_FATAL_FAILURE(WarmUp());
+
+	for (uint32_t frameIdx = 0; frameIdx < options.flightFrameCount; frameIdx++)
+	{
+		auto& statistics = graph.GetPipelineStatistics(frameIdx);
+		ASSERT_EQ(statistics.size(), interfaces.size());
+
+		for (uint32_t i = 0; i < statistics.size(); i++)
+		{
+			EXPECT_EQ(statistics[i].name, "pass" + std::to_string(i));
+			EXPECT_EQ(statistics[i].valid, i != 3 || frameIdx % 2 == 0);
+			EXPECT_EQ(statistics[i].computeShaderInvocations, 0);
+		}
+	}
+
+	auto bandwidth = graph.EstimatePassBandwidth();
+	ASSERT_EQ(bandwidth.size(), interfaces.size());
+	for (uint32_t i = 0; i < bandwidth.size(); i++)
+	{
+		EXPECT_EQ(bandwidth[i].name, "pass" + std::to_string(i));
+		EXPECT_EQ(bandwidth[i].loadBytes + bandwidth[i].storeBytes, 0);
+	}
+}
+
+TEST_F(ComputePassChainTest, ExportGpuTimings)
+{
+	options.gpuProfiling = true;
+	ASSERT_NO_FATAL_FAILURE(Compile());
+	ASSERT_NO_FATAL_FAILURE(WarmUp());
+
+	std::stringstream json, dot;
+	graph.ExportJson(json, 0);
+	graph.ExportGraphviz(dot, 0);
+
+	// the passes touch no resources, every cluster is labelled with its timing and no barriers
+	for (uint32_t i = 0; i < interfaces.size(); i++)
+	{
+		std::string cluster = "subgraph cluster_" + std::to_string(i) + " {\n\t\tlabel=\"#" + std::to_string(i) + " compute\\nbarriers: 0\\n";
+		EXPECT_NE(dot.str().find(cluster), std::string::npos) << cluster;
+	}
+	EXPECT_EQ(dot.str().find("->"), std::string::npos);
+	EXPECT_NE(json.str().find("\"gpuMilliseconds\""), std::string::npos);
+}
+
+// adds a compute pass accessing a buffer through a storage attachment
+static vkrg::RenderPassHandle AddBufferPass(vkrg::RenderGraph& graph, const char* name, vkrg::ResourceHandle buffer, vkrg::RenderPassAttachment::Type type)
+{
+	auto pass = graph.AddGraphRenderPass(name, vkrg::RenderPassType::Compute).value();
+	vkrg::BufferSlice range{ 256, 0 };
+	auto attachment = type == vkrg::RenderPassAttachment::BufferStorageInput ? pass.pass->AddBufferStorageInput(buffer, range)
+		: type == vkrg::RenderPassAttachment::BufferStorageOutput ? pass.pass->AddBufferStorageOutput(buffer, range)
+		: pass.pass->AddBufferStorageInputOutput(buffer, range);
+	EXPECT_TRUE(attachment.has_value()) << name;
+	pass.pass->AttachInterface(std::make_shared<EmptyComputePass>(pass.pass.get()));
+	return pass;
+}
+
+// adds a compute pass accessing the whole first mip and layer of an image
+static vkrg::RenderPassHandle AddImagePass(vkrg::RenderGraph& graph, const char* name, vkrg::ResourceHandle image, vkrg::RenderPassAttachment::Type type)
+{
+	auto pass = graph.AddGraphRenderPass(name, vkrg::RenderPassType::Compute).value();
+	vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+	auto attachment = type == vkrg::RenderPassAttachment::ImageColorInput ? pass.pass->AddImageColorInput(image, range, VK_IMAGE_VIEW_TYPE_2D)
+		: type == vkrg::RenderPassAttachment::ImageStorageInput ? pass.pass->AddImageStorageInput(image, range, VK_IMAGE_VIEW_TYPE_2D)
+		: pass.pass->AddImageStorageOutput(image, range, VK_IMAGE_VIEW_TYPE_2D);
+	EXPECT_TRUE(attachment.has_value()) << name;
+	pass.pass->AttachInterface(std::make_shared<EmptyComputePass>(pass.pass.get()));
+	return pass;
+}
+
+// the compiled pass executing a render pass
+static uint32_t PassInfoOf(vkrg::RenderGraph& graph, vkrg::RenderPassHandle pass)
+{
+	for (uint32_t passIdx = 0; passIdx < graph.GetPassInfoCount(); passIdx++)
+	{
+		auto renderPasses = graph.GetPassInfoRenderPasses(passIdx);
+		if (std::find(renderPasses.begin(), renderPasses.end(), pass.idx) != renderPasses.end()) return passIdx;
+	}
+	return UINT32_MAX;
+}
+
+TEST(ExecuteTest, ResourceVersions)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto history = graph.AddGraphResource("history", info, true).value();
+
+	// history is written twice, every reader sees the version written before it in declaration order
+	auto accumulate = AddBufferPass(graph, "accumulate", history, vkrg::RenderPassAttachment::BufferStorageOutput);
+	auto resolve = AddBufferPass(graph, "resolve", history, vkrg::RenderPassAttachment::BufferStorageInput);
+	auto denoise = AddBufferPass(graph, "denoise", history, vkrg::RenderPassAttachment::BufferStorageOutput);
+	auto present = AddBufferPass(graph, "present", history, vkrg::RenderPassAttachment::BufferStorageInput);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	auto resourceOf = [&](vkrg::RenderPassHandle pass) { return pass.pass->GetAttachedResourceHandles()[0]; };
+	EXPECT_EQ(resourceOf(accumulate).idx, history.idx);
+	EXPECT_EQ(resourceOf(resolve).idx, history.idx);
+	EXPECT_EQ(graph.GetResourceVersion(resourceOf(resolve)), 0);
+
+	vkrg::ResourceHandle secondVersion = resourceOf(denoise);
+	EXPECT_NE(secondVersion.idx, history.idx);
+	EXPECT_EQ(resourceOf(present).idx, secondVersion.idx);
+	EXPECT_EQ(graph.GetResourceVersion(secondVersion), 1);
+	EXPECT_TRUE(secondVersion.external);
+	EXPECT_EQ(graph.GetResourceInfo(secondVersion).ext.buffer.size, 256);
+
+	// the second write waits for the reader of the first version
+	EXPECT_LT(PassInfoOf(graph, accumulate), PassInfoOf(graph, resolve));
+	EXPECT_LT(PassInfoOf(graph, resolve), PassInfoOf(graph, denoise));
+	EXPECT_LT(PassInfoOf(graph, denoise), PassInfoOf(graph, present));
+	EXPECT_LT(PassInfoOf(graph, present), graph.GetPassInfoCount());
+	EXPECT_EQ(graph.GetPassInfoName(PassInfoOf(graph, denoise)), "denoise");
+}
+
+TEST(ExecuteTest, ReadWriteAttachments)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto radiance = graph.AddGraphResource("radiance", info, true).value();
+
+	// the filter runs in place, both passes update the buffer written by trace
+	auto trace = AddBufferPass(graph, "trace", radiance, vkrg::RenderPassAttachment::BufferStorageOutput);
+	auto filterX = AddBufferPass(graph, "filter-x", radiance, vkrg::RenderPassAttachment::BufferStorageInputOutput);
+	auto filterY = AddBufferPass(graph, "filter-y", radiance, vkrg::RenderPassAttachment::BufferStorageInputOutput);
+	auto present = AddBufferPass(graph, "present", radiance, vkrg::RenderPassAttachment::BufferStorageInput);
+
+	auto& attachment = filterX.pass->GetAttachments()[0];
+	EXPECT_EQ(attachment.type, vkrg::RenderPassAttachment::BufferStorageInputOutput);
+	EXPECT_EQ(attachment.range.bufferRange.size, 256);
+	EXPECT_TRUE(attachment.ReadFromResource());
+	EXPECT_TRUE(attachment.WriteToResource());
+
+	// color attachments are only loaded by graphics passes
+	vkrg::ImageSlice slice{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	EXPECT_FALSE(filterX.pass->AddImageColorInputOutput(radiance, slice).has_value());
+	EXPECT_FALSE(filterX.pass->AddBufferStorageInputOutput("missing", { 256, 0 }).has_value());
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	// every in place update reads the last version and writes a new one
+	auto versionOf = [&](vkrg::RenderPassHandle pass) { return graph.GetResourceVersion(pass.pass->GetAttachedResourceHandles()[0]); };
+	EXPECT_EQ(versionOf(trace), 0);
+	EXPECT_EQ(versionOf(filterX), 1);
+	EXPECT_EQ(versionOf(filterY), 2);
+	EXPECT_EQ(versionOf(present), 2);
+
+	EXPECT_LT(PassInfoOf(graph, trace), PassInfoOf(graph, filterX));
+	EXPECT_LT(PassInfoOf(graph, filterX), PassInfoOf(graph, filterY));
+	EXPECT_LT(PassInfoOf(graph, filterY), PassInfoOf(graph, present));
+	EXPECT_LT(PassInfoOf(graph, present), graph.GetPassInfoCount());
+}
+
+TEST(ExecuteTest, DispatchGroupsSplitImageLayouts)
+{
+	vkrg::RenderGraph graph;
+
+	// screen sized, like the expected extension of passes by default
+	vkrg::ResourceInfo info = MakeImageInfo(1, 1);
+	info.usages = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+	auto lighting = graph.AddGraphResource("lighting", info, true).value();
+
+	// sampling expects SHADER_READ_ONLY_OPTIMAL while loading from storage expects GENERAL,
+	// one barrier can't transition the image to both layouts
+	auto shade = AddImagePass(graph, "shade", lighting, vkrg::RenderPassAttachment::ImageStorageOutput);
+	auto sample = AddImagePass(graph, "sample", lighting, vkrg::RenderPassAttachment::ImageColorInput);
+	auto load = AddImagePass(graph, "load", lighting, vkrg::RenderPassAttachment::ImageStorageInput);
+	auto reduce = AddImagePass(graph, "reduce", lighting, vkrg::RenderPassAttachment::ImageStorageInput);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.style = vkrg::RenderGraphRenderPassStyle::MergeGraphicsPasses;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	auto groupOf = [&](vkrg::RenderPassHandle pass) { return graph.GetPassInfoMergedPass(PassInfoOf(graph, pass)); };
+	EXPECT_NE(groupOf(shade), groupOf(sample));
+	EXPECT_NE(groupOf(sample), groupOf(load));
+	// readers expecting the same layout still share a group
+	EXPECT_EQ(groupOf(load), groupOf(reduce));
+	EXPECT_LT(PassInfoOf(graph, shade), PassInfoOf(graph, sample));
+}
+
+TEST(ExecuteTest, RenderScaleExtents)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info = MakeImageInfo(1, 1);
+	info.usages = VK_IMAGE_USAGE_STORAGE_BIT;
+	auto lighting = graph.AddGraphResource("lighting", info, false).value();
+	auto upscaled = graph.AddGraphResource("upscaled", info, false).value();
+	auto output = graph.AddGraphResource("output", info, true).value();
+
+	vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+	auto shade = graph.AddGraphRenderPass("shade", vkrg::RenderPassType::Compute).value();
+	auto shadeLighting = shade.pass->AddImageStorageOutput(lighting, range, VK_IMAGE_VIEW_TYPE_2D).value();
+
+	auto upscale = graph.AddGraphRenderPass("upscale", vkrg::RenderPassType::Compute).value();
+	auto upscaleLighting = upscale.pass->AddImageStorageInput(lighting, range, VK_IMAGE_VIEW_TYPE_2D).value();
+	auto upscaleUpscaled = upscale.pass->AddImageStorageOutput(upscaled, range, VK_IMAGE_VIEW_TYPE_2D).value();
+	upscale.pass->SetNativeResolution(true);
+
+	// passes writing external resources are not scaled
+	auto copy = graph.AddGraphRenderPass("copy", vkrg::RenderPassType::Compute).value();
+	auto copyUpscaled = copy.pass->AddImageStorageInput(upscaled, range, VK_IMAGE_VIEW_TYPE_2D).value();
+	auto copyOutput = copy.pass->AddImageStorageOutput(output, range, VK_IMAGE_VIEW_TYPE_2D).value();
+
+	for (auto pass : { shade, upscale, copy })
+	{
+		pass.pass->AttachInterface(std::make_shared<EmptyComputePass>(pass.pass.get()));
+	}
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.screenWidth = 64;
+	options.screenHeight = 32;
+	graph.SetRenderScale(0.5f);
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	auto expectExtent = [](VkExtent3D extent, uint32_t width, uint32_t height)
+	{
+		EXPECT_EQ(extent.width, width);
+		EXPECT_EQ(extent.height, height);
+	};
+	auto expectRenderArea = [](vkrg::RenderPassRuntimeContext& ctx, uint32_t width, uint32_t height)
+	{
+		VkRect2D area = ctx.GetRenderArea();
+		EXPECT_EQ(area.offset.x, 0);
+		EXPECT_EQ(area.offset.y, 0);
+		EXPECT_EQ(area.extent.width, width);
+		EXPECT_EQ(area.extent.height, height);
+
+		VkViewport viewport = ctx.GetViewport();
+		EXPECT_EQ(viewport.x, 0.f);
+		EXPECT_EQ(viewport.y, 0.f);
+		EXPECT_EQ(viewport.width, (float)width);
+		EXPECT_EQ(viewport.height, (float)height);
+		EXPECT_EQ(viewport.minDepth, 0.f);
+		EXPECT_EQ(viewport.maxDepth, 1.f);
+	};
+
+	// the scaled pass renders to the top left quarter of lighting
+	vkrg::RenderPassRuntimeContext shadeCtx(&graph, 0, shade.idx);
+	expectExtent(shadeCtx.GetImageExtent(shadeLighting), 32, 16);
+	expectRenderArea(shadeCtx, 32, 16);
+
+	// lighting is read scaled by the native resolution pass, upscaled is written at native resolution
+	vkrg::RenderPassRuntimeContext upscaleCtx(&graph, 0, upscale.idx);
+	expectExtent(upscaleCtx.GetImageExtent(upscaleLighting), 32, 16);
+	expectExtent(upscaleCtx.GetImageExtent(upscaleUpscaled), 64, 32);
+	expectRenderArea(upscaleCtx, 64, 32);
+
+	vkrg::RenderPassRuntimeContext copyCtx(&graph, 0, copy.idx);
+	expectExtent(copyCtx.GetImageExtent(copyUpscaled), 64, 32);
+	expectExtent(copyCtx.GetImageExtent(copyOutput), 64, 32);
+	expectRenderArea(copyCtx, 64, 32);
+}
+
+TEST(ExecuteTest, DynamicRenderingEligibility)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info = MakeImageInfo(1, 1);
+	auto gbuffer = graph.AddGraphResource("gbuffer", info, false).value();
+	auto hdr = graph.AddGraphResource("hdr", info, false).value();
+	auto ui = graph.AddGraphResource("ui", info, false).value();
+	auto backBuffer = graph.AddGraphResource("backBuffer", info, true).value();
+
+	vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+	auto geometry = graph.AddGraphRenderPass("geometry", vkrg::RenderPassType::Graphics).value();
+	geometry.pass->AddImageColorOutput(gbuffer, range);
+
+	// merged with geometry through gbuffer
+	auto lighting = graph.AddGraphRenderPass("lighting", vkrg::RenderPassType::Graphics).value();
+	lighting.pass->AddImageColorInput(gbuffer, range, VK_IMAGE_VIEW_TYPE_2D);
+	lighting.pass->AddImageColorOutput(hdr, range);
+
+	// alone in its render pass, but it reads an input attachment
+	auto tonemap = graph.AddGraphRenderPass("tonemap", vkrg::RenderPassType::Graphics).value();
+	tonemap.pass->AddImageColorInput(hdr, range, VK_IMAGE_VIEW_TYPE_2D);
+	tonemap.pass->AddImageColorOutput(backBuffer, range);
+
+	// shares no attachment with other passes
+	auto overlay = graph.AddGraphRenderPass("overlay", vkrg::RenderPassType::Graphics).value();
+	overlay.pass->AddImageColorOutput(ui, range);
+
+	for (auto pass : { geometry, lighting, tonemap, overlay })
+	{
+		pass.pass->AttachInterface(std::make_shared<EmptyGraphicsPass>(pass.pass.get()));
+	}
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.style = vkrg::RenderGraphRenderPassStyle::MergeGraphicsPasses;
+	options.dynamicRendering = true;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	ASSERT_EQ(PassInfoOf(graph, geometry), PassInfoOf(graph, lighting));
+	EXPECT_EQ(graph.GetPassInfoRenderPasses(PassInfoOf(graph, tonemap)).size(), 1);
+	EXPECT_EQ(graph.GetPassInfoRenderPasses(PassInfoOf(graph, overlay)).size(), 1);
+
+	// only render passes with a single subpass and without input attachments are recorded with dynamic rendering
+	EXPECT_FALSE(graph.GetCompiledRenderingFormats(geometry).has_value());
+	EXPECT_FALSE(graph.GetCompiledRenderingFormats(lighting).has_value());
+	EXPECT_FALSE(graph.GetCompiledRenderingFormats(tonemap).has_value());
+	auto overlayFormats = graph.GetCompiledRenderingFormats(overlay);
+	ASSERT_TRUE(overlayFormats.has_value());
+	ASSERT_EQ(overlayFormats->colorFormats.size(), 1);
+	EXPECT_EQ(overlayFormats->colorFormats[0], VK_FORMAT_R8G8B8A8_UNORM);
+}
+
+static vkrg::RenderPassHandle AddGraphicsPass(vkrg::RenderGraph& graph, const char* name)
+{
+	auto pass = graph.AddGraphRenderPass(name, vkrg::RenderPassType::Graphics).value();
+	pass.pass->AttachInterface(std::make_shared<EmptyGraphicsPass>(pass.pass.get()));
+	return pass;
+}
+
+static vkrg::ResourceHandle AddImage(vkrg::RenderGraph& graph, const char* name, VkFormat format)
+{
+	vkrg::ResourceInfo info = MakeImageInfo(1, 1);
+	info.format = format;
+	return graph.AddGraphResource(name, info, false).value();
+}
+
+static void CompileMergingGraphicsPasses(vkrg::RenderGraph& graph)
+{
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.style = vkrg::RenderGraphRenderPassStyle::MergeGraphicsPasses;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+}
+
+// a pass is merged into the render pass it depends on only if the score, the bytes per pixel merging saves, is positive
+TEST(ExecuteTest, MergeScoreSharedAttachments)
+{
+	vkrg::RenderGraph graph;
+	auto gbuffer = AddImage(graph, "gbuffer", VK_FORMAT_R8G8B8A8_UNORM);
+	auto hdr = AddImage(graph, "hdr", VK_FORMAT_R16G16B16A16_SFLOAT);
+	auto output = AddImage(graph, "output", VK_FORMAT_R8G8B8A8_UNORM);
+
+	vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+	auto geometry = AddGraphicsPass(graph, "geometry");
+	geometry.pass->AddImageColorOutput(gbuffer, range);
+
+	// reads gbuffer as an input attachment, saves storing and loading it. hdr is not shared and saves nothing
+	auto lighting = AddGraphicsPass(graph, "lighting");
+	lighting.pass->AddImageColorInput(gbuffer, range, VK_IMAGE_VIEW_TYPE_2D);
+	lighting.pass->AddImageColorOutput(hdr, range);
+
+	// shares hdr, but passes rendering to a different area are never merged
+	auto composite = AddGraphicsPass(graph, "composite");
+	composite.pass->AddImageColorInput(hdr, range, VK_IMAGE_VIEW_TYPE_2D);
+	composite.pass->AddImageColorOutput(output, range);
+	composite.pass->SetNativeResolution(true);
+
+	CompileMergingGraphicsPasses(graph);
+
+	EXPECT_EQ(PassInfoOf(graph, geometry), PassInfoOf(graph, lighting));
+	EXPECT_NE(PassInfoOf(graph, lighting), PassInfoOf(graph, composite));
+}
+
+TEST(ExecuteTest, MergeScoreDeadAttachments)
+{
+	// shade writes a wide attachment not shared with mark besides mask. when nothing after shade reads it, merging mark
+	// keeps it alive through mark's subpass, which costs more than mark saves by reading the narrow mask as an input attachment
+	for (bool wideRead : { false, true })
+	{
+		vkrg::RenderGraph graph;
+		auto wide = AddImage(graph, "wide", VK_FORMAT_R32G32B32A32_SFLOAT);
+		auto mask = AddImage(graph, "mask", VK_FORMAT_R8_UNORM);
+		auto marked = AddImage(graph, "marked", VK_FORMAT_R8_UNORM);
+
+		vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+		auto shade = AddGraphicsPass(graph, "shade");
+		shade.pass->AddImageColorOutput(wide, range);
+		shade.pass->AddImageColorOutput(mask, range);
+
+		auto mark = AddGraphicsPass(graph, "mark");
+		mark.pass->AddImageColorInput(mask, range, VK_IMAGE_VIEW_TYPE_2D);
+		mark.pass->AddImageColorOutput(marked, range);
+
+		// resolve renders to a different area, it is neither merged nor scored as a pass joining shade's render pass
+		if (wideRead)
+		{
+			auto resolve = AddGraphicsPass(graph, "resolve");
+			resolve.pass->SetNativeResolution(true);
+			resolve.pass->AddImageColorInput(wide, range, VK_IMAGE_VIEW_TYPE_2D);
+			resolve.pass->AddImageColorOutput(AddImage(graph, "resolved", VK_FORMAT_R8_UNORM), range);
+		}
+
+		CompileMergingGraphicsPasses(graph);
+
+		// wide is alive after shade anyway when it's read later, merging only saves bandwidth
+		EXPECT_EQ(PassInfoOf(graph, shade) == PassInfoOf(graph, mark), wideRead);
+	}
+}
+
+// overrides the load and store operations of attachments
+class AttachmentOperationPass : public EmptyGraphicsPass
+{
+public:
+	AttachmentOperationPass(vkrg::RenderPass* pass)
+		:EmptyGraphicsPass(pass)
+	{}
+
+	virtual void GetAttachmentStoreLoadOperation(uint32_t attachment, VkAttachmentLoadOp& loadOp, VkAttachmentStoreOp& storeOp,
+		VkAttachmentLoadOp& stencilLoadOp, VkAttachmentStoreOp& stencilStoreOp) override
+	{
+		auto op = operations.find(attachment);
+		if (op == operations.end()) return;
+		loadOp = op->second.first;
+		storeOp = op->second.second;
+	}
+
+	std::unordered_map<uint32_t, std::pair<VkAttachmentLoadOp, VkAttachmentStoreOp>> operations;
+};
+
+// the first subpass using an attachment records its load and store operations, later subpasses of the render pass share them
+TEST(ExecuteTest, MergedSubpassAttachmentOperations)
+{
+	vkrg::RenderGraph graph;
+	auto gbuffer = AddImage(graph, "gbuffer", VK_FORMAT_R8G8B8A8_UNORM);
+	auto hdr = AddImage(graph, "hdr", VK_FORMAT_R16G16B16A16_SFLOAT);
+
+	vkrg::ImageSlice range = MakeSlice(0, 1, 0, 1);
+	auto geometry = graph.AddGraphRenderPass("geometry", vkrg::RenderPassType::Graphics).value();
+	auto geometryGbuffer = geometry.pass->AddImageColorOutput(gbuffer, range).value();
+	auto geometryInterface = std::make_shared<AttachmentOperationPass>(geometry.pass.get());
+	geometryInterface->operations[geometryGbuffer.idx] = { VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE };
+	geometry.pass->AttachInterface(geometryInterface);
+
+	// gbuffer keeps the operations geometry recorded, by default a new attachment would be stored
+	auto lighting = graph.AddGraphRenderPass("lighting", vkrg::RenderPassType::Graphics).value();
+	lighting.pass->AddImageColorInput(gbuffer, range, VK_IMAGE_VIEW_TYPE_2D);
+	auto lightingHdr = lighting.pass->AddImageColorOutput(hdr, range).value();
+	auto lightingInterface = std::make_shared<AttachmentOperationPass>(lighting.pass.get());
+	lightingInterface->operations[lightingHdr.idx] = { VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE };
+	lighting.pass->AttachInterface(lightingInterface);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.screenWidth = 8;
+	options.screenHeight = 4;
+	options.style = vkrg::RenderGraphRenderPassStyle::MergeGraphicsPasses;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	uint32_t passIdx = PassInfoOf(graph, geometry);
+	ASSERT_EQ(passIdx, PassInfoOf(graph, lighting));
+
+	// gbuffer and hdr are loaded, only hdr is stored
+	auto bandwidth = graph.EstimatePassBandwidth();
+	ASSERT_LT(passIdx, bandwidth.size());
+	EXPECT_EQ(bandwidth[passIdx].loadBytes, 8 * 4 * (4 + 8));
+	EXPECT_EQ(bandwidth[passIdx].storeBytes, 8 * 4 * 8);
+}
+
+TEST(ExecuteTest, ExportCompiledGraph)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto history = graph.AddGraphResource("history", info, true).value();
+
+	AddBufferPass(graph, "accumulate", history, vkrg::RenderPassAttachment::BufferStorageOutput);
+	AddBufferPass(graph, "resolve", history, vkrg::RenderPassAttachment::BufferStorageInput);
+	AddBufferPass(graph, "denoise", history, vkrg::RenderPassAttachment::BufferStorageOutput);
+	AddBufferPass(graph, "present", history, vkrg::RenderPassAttachment::BufferStorageInput);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	std::stringstream json, dot;
+	graph.ExportJson(json, 0);
+	graph.ExportGraphviz(dot, 0);
+	std::string dotText = dot.str(), jsonText = json.str();
+
+	auto count = [](const std::string& text, const std::string& pattern)
+	{
+		uint32_t count = 0;
+		for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) count++;
+		return count;
+	};
+
+	// writers point to the version they write, readers are pointed to by the version they read
+	EXPECT_EQ(count(dotText, " -> "), 4);
+	for (const char* edge : { "pass0 -> resource0;", "resource0 -> pass1;", "pass2 -> resource1;", "resource1 -> pass3;" })
+	{
+		EXPECT_EQ(count(dotText, edge), 1) << edge;
+	}
+
+	// every pass waits for the last access of the shared buffer, nothing is transitioned at the end of the frame
+	for (uint32_t passIdx = 0; passIdx < 4; passIdx++)
+	{
+		std::string label = "label=\"#" + std::to_string(passIdx) + " compute\\nbarriers: 1\"";
+		EXPECT_EQ(count(dotText, label), 1) << label;
+	}
+	EXPECT_EQ(count(jsonText, "\"kind\": \"before\""), 4);
+	EXPECT_EQ(count(jsonText, "{\"resource\": \"history\""), 4);
+	EXPECT_NE(jsonText.find("\"finalBarriers\": []"), std::string::npos);
+}
+
+TEST(ExecuteTest, ExportChromeTraceEscapesNames)
+{
+	// names of traced scopes could come from pass names in graph files
+	vkrg::Tracer::Clear();
+	vkrg::Tracer::Record("pass \"shade\\lights\"\n", 1000, 3000);
+
+	const char* path = "vkrg_trace_test.json";
+	ASSERT_TRUE(vkrg::Tracer::ExportChromeTrace(path));
+	std::ifstream file(path);
+	std::stringstream trace;
+	trace << file.rdbuf();
+	file.close();
+	std::remove(path);
+	vkrg::Tracer::Clear();
+
+	EXPECT_NE(trace.str().find("{\"name\":\"pass \\\"shade\\\\lights\\\"\\n\",\"ph\":\"X\""), std::string::npos) << trace.str();
+}
+
+TEST(ExecuteTest, BindExternalResourcesByHandle)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto particles = graph.AddGraphResource("particles", info, true).value();
+
+	auto pass = graph.AddGraphRenderPass("simulate", vkrg::RenderPassType::Compute).value();
+	ASSERT_TRUE(pass.pass->AddBufferStorageOutput(particles, { 256, 0 }).has_value());
+	pass.pass->AttachInterface(std::make_shared<EmptyComputePass>(pass.pass.get()));
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 2;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	// literals are hashed at compile time, names are found without copying them
+	constexpr vkrg::HashedName name("particles");
+	static_assert(name.hash == vkrg::HashName("particles"));
+	EXPECT_EQ(graph.FindGraphResource(name).value().idx, particles.idx);
+	EXPECT_FALSE(graph.FindGraphResource("missing").has_value());
+
+	auto dataFrame = graph.GetExternalDataFrame();
+	vkrg::ptr<gvk::Buffer> buffer;
+	EXPECT_FALSE(dataFrame.BindImage(particles, 0, nullptr));
+	EXPECT_FALSE(dataFrame.BindBuffer(particles, options.flightFrameCount, buffer));
+
+	const uint32_t frameCount = 100;
+	uint64_t allocationsBefore = allocationCount;
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		EXPECT_TRUE(dataFrame.BindBuffer(particles, frame % options.flightFrameCount, buffer));
+		EXPECT_TRUE(dataFrame.BindBuffer("particles", frame % options.flightFrameCount, buffer));
+	}
+	EXPECT_EQ(allocationCount - allocationsBefore, 0);
+}
+
+// lighting writes the external output and reads depth, debug-a and debug-b only feed each other
+static void BuildCullingGraph(vkrg::RenderGraph& graph, std::vector<vkrg::RenderPassHandle>& passes)
+{
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto output = graph.AddGraphResource("output", info, true).value();
+	auto depth = graph.AddGraphResource("depth", info, false).value();
+	auto debugData = graph.AddGraphResource("debug-data", info, false).value();
+	auto debugOutput = graph.AddGraphResource("debug-output", info, false).value();
+
+	auto depthPass = AddBufferPass(graph, "depth", depth, vkrg::RenderPassAttachment::BufferStorageOutput);
+	auto lighting = AddBufferPass(graph, "lighting", depth, vkrg::RenderPassAttachment::BufferStorageInput);
+	EXPECT_TRUE(lighting.pass->AddBufferStorageOutput(output, { 256, 0 }).has_value());
+	auto debugA = AddBufferPass(graph, "debug-a", debugData, vkrg::RenderPassAttachment::BufferStorageOutput);
+	auto debugB = AddBufferPass(graph, "debug-b", debugData, vkrg::RenderPassAttachment::BufferStorageInput);
+	EXPECT_TRUE(debugB.pass->AddBufferStorageOutput(debugOutput, { 256, 0 }).has_value());
+
+	passes = { depthPass, lighting, debugA, debugB };
+}
+
+TEST(ExecuteTest, CullUnreachablePasses)
+{
+	vkrg::RenderGraph graph;
+	std::vector<vkrg::RenderPassHandle> passes;
+	BuildCullingGraph(graph, passes);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.cullUnreachablePasses = true;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+	// culled passes are reported by GetCulledRenderPasses, not by the compile message
+	EXPECT_TRUE(compileMsg.empty());
+
+	// lighting writes an external resource, depth writes a resource read by lighting after it
+	EXPECT_FALSE(graph.IsRenderPassCulled(passes[0]));
+	EXPECT_FALSE(graph.IsRenderPassCulled(passes[1]));
+	EXPECT_TRUE(graph.IsRenderPassCulled(passes[2]));
+	EXPECT_TRUE(graph.IsRenderPassCulled(passes[3]));
+
+	auto culledPasses = graph.GetCulledRenderPasses();
+	ASSERT_EQ(culledPasses.size(), 2);
+	EXPECT_EQ(culledPasses[0].idx, passes[2].idx);
+	EXPECT_EQ(culledPasses[1].idx, passes[3].idx);
+	EXPECT_EQ(PassInfoOf(graph, passes[2]), UINT32_MAX);
+	EXPECT_LT(PassInfoOf(graph, passes[0]), PassInfoOf(graph, passes[1]));
+}
+
+TEST(ExecuteTest, CullingIsOffByDefault)
+{
+	vkrg::RenderGraph graph;
+	std::vector<vkrg::RenderPassHandle> passes;
+	BuildCullingGraph(graph, passes);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	EXPECT_TRUE(graph.GetCulledRenderPasses().empty());
+	for (auto& pass : passes)
+	{
+		EXPECT_LT(PassInfoOf(graph, pass), graph.GetPassInfoCount());
+	}
+}
+
+TEST(ExecuteTest, CacheCapacityCoversSwapchainRotation)
+{
+	vkrg::RenderGraph graph;
+
+	vkrg::ResourceInfo info;
+	info.extType = vkrg::ResourceExtensionType::Buffer;
+	info.ext.buffer.size = 256;
+	auto particles = graph.AddGraphResource("particles", info, true).value();
+	auto counters = graph.AddGraphResource("counters", info, true).value();
+	AddBufferPass(graph, "simulate", particles, vkrg::RenderPassAttachment::BufferStorageOutput);
+	AddBufferPass(graph, "count", counters, vkrg::RenderPassAttachment::BufferStorageOutput);
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 2;
+	options.swapchainImageCount = 3;
+	auto [compileState, compileMsg] = graph.Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	// every external resource could be bound to any of the swapchain images while the older ones are on flight
+	const uint32_t capacity = (options.swapchainImageCount + options.flightFrameCount) * 2;
+	EXPECT_EQ(graph.GetImageViewCacheStatistics().capacity, capacity);
+	EXPECT_EQ(graph.GetFrameBufferCacheStatistics().capacity, capacity);
+}
+
+int main() {
+	testing::InitGoogleTest();
+	RUN_ALL_TESTS();
+}
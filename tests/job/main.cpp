@@ -0,0 +1,198 @@
+#include "vkrg/job.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+// fixed amount of cpu work to emulate the cost of OnRender.
+// busy waiting for some time would let threads sharing a core finish at the same time
+static uint64_t Work(uint64_t iterations)
+{
+	volatile uint64_t value = 1;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		value = value * 6364136223846793005ull + 1442695040888963407ull;
+	}
+	return value;
+}
+
+static double IterationsPerMicrosecond()
+{
+	const uint64_t iterations = 1 << 20;
+	double best = 0;
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		Work(iterations);
+		double time = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		best = std::max(best, iterations / time);
+	}
+	return best;
+}
+
+// timings depend on the machine and its load, the benchmark only reports them unless VKRG_ASSERT_JOB_SCALING is set
+static bool AssertScaling()
+{
+	return std::getenv("VKRG_ASSERT_JOB_SCALING") != nullptr;
+}
+
+TEST(JobSystemTest, EveryTaskRunsOnce)
+{
+	const uint32_t taskCount = 257;
+	for (uint32_t workerCount = 1; workerCount <= 8; workerCount++)
+	{
+		vkrg::JobSystem jobs(workerCount);
+		for (uint32_t iteration = 0; iteration < 50; iteration++)
+		{
+			std::vector<std::atomic<uint32_t>> hits(taskCount);
+			for (auto& hit : hits) hit = 0;
+
+			jobs.Dispatch(taskCount, [&](uint32_t taskIdx, uint32_t workerIdx)
+				{
+					EXPECT_LT(workerIdx, workerCount);
+					hits[taskIdx]++;
+				});
+
+			for (auto& hit : hits)
+			{
+				ASSERT_EQ(hit.load(), 1);
+			}
+		}
+	}
+}
+
+TEST(JobSystemTest, DependenciesAreRespected)
+{
+	// a chain 0 -> 1 -> ... -> 15 plus every task i (i >= 16) depending on task i - 16
+	const uint32_t taskCount = 160;
+	std::vector<std::vector<uint32_t>> successors(taskCount);
+	for (uint32_t i = 0; i + 1 < 16; i++)
+	{
+		successors[i].push_back(i + 1);
+	}
+	for (uint32_t i = 16; i < taskCount; i++)
+	{
+		successors[i - 16].push_back(i);
+	}
+
+	for (uint32_t workerCount = 1; workerCount <= 8; workerCount++)
+	{
+		vkrg::JobSystem jobs(workerCount);
+		for (uint32_t iteration = 0; iteration < 20; iteration++)
+		{
+			std::vector<std::atomic<uint32_t>> finished(taskCount);
+			for (auto& f : finished) f = 0;
+
+			jobs.Dispatch(taskCount, [&](uint32_t taskIdx, uint32_t workerIdx)
+				{
+					for (uint32_t i = 0; i < taskCount; i++)
+					{
+						for (auto successor : successors[i])
+						{
+							if (successor == taskIdx)
+							{
+								EXPECT_EQ(finished[i].load(), 1);
+							}
+						}
+					}
+					finished[taskIdx] = 1;
+				}, &successors);
+
+			for (auto& f : finished)
+			{
+				ASSERT_EQ(f.load(), 1);
+			}
+		}
+	}
+}
+
+// one heavy g-buffer like pass followed by dozens of small post processing passes
+// compares the work stealing job system with splitting tasks to threads round-robin.
+// the fastest of the frames is measured to filter out preemption by other processes.
+// results are recorded as test properties, run with --gtest_output=xml to collect them
+TEST(JobSystemTest, RecordingScalingBenchmark)
+{
+	std::vector<uint32_t> costs;
+	costs.push_back(4000);
+	for (uint32_t i = 0; i < 8; i++) costs.push_back(500);
+	for (uint32_t i = 0; i < 48; i++) costs.push_back(60);
+
+	uint32_t totalCost = 0;
+	for (auto cost : costs) totalCost += cost;
+
+	const uint32_t frameCount = 10;
+	const uint32_t hardwareThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	const double iterationsPerMicrosecond = IterationsPerMicrosecond();
+	RecordProperty("totalCostUs", totalCost);
+	RecordProperty("hardwareThreads", hardwareThreadCount);
+
+	auto measure = [&](auto&& recordFrame)
+	{
+		double best = 0;
+		for (uint32_t frame = 0; frame < frameCount; frame++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			recordFrame();
+			double time = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+			best = frame == 0 ? time : std::min(best, time);
+		}
+		return best;
+	};
+
+	double singleThreadTime = measure([&]()
+		{
+			for (auto cost : costs) Work(cost * iterationsPerMicrosecond);
+		});
+
+	for (uint32_t workerCount = 1; workerCount <= 16; workerCount *= 2)
+	{
+		vkrg::JobSystem jobs(workerCount);
+
+		double stealingTime = measure([&]()
+			{
+				jobs.Dispatch(costs.size(), [&](uint32_t taskIdx, uint32_t workerIdx)
+					{
+						Work(costs[taskIdx] * iterationsPerMicrosecond);
+					});
+			});
+
+		double roundRobinTime = measure([&]()
+			{
+				std::vector<std::thread> threads;
+				for (uint32_t workerIdx = 0; workerIdx < workerCount; workerIdx++)
+				{
+					threads.emplace_back([&, workerIdx]()
+						{
+							for (uint32_t taskIdx = workerIdx; taskIdx < costs.size(); taskIdx += workerCount)
+							{
+								Work(costs[taskIdx] * iterationsPerMicrosecond);
+							}
+						});
+				}
+				for (auto& thread : threads) thread.join();
+			});
+
+		// workers beyond hardware threads don't help, and the heavy pass bounds the frame time
+		uint32_t threadCount = std::min(workerCount, hardwareThreadCount);
+		double bestSpeedUp = totalCost / std::max((double)totalCost / threadCount, (double)costs[0]);
+		double speedUp = singleThreadTime / stealingTime;
+
+		std::string suffix = "_" + std::to_string(workerCount) + "Threads";
+		RecordProperty("workStealingUs" + suffix, (int)stealingTime);
+		RecordProperty("workStealingSpeedUp" + suffix, std::to_string(speedUp));
+		RecordProperty("roundRobinUs" + suffix, (int)roundRobinTime);
+		RecordProperty("roundRobinSpeedUp" + suffix, std::to_string(singleThreadTime / roundRobinTime));
+		RecordProperty("bestSpeedUp" + suffix, std::to_string(bestSpeedUp));
+
+		if (AssertScaling())
+		{
+			// work stealing should reach at least 60% of the best possible speed up over recording on one thread
+			EXPECT_GE(speedUp, 0.6 * bestSpeedUp);
+		}
+	}
+}
+
+int main() {
+	testing::InitGoogleTest();
+	RUN_ALL_TESTS();
+}
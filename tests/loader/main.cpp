@@ -0,0 +1,535 @@
+#include "vkrg/graph.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <sstream>
+#include <unordered_map>
+
+class LoadedComputePass : public vkrg::RenderPassInterface
+{
+public:
+	LoadedComputePass(vkrg::RenderPass* pass, const std::vector<vkrg::RenderPassAttachment>& attachments)
+		:vkrg::RenderPassInterface(pass), attachments(attachments)
+	{}
+
+	virtual void OnRender(vkrg::RenderPassRuntimeContext& ctx, VkCommandBuffer cmd) override
+	{
+		renderCount++;
+	}
+
+	virtual vkrg::RenderPassType ExpectedType() override
+	{
+		return vkrg::RenderPassType::Compute;
+	}
+
+	std::vector<vkrg::RenderPassAttachment> attachments;
+	uint32_t renderCount = 0;
+};
+
+class LoadedGraphicsPass : public vkrg::RenderPassInterface
+{
+public:
+	LoadedGraphicsPass(vkrg::RenderPass* pass, const std::vector<vkrg::RenderPassAttachment>& attachments)
+		:vkrg::RenderPassInterface(pass), attachments(attachments)
+	{}
+
+	virtual void OnRender(vkrg::RenderPassRuntimeContext& ctx, VkCommandBuffer cmd) override {}
+
+	virtual vkrg::RenderPassType ExpectedType() override
+	{
+		return vkrg::RenderPassType::Graphics;
+	}
+
+	std::vector<vkrg::RenderPassAttachment> attachments;
+};
+
+// interfaces created by the prototypes, indexed by the passes they are attached to
+static std::unordered_map<vkrg::RenderPass*, std::shared_ptr<vkrg::RenderPassInterface>> loadedInterfaces;
+
+template<typename T>
+static std::shared_ptr<T> FindLoadedInterface(vkrg::RenderGraph& graph, const char* name)
+{
+	auto pass = graph.FindGraphRenderPass(name);
+	if (!pass.has_value() || !loadedInterfaces.count(pass.value().pass.get())) return nullptr;
+	return std::dynamic_pointer_cast<T>(loadedInterfaces[pass.value().pass.get()]);
+}
+
+static void RegisterPrototypes()
+{
+	static bool registered = false;
+	if (registered) return;
+
+	auto& registry = vkrg::RenderPassPrototypeRegistry::Global();
+	registry.Register("compute", [](vkrg::RenderPass* pass, const std::vector<vkrg::RenderPassAttachment>& attachments)
+		{
+			auto rpi = std::make_shared<LoadedComputePass>(pass, attachments);
+			loadedInterfaces[pass] = rpi;
+			return rpi;
+		});
+	registry.Register("graphics", [](vkrg::RenderPass* pass, const std::vector<vkrg::RenderPassAttachment>& attachments)
+		{
+			auto rpi = std::make_shared<LoadedGraphicsPass>(pass, attachments);
+			loadedInterfaces[pass] = rpi;
+			return rpi;
+		});
+	registered = true;
+}
+
+TEST(LoaderTest, NameInterner)
+{
+	vkrg::NameInterner names;
+	uint32_t a = names.Intern("gbuffer");
+	uint32_t b = names.Intern("shading");
+	EXPECT_EQ(names.Intern(std::string("gbuffer")), a);
+	EXPECT_NE(a, b);
+	EXPECT_EQ(names.Find("shading"), b);
+	EXPECT_EQ(names.Find("missing"), vkrg::NameInterner::invalidId);
+	EXPECT_EQ(names.Get(b), "shading");
+	EXPECT_EQ(names.Count(), 2);
+
+	// views of longer names are hashed by the viewed characters only
+	std::string_view prefix = std::string_view("shading.pass").substr(0, 7);
+	EXPECT_EQ(vkrg::HashedName(prefix).hash, vkrg::HashName("shading"));
+	EXPECT_EQ(names.Find(prefix), b);
+}
+
+TEST(LoaderTest, LoadGraphicsPasses)
+{
+	RegisterPrototypes();
+
+	const char* json = R"({
+	"resources" : [
+		{ "name" : "backBuffer", "format" : "bgra8", "extent" : { "screen-scale" : 1 }, "external" : true, "final-layout" : "present" },
+		{ "name" : "lights", "layout" : "buffer", "extent" : { "size" : 1024 }, "usage" : [ "transfer-dst" ] }
+	],
+	"passes" : [
+		{
+			"name" : "gbuffer", "type" : "render-pass", "prototype" : "graphics",
+			"output" : [
+				{ "name" : "color", "layout" : "texture2d", "format" : "rgba8", "extent" : { "screen-scale" : 1 } },
+				{ "name" : "depth", "format" : "d24s8", "extent" : { "screen-scale" : 1 } }
+			]
+		},
+		{
+			"name" : "shading", "type" : "render-pass", "prototype" : "graphics",
+			"input" : [ { "name" : "color" }, { "name" : "depth" }, { "name" : "lights" } ],
+			"output" : [ { "name" : "backBuffer" } ]
+		}
+	],
+	"edges" : [ { "out" : { "pass" : "gbuffer" }, "in" : "shading" } ]
+})";
+
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	auto color = graph.value()->FindGraphResource("color");
+	auto lights = graph.value()->FindGraphResource("lights");
+	ASSERT_TRUE(color.has_value());
+	ASSERT_TRUE(lights.has_value());
+
+	vkrg::ResourceInfo colorInfo = graph.value()->GetResourceInfo(color.value());
+	EXPECT_EQ(colorInfo.format, VK_FORMAT_R8G8B8A8_UNORM);
+	EXPECT_EQ(colorInfo.extType, vkrg::ResourceExtensionType::Screen);
+	vkrg::ResourceInfo lightsInfo = graph.value()->GetResourceInfo(lights.value());
+	EXPECT_TRUE(lightsInfo.IsBuffer());
+	EXPECT_EQ(lightsInfo.ext.buffer.size, 1024);
+
+	auto gbufferPass = FindLoadedInterface<LoadedGraphicsPass>(*graph.value(), "gbuffer");
+	auto shadingPass = FindLoadedInterface<LoadedGraphicsPass>(*graph.value(), "shading");
+	ASSERT_NE(gbufferPass, nullptr);
+	ASSERT_NE(shadingPass, nullptr);
+
+	ASSERT_EQ(gbufferPass->attachments.size(), 2);
+	EXPECT_EQ(gbufferPass->attachments[0].type, vkrg::RenderPassAttachment::ImageColorOutput);
+	EXPECT_EQ(gbufferPass->attachments[1].type, vkrg::RenderPassAttachment::ImageDepthOutput);
+
+	ASSERT_EQ(shadingPass->attachments.size(), 4);
+	EXPECT_EQ(shadingPass->attachments[0].type, vkrg::RenderPassAttachment::ImageColorInput);
+	EXPECT_EQ(shadingPass->attachments[1].type, vkrg::RenderPassAttachment::ImageColorInput);
+	EXPECT_EQ(shadingPass->attachments[2].type, vkrg::RenderPassAttachment::BufferInput);
+	EXPECT_EQ(shadingPass->attachments[3].type, vkrg::RenderPassAttachment::ImageColorOutput);
+}
+
+TEST(LoaderTest, LoadAndExecuteComputePasses)
+{
+	RegisterPrototypes();
+
+	const char* json = R"({
+	"passes" : [
+		{ "name" : "cull", "type" : "compute-pass", "prototype" : "compute" },
+		{ "name" : "shade", "type" : "compute-pass", "prototype" : "compute" }
+	],
+	"edges" : [ { "out" : "cull", "in" : "shade" } ]
+})";
+
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.value()->Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	auto [state, executeMsg] = graph.value()->Execute(0, NULL);
+	ASSERT_EQ(state, vkrg::RenderGraphRuntimeState::Success) << executeMsg;
+
+	for (const char* name : { "cull", "shade" })
+	{
+		auto pass = FindLoadedInterface<LoadedComputePass>(*graph.value(), name);
+		ASSERT_NE(pass, nullptr);
+		EXPECT_EQ(pass->renderCount, 1);
+	}
+}
+
+TEST(LoaderTest, ReportErrors)
+{
+	RegisterPrototypes();
+
+	struct
+	{
+		const char* json;
+		const char* error;
+	} cases[] =
+	{
+		{ "{ \"passes\" : [ { \"name\" : \"a\" }\n { \"name\" : \"b\" } ] }", "line 2" },
+		{ "{ \"passes\" : [ { \"name\" : \"a\", \"prototype\" : \"missing\" } ] }", "prototype missing is not registered" },
+		{ "{ \"passes\" : [ { \"name\" : \"a\" }, { \"name\" : \"a\" } ] }", "pass a is declared twice" },
+		{ "{ \"passes\" : [ { \"name\" : \"a\", \"input\" : [ { \"name\" : \"color\" } ] } ] }", "resource color is not declared" },
+		{ "{ \"resources\" : [ { \"name\" : \"color\", \"format\" : \"rgb5\" } ] }", "unknown format" },
+		{ "{ \"passes\" : [ { \"name\" : \"a\" } ], \"edges\" : [ { \"out\" : \"a\", \"in\" : \"b\" } ] }", "refers to undeclared pass" },
+		{ "{ \"passes\" : [] } }", "unexpected content after document" },
+	};
+
+	for (uint32_t i = 0; i < _countof(cases); i++)
+	{
+		std::string msg;
+		auto graph = vkrg::RenderGraph::LoadFromJsonString(cases[i].json, &msg);
+		EXPECT_FALSE(graph.has_value()) << cases[i].json;
+		EXPECT_NE(msg.find(cases[i].error), std::string::npos) << msg;
+	}
+}
+
+// chain of compute passes, every pass reads the storage buffer written by the previous one
+static std::string GenerateComputeChainDocument(uint32_t passCount)
+{
+	std::string json = "{\n\"resources\" : [\n";
+	for (uint32_t i = 0; i < passCount; i++)
+	{
+		json += "\t{ \"name\" : \"buffer" + std::to_string(i) + "\", \"layout\" : \"buffer\", \"extent\" : { \"size\" : 256 } }";
+		json += i + 1 == passCount ? "\n" : ",\n";
+	}
+	json += "],\n\"passes\" : [\n";
+	for (uint32_t i = 0; i < passCount; i++)
+	{
+		json += "\t{ \"name\" : \"pass" + std::to_string(i) + "\", \"type\" : \"compute-pass\", \"prototype\" : \"compute\", ";
+		if (i != 0)
+		{
+			json += "\"input\" : [ { \"name\" : \"buffer" + std::to_string(i - 1) + "\", \"usage\" : \"storage\" } ], ";
+		}
+		json += "\"output\" : [ { \"name\" : \"buffer" + std::to_string(i) + "\", \"usage\" : \"storage\" } ] }";
+		json += i + 1 == passCount ? "\n" : ",\n";
+	}
+	json += "],\n\"edges\" : [\n";
+	for (uint32_t i = 1; i < passCount; i++)
+	{
+		json += "\t{ \"out\" : \"pass" + std::to_string(i - 1) + "\", \"in\" : \"pass" + std::to_string(i) + "\" }";
+		json += i + 1 == passCount ? "\n" : ",\n";
+	}
+	json += "]\n}\n";
+	return json;
+}
+
+TEST(LoaderTest, LoadLargeDocument)
+{
+	RegisterPrototypes();
+
+	const uint32_t passCount = 5000;
+	std::string json = GenerateComputeChainDocument(passCount);
+
+	auto begin = std::chrono::steady_clock::now();
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	auto end = std::chrono::steady_clock::now();
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	auto rpi = FindLoadedInterface<LoadedComputePass>(*graph.value(), ("pass" + std::to_string(passCount - 1)).c_str());
+	ASSERT_NE(rpi, nullptr);
+	ASSERT_EQ(rpi->attachments.size(), 2);
+	EXPECT_EQ(rpi->attachments[0].type, vkrg::RenderPassAttachment::BufferStorageInput);
+
+	double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+	printf("loaded %u passes (%llu bytes) in %.3f ms\n", passCount, (unsigned long long)json.size(), ms);
+}
+
+TEST(LoaderTest, BinaryRoundTrip)
+{
+	RegisterPrototypes();
+
+	const char* json = R"({
+	"resources" : [
+		{ "name" : "backBuffer", "format" : "bgra8", "extent" : { "screen-scale" : 0.75 }, "external" : true, "final-layout" : "present" },
+		{ "name" : "lights", "layout" : "buffer", "extent" : { "size" : 1024 }, "usage" : [ "transfer-dst", "uniform" ] }
+	],
+	"passes" : [
+		{
+			"name" : "gbuffer", "prototype" : "graphics", "extent" : { "screen-scale" : 0.75 },
+			"output" : [ { "name" : "color", "format" : "rgba16f", "extent" : { "screen-scale" : 0.75 } } ]
+		},
+		{
+			"name" : "shading", "prototype" : "graphics",
+			"input" : [ { "name" : "color" }, { "name" : "lights" } ],
+			"output" : [ { "name" : "backBuffer", "usage" : "color" } ]
+		}
+	],
+	"edges" : [ { "out" : "gbuffer", "in" : "shading" } ]
+})";
+
+	std::string msg;
+	std::vector<char> binary;
+	ASSERT_TRUE(vkrg::ConvertGraphJsonToBinary(json, binary, &msg)) << msg;
+
+	auto graph = vkrg::RenderGraph::LoadFromBinaryMemory(binary.data(), binary.size(), &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	auto backBuffer = graph.value()->FindGraphResource("backBuffer");
+	ASSERT_TRUE(backBuffer.has_value());
+	EXPECT_TRUE(backBuffer.value().external);
+	vkrg::ResourceInfo info = graph.value()->GetResourceInfo(backBuffer.value());
+	EXPECT_EQ(info.format, VK_FORMAT_B8G8R8A8_UNORM);
+	EXPECT_EQ(info.ext.screen.x, 0.75f);
+
+	auto shading = FindLoadedInterface<LoadedGraphicsPass>(*graph.value(), "shading");
+	ASSERT_NE(shading, nullptr);
+	ASSERT_EQ(shading->attachments.size(), 3);
+	EXPECT_EQ(shading->attachments[1].type, vkrg::RenderPassAttachment::BufferInput);
+
+	// converting back to json and binary again gives the same file
+	std::stringstream converted;
+	ASSERT_TRUE(vkrg::ConvertGraphBinaryToJson(binary.data(), binary.size(), converted, &msg)) << msg;
+	std::vector<char> binary2;
+	ASSERT_TRUE(vkrg::ConvertGraphJsonToBinary(converted.str(), binary2, &msg)) << msg << converted.str();
+	EXPECT_EQ(binary, binary2);
+}
+
+TEST(LoaderTest, BinaryRejectsCorruptData)
+{
+	std::string msg;
+	std::vector<char> binary;
+	ASSERT_TRUE(vkrg::ConvertGraphJsonToBinary("{ \"passes\" : [ { \"name\" : \"a\", \"type\" : \"compute\" } ] }", binary, &msg)) << msg;
+
+	std::vector<char> truncated(binary.begin(), binary.end() - 8);
+	EXPECT_FALSE(vkrg::RenderGraph::LoadFromBinaryMemory(truncated.data(), truncated.size(), &msg).has_value());
+	EXPECT_NE(msg.find("truncated"), std::string::npos) << msg;
+
+	std::vector<char> badMagic = binary;
+	badMagic[0] = 'X';
+	EXPECT_FALSE(vkrg::RenderGraph::LoadFromBinaryMemory(badMagic.data(), badMagic.size(), &msg).has_value());
+	EXPECT_NE(msg.find("magic"), std::string::npos) << msg;
+
+	// name of the only pass points out of the string table
+	std::vector<char> badName = binary;
+	auto header = (vkrg::GraphBinaryHeader*)badName.data();
+	((vkrg::GraphPassRecord*)(badName.data() + header->passOffset))->name = 100;
+	EXPECT_FALSE(vkrg::RenderGraph::LoadFromBinaryMemory(badName.data(), badName.size(), &msg).has_value());
+	EXPECT_NE(msg.find("invalid pass record"), std::string::npos) << msg;
+}
+
+TEST(LoaderTest, LoadLargeBinary)
+{
+	RegisterPrototypes();
+
+	const uint32_t passCount = 5000;
+	std::string json = GenerateComputeChainDocument(passCount);
+
+	std::string msg;
+	std::vector<char> binary;
+	ASSERT_TRUE(vkrg::ConvertGraphJsonToBinary(json, binary, &msg)) << msg;
+
+	const char* path = "loader_test_graph.bin";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(binary.data(), binary.size());
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	auto graph = vkrg::RenderGraph::LoadFromBinary(path, &msg);
+	auto end = std::chrono::steady_clock::now();
+	std::remove(path);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	auto rpi = FindLoadedInterface<LoadedComputePass>(*graph.value(), ("pass" + std::to_string(passCount - 1)).c_str());
+	ASSERT_NE(rpi, nullptr);
+	ASSERT_EQ(rpi->attachments.size(), 2);
+
+	double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+	printf("loaded %u passes from binary (%llu bytes) in %.3f ms\n", passCount, (unsigned long long)binary.size(), ms);
+}
+
+TEST(LoaderTest, ReloadChangedPasses)
+{
+	RegisterPrototypes();
+
+	const char* json = R"({
+	"passes" : [
+		{ "name" : "cull", "type" : "compute-pass", "prototype" : "compute" },
+		{ "name" : "shade", "type" : "compute-pass", "prototype" : "compute" },
+		{ "name" : "post", "type" : "compute-pass", "prototype" : "compute" }
+	],
+	"edges" : [ { "out" : "cull", "in" : "shade" }, { "out" : "shade", "in" : "post" } ]
+})";
+
+	// shade is resized, post is replaced by tonemap and cull is kept
+	const char* edited = R"({
+	"passes" : [
+		{ "name" : "cull", "type" : "compute-pass", "prototype" : "compute" },
+		{ "name" : "shade", "type" : "compute-pass", "prototype" : "compute", "extent" : { "width" : 64, "height" : 64 } },
+		{ "name" : "tonemap", "type" : "compute-pass", "prototype" : "compute" }
+	],
+	"edges" : [ { "out" : "cull", "in" : "shade" }, { "out" : "shade", "in" : "tonemap" } ]
+})";
+
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	auto [compileState, compileMsg] = graph.value()->Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	vkrg::RenderGraphReloadStatistics statistics;
+	auto reloaded = graph.value()->ReloadFromJsonString(edited, &msg, &statistics);
+	ASSERT_TRUE(reloaded.has_value()) << msg;
+
+	EXPECT_EQ(statistics.addedPassCount, 1);
+	EXPECT_EQ(statistics.removedPassCount, 1);
+	EXPECT_EQ(statistics.changedPassCount, 1);
+	EXPECT_EQ(statistics.createdImageCount + statistics.createdBufferCount + statistics.createdRenderPassCount, 0);
+	EXPECT_EQ(statistics.releasedRenderPassCount, 0);
+
+	auto [state, executeMsg] = reloaded.value()->Execute(0, NULL);
+	ASSERT_EQ(state, vkrg::RenderGraphRuntimeState::Success) << executeMsg;
+
+	for (const char* name : { "cull", "shade", "tonemap" })
+	{
+		auto pass = FindLoadedInterface<LoadedComputePass>(*reloaded.value(), name);
+		ASSERT_NE(pass, nullptr);
+		EXPECT_EQ(pass->renderCount, 1);
+	}
+
+	// the live graph is kept if the new description is invalid
+	EXPECT_FALSE(graph.value()->ReloadFromJsonString("{ \"passes\" : [ { \"name\" : \"a\" }, { \"name\" : \"a\" } ] }", &msg).has_value());
+
+	printf("reloaded graph in %.3f ms (load %.3f ms, compile %.3f ms)\n", statistics.loadMilliseconds + statistics.compileMilliseconds,
+		statistics.loadMilliseconds, statistics.compileMilliseconds);
+}
+
+TEST(LoaderTest, FileWatcher)
+{
+	const char* path = "loader_test_watch.json";
+	{
+		std::ofstream file(path);
+		file << "{}";
+	}
+
+	vkrg::RenderGraphFileWatcher watcher(path);
+	EXPECT_FALSE(watcher.Poll());
+
+	std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(1));
+	EXPECT_TRUE(watcher.Poll());
+	EXPECT_FALSE(watcher.Poll());
+
+	std::remove(path);
+	EXPECT_FALSE(watcher.Poll());
+}
+
+TEST(LoaderTest, ReadWriteAttachments)
+{
+	RegisterPrototypes();
+
+	// storage-rw outputs are loaded as read-write attachments
+	const char* json = R"({
+	"resources" : [ { "name" : "radiance", "layout" : "buffer", "extent" : { "size" : 256 }, "external" : true } ],
+	"passes" : [
+		{ "name" : "trace", "type" : "compute-pass", "prototype" : "compute", "output" : [ { "name" : "radiance", "usage" : "storage" } ] },
+		{ "name" : "filter-x", "type" : "compute-pass", "prototype" : "compute", "output" : [ { "name" : "radiance", "usage" : "storage-rw" } ] },
+		{ "name" : "filter-y", "type" : "compute-pass", "prototype" : "compute", "output" : [ { "name" : "radiance", "usage" : "storage-rw" } ] },
+		{ "name" : "present", "type" : "compute-pass", "prototype" : "compute", "input" : [ { "name" : "radiance", "usage" : "storage" } ] }
+	]
+})";
+
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	auto filter = FindLoadedInterface<LoadedComputePass>(*graph.value(), "filter-x");
+	ASSERT_NE(filter, nullptr);
+	ASSERT_EQ(filter->attachments.size(), 1);
+	EXPECT_EQ(filter->attachments[0].type, vkrg::RenderPassAttachment::BufferStorageInputOutput);
+	EXPECT_TRUE(filter->attachments[0].ReadFromResource());
+	EXPECT_TRUE(filter->attachments[0].WriteToResource());
+
+	// storage-rw is only valid for outputs
+	const char* invalid = R"({
+	"resources" : [ { "name" : "radiance", "layout" : "buffer", "extent" : { "size" : 256 } } ],
+	"passes" : [ { "name" : "filter", "type" : "compute-pass", "prototype" : "compute", "input" : [ { "name" : "radiance", "usage" : "storage-rw" } ] } ]
+})";
+	EXPECT_FALSE(vkrg::RenderGraph::LoadFromJsonString(invalid, &msg).has_value());
+}
+
+TEST(LoaderTest, DispatchGroups)
+{
+	RegisterPrototypes();
+
+	// clear-counter and build-grid are independent, shade and compact only read the counter
+	const char* json = R"({
+	"resources" : [
+		{ "name" : "counter", "layout" : "buffer", "extent" : { "size" : 64 }, "external" : true },
+		{ "name" : "grid", "layout" : "buffer", "extent" : { "size" : 256 }, "external" : true }
+	],
+	"passes" : [
+		{ "name" : "clear-counter", "type" : "compute-pass", "prototype" : "compute", "output" : [ { "name" : "counter", "usage" : "storage" } ] },
+		{ "name" : "build-grid", "type" : "compute-pass", "prototype" : "compute", "output" : [ { "name" : "grid", "usage" : "storage" } ] },
+		{ "name" : "shade", "type" : "compute-pass", "prototype" : "compute", "input" : [ { "name" : "counter", "usage" : "storage" }, { "name" : "grid", "usage" : "storage" } ] },
+		{ "name" : "compact", "type" : "compute-pass", "prototype" : "compute", "input" : [ { "name" : "counter", "usage" : "storage" } ] }
+	]
+})";
+
+	std::string msg;
+	auto graph = vkrg::RenderGraph::LoadFromJsonString(json, &msg);
+	ASSERT_TRUE(graph.has_value()) << msg;
+
+	vkrg::RenderGraphCompileOptions options;
+	options.flightFrameCount = 1;
+	options.style = vkrg::RenderGraphRenderPassStyle::MergeGraphicsPasses;
+	auto [compileState, compileMsg] = graph.value()->Compile(options, vkrg::RenderGraphDeviceContext());
+	ASSERT_EQ(compileState, vkrg::RenderGraphCompileState::Success) << compileMsg;
+
+	std::stringstream exported;
+	graph.value()->ExportJson(exported, 0);
+	std::string text = exported.str();
+
+	auto mergedPassOf = [&](const char* name)
+	{
+		size_t pos = text.find("\"mergedPass\": ", text.find(std::string("\"name\": \"") + name + "\""));
+		return std::stoi(text.substr(pos + strlen("\"mergedPass\": ")));
+	};
+	auto hasBarriers = [&](const char* name)
+	{
+		size_t pos = text.find("\"barriers\": [", text.find(std::string("\"name\": \"") + name + "\""));
+		return text[pos + strlen("\"barriers\": [")] != ']';
+	};
+
+	EXPECT_EQ(mergedPassOf("clear-counter"), mergedPassOf("build-grid"));
+	EXPECT_EQ(mergedPassOf("shade"), mergedPassOf("compact"));
+	EXPECT_NE(mergedPassOf("clear-counter"), mergedPassOf("shade"));
+
+	// barriers of the group are recorded before its first pass
+	EXPECT_NE(hasBarriers("clear-counter"), hasBarriers("build-grid"));
+}
+
+int main() {
+	testing::InitGoogleTest();
+	RUN_ALL_TESTS();
+}